@@ -0,0 +1,416 @@
+#include "BlockCompression.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+//把 4x4 块的像素取出来，越界的坐标夹到图像边缘
+static void fetchBlock(const unsigned char* src, uint32_t width, uint32_t height, int channels, uint32_t bx, uint32_t by, unsigned char* block)
+{
+    for (uint32_t y = 0; y < 4; y++)
+    {
+        uint32_t sy = by * 4 + y < height ? by * 4 + y : height - 1;
+        for (uint32_t x = 0; x < 4; x++)
+        {
+            uint32_t sx = bx * 4 + x < width ? bx * 4 + x : width - 1;
+            memcpy(block + (y * 4 + x) * channels, src + ((size_t)sy * width + sx) * channels, channels);
+        }
+    }
+}
+
+static void storeBlock(const unsigned char* block, uint32_t width, uint32_t height, int channels, uint32_t bx, uint32_t by, unsigned char* dst)
+{
+    for (uint32_t y = 0; y < 4 && by * 4 + y < height; y++)
+    {
+        for (uint32_t x = 0; x < 4 && bx * 4 + x < width; x++)
+        {
+            memcpy(dst + ((size_t)(by * 4 + y) * width + bx * 4 + x) * channels, block + (y * 4 + x) * channels, channels);
+        }
+    }
+}
+
+// BC1 ------------------------------------------------------------------------
+
+static uint16_t packRGB565(const float* c)
+{
+    int r = (int)(c[0] * (31.0f / 255.0f) + 0.5f);
+    int g = (int)(c[1] * (63.0f / 255.0f) + 0.5f);
+    int b = (int)(c[2] * (31.0f / 255.0f) + 0.5f);
+    r = r < 0 ? 0 : (r > 31 ? 31 : r);
+    g = g < 0 ? 0 : (g > 63 ? 63 : g);
+    b = b < 0 ? 0 : (b > 31 ? 31 : b);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void unpackRGB565(uint16_t c, int* rgb)
+{
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// four-colour palette of an opaque BC1 block (color0 > color1)
+static void bc1Palette(uint16_t c0, uint16_t c1, int palette[4][3])
+{
+    unpackRGB565(c0, palette[0]);
+    unpackRGB565(c1, palette[1]);
+    for (int i = 0; i < 3; i++)
+    {
+        if (c0 > c1)
+        {
+            palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+            palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+        }
+        else
+        {
+            palette[2][i] = (palette[0][i] + palette[1][i]) / 2;
+            palette[3][i] = 0;
+        }
+    }
+}
+
+//为每个像素挑选调色板中最接近的颜色，返回总平方误差
+static int bc1Indices(const unsigned char* block, uint16_t c0, uint16_t c1, uint32_t* indices)
+{
+    int palette[4][3];
+    bc1Palette(c0, c1, palette);
+    int total = 0;
+    *indices = 0;
+    for (int p = 0; p < 16; p++)
+    {
+        int best = 0, bestError = 1 << 30;
+        for (int i = 0; i < 4; i++)
+        {
+            int dr = block[p * 3] - palette[i][0];
+            int dg = block[p * 3 + 1] - palette[i][1];
+            int db = block[p * 3 + 2] - palette[i][2];
+            int error = dr * dr + dg * dg + db * db;
+            if (error < bestError)
+            {
+                bestError = error;
+                best = i;
+            }
+        }
+        total += bestError;
+        *indices |= (uint32_t)best << (p * 2);
+    }
+    return total;
+}
+
+//保证 color0 > color1，这样块工作在 4 色模式（索引在交换之后才计算）
+static void orderEndpoints(uint16_t* c0, uint16_t* c1)
+{
+    if (*c0 < *c1)
+    {
+        uint16_t t = *c0;
+        *c0 = *c1;
+        *c1 = t;
+    }
+}
+
+static void encodeBC1Block(const unsigned char* block, unsigned char* out)
+{
+    // principal axis of the block colours via a few rounds of power iteration
+    float mean[3] = { 0, 0, 0 };
+    for (int p = 0; p < 16; p++)
+        for (int i = 0; i < 3; i++)
+            mean[i] += block[p * 3 + i];
+    for (int i = 0; i < 3; i++)
+        mean[i] /= 16.0f;
+
+    float cov[6] = { 0, 0, 0, 0, 0, 0 };
+    for (int p = 0; p < 16; p++)
+    {
+        float r = block[p * 3] - mean[0], g = block[p * 3 + 1] - mean[1], b = block[p * 3 + 2] - mean[2];
+        cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+        cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+    }
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for (int iter = 0; iter < 8; iter++)
+    {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float len = sqrtf(x * x + y * y + z * z);
+        if (len < 1e-6f)
+            break;
+        axis[0] = x / len; axis[1] = y / len; axis[2] = z / len;
+    }
+
+    float minT = 1e30f, maxT = -1e30f;
+    for (int p = 0; p < 16; p++)
+    {
+        float t = (block[p * 3] - mean[0]) * axis[0] + (block[p * 3 + 1] - mean[1]) * axis[1] + (block[p * 3 + 2] - mean[2]) * axis[2];
+        minT = t < minT ? t : minT;
+        maxT = t > maxT ? t : maxT;
+    }
+    float hi[3], lo[3];
+    for (int i = 0; i < 3; i++)
+    {
+        hi[i] = mean[i] + axis[i] * maxT;
+        lo[i] = mean[i] + axis[i] * minT;
+    }
+    uint16_t c0 = packRGB565(hi), c1 = packRGB565(lo);
+    orderEndpoints(&c0, &c1);
+    uint32_t indices;
+    int error = bc1Indices(block, c0, c1, &indices);
+
+    // least-squares refinement: solve for the endpoints that best fit the chosen indices
+    if (c0 != c1)
+    {
+        static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+        float aa = 0, bb = 0, ab = 0, ax[3] = { 0, 0, 0 }, bx[3] = { 0, 0, 0 };
+        for (int p = 0; p < 16; p++)
+        {
+            float a = weights[(indices >> (p * 2)) & 3], b = 1.0f - a;
+            aa += a * a; bb += b * b; ab += a * b;
+            for (int i = 0; i < 3; i++)
+            {
+                ax[i] += a * block[p * 3 + i];
+                bx[i] += b * block[p * 3 + i];
+            }
+        }
+        float det = aa * bb - ab * ab;
+        if (fabsf(det) > 1e-6f)
+        {
+            float e0[3], e1[3];
+            for (int i = 0; i < 3; i++)
+            {
+                e0[i] = (ax[i] * bb - bx[i] * ab) / det;
+                e1[i] = (bx[i] * aa - ax[i] * ab) / det;
+            }
+            uint16_t r0 = packRGB565(e0), r1 = packRGB565(e1);
+            orderEndpoints(&r0, &r1);
+            if (r0 != r1)
+            {
+                uint32_t refined;
+                int refinedError = bc1Indices(block, r0, r1, &refined);
+                if (refinedError < error)
+                {
+                    c0 = r0; c1 = r1; indices = refined;
+                }
+            }
+        }
+    }
+
+    out[0] = (unsigned char)(c0 & 0xff);
+    out[1] = (unsigned char)(c0 >> 8);
+    out[2] = (unsigned char)(c1 & 0xff);
+    out[3] = (unsigned char)(c1 >> 8);
+    out[4] = (unsigned char)(indices & 0xff);
+    out[5] = (unsigned char)((indices >> 8) & 0xff);
+    out[6] = (unsigned char)((indices >> 16) & 0xff);
+    out[7] = (unsigned char)(indices >> 24);
+}
+
+void compressBC1(const unsigned char* rgb, uint32_t width, uint32_t height, unsigned char* out)
+{
+    unsigned char block[16 * 3];
+    for (uint32_t by = 0; by < (height + 3) / 4; by++)
+    {
+        for (uint32_t bx = 0; bx < (width + 3) / 4; bx++)
+        {
+            fetchBlock(rgb, width, height, 3, bx, by, block);
+            encodeBC1Block(block, out);
+            out += BC_BLOCK_BYTES;
+        }
+    }
+}
+
+void decompressBC1(const unsigned char* blocks, uint32_t width, uint32_t height, unsigned char* rgb)
+{
+    unsigned char block[16 * 3];
+    for (uint32_t by = 0; by < (height + 3) / 4; by++)
+    {
+        for (uint32_t bx = 0; bx < (width + 3) / 4; bx++)
+        {
+            uint16_t c0 = (uint16_t)(blocks[0] | (blocks[1] << 8));
+            uint16_t c1 = (uint16_t)(blocks[2] | (blocks[3] << 8));
+            uint32_t indices = blocks[4] | (blocks[5] << 8) | (blocks[6] << 16) | ((uint32_t)blocks[7] << 24);
+            int palette[4][3];
+            bc1Palette(c0, c1, palette);
+            for (int p = 0; p < 16; p++)
+            {
+                int index = (indices >> (p * 2)) & 3;
+                for (int i = 0; i < 3; i++)
+                    block[p * 3 + i] = (unsigned char)palette[index][i];
+            }
+            storeBlock(block, width, height, 3, bx, by, rgb);
+            blocks += BC_BLOCK_BYTES;
+        }
+    }
+}
+
+// BC4 ------------------------------------------------------------------------
+
+// eight-value palette (red0 > red1) or six-value palette plus 0 and 255 (red0 <= red1)
+static void bc4Palette(int r0, int r1, int palette[8])
+{
+    palette[0] = r0;
+    palette[1] = r1;
+    if (r0 > r1)
+    {
+        for (int i = 1; i < 7; i++)
+            palette[i + 1] = ((7 - i) * r0 + i * r1) / 7;
+    }
+    else
+    {
+        for (int i = 1; i < 5; i++)
+            palette[i + 1] = ((5 - i) * r0 + i * r1) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+static void encodeBC4Block(const unsigned char* block, unsigned char* out)
+{
+    int lo = 255, hi = 0;
+    for (int p = 0; p < 16; p++)
+    {
+        lo = block[p] < lo ? block[p] : lo;
+        hi = block[p] > hi ? block[p] : hi;
+    }
+    out[0] = (unsigned char)hi;
+    out[1] = (unsigned char)lo;
+    uint64_t indices = 0;
+    if (hi != lo)
+    {
+        int palette[8];
+        bc4Palette(hi, lo, palette);
+        for (int p = 0; p < 16; p++)
+        {
+            int best = 0, bestError = 256;
+            for (int i = 0; i < 8; i++)
+            {
+                int error = abs(block[p] - palette[i]);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    best = i;
+                }
+            }
+            indices |= (uint64_t)best << (p * 3);
+        }
+    }
+    for (int i = 0; i < 6; i++)
+        out[2 + i] = (unsigned char)((indices >> (i * 8)) & 0xff);
+}
+
+void compressBC4(const unsigned char* red, uint32_t width, uint32_t height, unsigned char* out)
+{
+    unsigned char block[16];
+    for (uint32_t by = 0; by < (height + 3) / 4; by++)
+    {
+        for (uint32_t bx = 0; bx < (width + 3) / 4; bx++)
+        {
+            fetchBlock(red, width, height, 1, bx, by, block);
+            encodeBC4Block(block, out);
+            out += BC_BLOCK_BYTES;
+        }
+    }
+}
+
+void decompressBC4(const unsigned char* blocks, uint32_t width, uint32_t height, unsigned char* red)
+{
+    unsigned char block[16];
+    for (uint32_t by = 0; by < (height + 3) / 4; by++)
+    {
+        for (uint32_t bx = 0; bx < (width + 3) / 4; bx++)
+        {
+            int palette[8];
+            bc4Palette(blocks[0], blocks[1], palette);
+            uint64_t indices = 0;
+            for (int i = 0; i < 6; i++)
+                indices |= (uint64_t)blocks[2 + i] << (i * 8);
+            for (int p = 0; p < 16; p++)
+                block[p] = (unsigned char)palette[(indices >> (p * 3)) & 7];
+            storeBlock(block, width, height, 1, bx, by, red);
+            blocks += BC_BLOCK_BYTES;
+        }
+    }
+}
+
+// BC3 ------------------------------------------------------------------------
+
+//BC3 的颜色块总是按 4 色模式解码，c0 == c1 时 BC1 的 3 色模式会把索引 3 当成黑色，这里统一改成索引 0
+static void encodeBC3Block(const unsigned char* block, unsigned char* out)
+{
+    unsigned char rgb[16 * 3], alpha[16];
+    for (int p = 0; p < 16; p++)
+    {
+        memcpy(rgb + p * 3, block + p * 4, 3);
+        alpha[p] = block[p * 4 + 3];
+    }
+    encodeBC4Block(alpha, out);
+    encodeBC1Block(rgb, out + BC_BLOCK_BYTES);
+    if (out[8] == out[10] && out[9] == out[11])
+        memset(out + 12, 0, 4);
+}
+
+void compressBC3(const unsigned char* rgba, uint32_t width, uint32_t height, unsigned char* out)
+{
+    unsigned char block[16 * 4];
+    for (uint32_t by = 0; by < (height + 3) / 4; by++)
+    {
+        for (uint32_t bx = 0; bx < (width + 3) / 4; bx++)
+        {
+            fetchBlock(rgba, width, height, 4, bx, by, block);
+            encodeBC3Block(block, out);
+            out += BC3_BLOCK_BYTES;
+        }
+    }
+}
+
+void decompressBC3(const unsigned char* blocks, uint32_t width, uint32_t height, unsigned char* rgba)
+{
+    unsigned char block[16 * 4];
+    for (uint32_t by = 0; by < (height + 3) / 4; by++)
+    {
+        for (uint32_t bx = 0; bx < (width + 3) / 4; bx++)
+        {
+            int alphaPalette[8];
+            bc4Palette(blocks[0], blocks[1], alphaPalette);
+            uint64_t alphaIndices = 0;
+            for (int i = 0; i < 6; i++)
+                alphaIndices |= (uint64_t)blocks[2 + i] << (i * 8);
+
+            const unsigned char* color = blocks + BC_BLOCK_BYTES;
+            uint16_t c0 = (uint16_t)(color[0] | (color[1] << 8));
+            uint16_t c1 = (uint16_t)(color[2] | (color[3] << 8));
+            uint32_t indices = color[4] | (color[5] << 8) | (color[6] << 16) | ((uint32_t)color[7] << 24);
+            int palette[4][3];
+            unpackRGB565(c0, palette[0]);
+            unpackRGB565(c1, palette[1]);
+            for (int i = 0; i < 3; i++)
+            {
+                palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+                palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+            }
+            for (int p = 0; p < 16; p++)
+            {
+                int index = (indices >> (p * 2)) & 3;
+                for (int i = 0; i < 3; i++)
+                    block[p * 4 + i] = (unsigned char)palette[index][i];
+                block[p * 4 + 3] = (unsigned char)alphaPalette[(alphaIndices >> (p * 3)) & 7];
+            }
+            storeBlock(block, width, height, 4, bx, by, rgba);
+            blocks += BC3_BLOCK_BYTES;
+        }
+    }
+}
+
+double computePSNR(const unsigned char* a, const unsigned char* b, size_t count)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        double d = (double)a[i] - (double)b[i];
+        sum += d * d;
+    }
+    if (sum == 0.0 || count == 0)
+        return INFINITY;
+    double mse = sum / count;
+    return 10.0 * log10(255.0 * 255.0 / mse);
+}
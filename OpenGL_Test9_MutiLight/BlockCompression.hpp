@@ -0,0 +1,36 @@
+#ifndef BlockCompression_hpp
+#define BlockCompression_hpp
+
+#include <cstddef>
+#include <cstdint>
+
+//块压缩(BC1 / BC3 / BC4)的 CPU 编解码器
+//BC1: 每个 4x4 块 8 字节，存 RGB，用于漫反射贴图（相对 RGB8 压缩 6:1）
+//BC3: 每个 4x4 块 16 字节，BC4 编码的 alpha 块 + BC1 颜色块，用于合并后的材质贴图（相对 RGBA8 压缩 4:1）
+//BC4: 每个 4x4 块 8 字节，存单通道，用于镜面反射贴图（相对 R8 压缩 2:1）
+//宽高不是 4 的倍数时，边缘块用最后一行/列的像素补齐
+
+const size_t BC_BLOCK_BYTES = 8;
+const size_t BC3_BLOCK_BYTES = 16;
+
+inline size_t bcImageSize(uint32_t width, uint32_t height, size_t blockBytes = BC_BLOCK_BYTES)
+{
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+}
+
+// rgb: tightly packed RGB8 pixels, out: bcImageSize(width, height) bytes
+void compressBC1(const unsigned char* rgb, uint32_t width, uint32_t height, unsigned char* out);
+void decompressBC1(const unsigned char* blocks, uint32_t width, uint32_t height, unsigned char* rgb);
+
+// rgba: tightly packed RGBA8 pixels, out: bcImageSize(width, height, BC3_BLOCK_BYTES) bytes
+void compressBC3(const unsigned char* rgba, uint32_t width, uint32_t height, unsigned char* out);
+void decompressBC3(const unsigned char* blocks, uint32_t width, uint32_t height, unsigned char* rgba);
+
+// red: tightly packed R8 pixels
+void compressBC4(const unsigned char* red, uint32_t width, uint32_t height, unsigned char* out);
+void decompressBC4(const unsigned char* blocks, uint32_t width, uint32_t height, unsigned char* red);
+
+//峰值信噪比(dB)，两幅图完全一致时返回 INFINITY
+double computePSNR(const unsigned char* a, const unsigned char* b, size_t count);
+
+#endif /* BlockCompression_hpp */
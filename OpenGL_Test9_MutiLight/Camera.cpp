@@ -1,5 +1,6 @@
 #include "Camera.hpp"
 #include <GLFW/glfw3.h>
+#include <cmath>
 #include <iostream>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -10,7 +11,8 @@ using namespace glm;
 
 //各函数具体实现
 
-Camera::Camera(vec3 position, vec3 up, float yaw, float pitch): Front(vec3(0,0,-1)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY), Zoom(ZOOM) {
+Camera::Camera(vec3 position, vec3 up, float yaw, float pitch): Front(vec3(0,0,-1)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY), Zoom(ZOOM),
+    AspectRatio(ASPECT_RATIO), NearPlane(NEAR_PLANE), FarPlane(FAR_PLANE), ReversedZ(false), pendingYaw(0.0f), pendingPitch(0.0f), dirty(VIEW_CHANGED | PROJECTION_CHANGED) {
     Position = position;
     WorldUp = up;
     Yaw = yaw;
@@ -18,7 +20,8 @@ Camera::Camera(vec3 position, vec3 up, float yaw, float pitch): Front(vec3(0,0,-
     updateCameraVectors();
 }
 
-Camera::Camera(float posX, float posY, float posZ, float upX, float upY, float upZ, float yaw, float pitch): Front(vec3(0,0,-1)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY), Zoom(ZOOM) {
+Camera::Camera(float posX, float posY, float posZ, float upX, float upY, float upZ, float yaw, float pitch): Front(vec3(0,0,-1)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY), Zoom(ZOOM),
+    AspectRatio(ASPECT_RATIO), NearPlane(NEAR_PLANE), FarPlane(FAR_PLANE), ReversedZ(false), pendingYaw(0.0f), pendingPitch(0.0f), dirty(VIEW_CHANGED | PROJECTION_CHANGED) {
     Position = vec3(posX, posY, posZ);
     WorldUp = vec3(upX, upY, upZ);
     Yaw = yaw;
@@ -26,8 +29,101 @@ Camera::Camera(float posX, float posY, float posZ, float upX, float upY, float u
     updateCameraVectors();
 }
 
-mat4 Camera::GetViewMatrix(){
-    return lookAt(Position, Position + Front, WorldUp);
+const mat4& Camera::GetViewMatrix() const {
+    if (dirty & VIEW_DIRTY) {
+        view = lookAt(Position, Position + Front, WorldUp);
+        dirty &= ~VIEW_DIRTY;
+    }
+    return view;
+}
+
+//反向 Z 的透视矩阵，裁剪空间的深度范围是 [0, 1]：ndc.z = near / 距离 (远平面在无穷远时)，近平面为 1，远平面为 0
+//和 perspective 一样看向 -z，只有第三行不同
+static mat4 reversedPerspective(float fovy, float aspect, float nearPlane, float farPlane)
+{
+    float f = 1.0f / tan(fovy * 0.5f);
+    mat4 result(0.0f);
+    result[0][0] = f / aspect;
+    result[1][1] = f;
+    result[2][3] = -1.0f;
+    if (std::isinf(farPlane))
+    {
+        result[3][2] = nearPlane;
+    }
+    else
+    {
+        result[2][2] = nearPlane / (farPlane - nearPlane);
+        result[3][2] = farPlane * nearPlane / (farPlane - nearPlane);
+    }
+    return result;
+}
+
+const mat4& Camera::GetProjectionMatrix() const {
+    if (dirty & PROJECTION_DIRTY) {
+        if (ReversedZ)
+            projection = reversedPerspective(radians(Zoom), AspectRatio, NearPlane, FarPlane);
+        else if (std::isinf(FarPlane))
+            projection = infinitePerspective(radians(Zoom), AspectRatio, NearPlane);
+        else
+            projection = perspective(radians(Zoom), AspectRatio, NearPlane, FarPlane);
+        dirty &= ~PROJECTION_DIRTY;
+    }
+    return projection;
+}
+
+const mat4& Camera::GetViewProjectionMatrix() const {
+    if (dirty & VIEW_PROJECTION_DIRTY) {
+        viewProjection = GetProjectionMatrix() * GetViewMatrix();
+        dirty &= ~VIEW_PROJECTION_DIRTY;
+    }
+    return viewProjection;
+}
+
+const mat4& Camera::GetInverseViewMatrix() const {
+    if (dirty & INVERSE_VIEW_DIRTY) {
+        //观察矩阵只有旋转和平移：旋转部分转置，平移部分就是摄像机的位置
+        mat3 rotation = transpose(mat3(GetViewMatrix()));
+        inverseView = mat4(rotation);
+        inverseView[3] = vec4(Position, 1.0f);
+        dirty &= ~INVERSE_VIEW_DIRTY;
+    }
+    return inverseView;
+}
+
+const mat4& Camera::GetInverseProjectionMatrix() const {
+    if (dirty & INVERSE_PROJECTION_DIRTY) {
+        inverseProjection = inverse(GetProjectionMatrix());
+        dirty &= ~INVERSE_PROJECTION_DIRTY;
+    }
+    return inverseProjection;
+}
+
+const mat4& Camera::GetInverseViewProjectionMatrix() const {
+    if (dirty & INVERSE_VIEW_PROJECTION_DIRTY) {
+        inverseViewProjection = GetInverseViewMatrix() * GetInverseProjectionMatrix();
+        dirty &= ~INVERSE_VIEW_PROJECTION_DIRTY;
+    }
+    return inverseViewProjection;
+}
+
+void Camera::SetProjection(float aspectRatio, float nearPlane, float farPlane) {
+    if (aspectRatio == AspectRatio && nearPlane == NearPlane && farPlane == FarPlane)
+        return;
+    AspectRatio = aspectRatio;
+    NearPlane = nearPlane;
+    FarPlane = farPlane;
+    dirty |= PROJECTION_CHANGED;
+}
+
+void Camera::SetAspectRatio(float aspectRatio) {
+    SetProjection(aspectRatio, NearPlane, FarPlane);
+}
+
+void Camera::SetReversedZ(bool reversedZ) {
+    if (reversedZ == ReversedZ)
+        return;
+    ReversedZ = reversedZ;
+    dirty |= PROJECTION_CHANGED;
 }
 
 void Camera::ProcessKeyboard(Camera_Movement dir, float deltaTime){
@@ -48,26 +144,59 @@ void Camera::ProcessKeyboard(Camera_Movement dir, float deltaTime){
         default:
             break;
     }
+    dirty |= VIEW_CHANGED;
 }
 
 // processes input received from a mouse input system. Expects the offset value in both the x and y direction.
+//鼠标事件可能比帧多得多，这里只把偏移累加起来，一帧里的所有事件由 UpdateOrientation 合成一次旋转
 void Camera::ProcessMouseMovement(float xoffset, float yoffset, GLboolean constrainPitch)
 {
-    xoffset *= MouseSensitivity;
-    yoffset *= MouseSensitivity;
-
-    Yaw += xoffset;
-    Pitch += yoffset;
+    pendingYaw += xoffset * MouseSensitivity;
+    float pitch = Pitch + pendingPitch + yoffset * MouseSensitivity;
 
     // make sure that when pitch is out of bounds, screen doesn't get flipped
     if (constrainPitch)
     {
-        Pitch = glm::min(89.0f, Pitch);
-        Pitch = glm::max(-89.0f, Pitch);
+        pitch = glm::min(89.0f, pitch);
+        pitch = glm::max(-89.0f, pitch);
     }
+    pendingPitch = pitch - Pitch;
+}
 
-    // update Front, Right and Up Vectors using the updated Euler angles
-    updateCameraVectors();
+//半角不超过 0.25 弧度时 sin/cos 用泰勒展开到 5 次/4 次，误差在 1e-7 以内；一帧的鼠标转动几乎总在这个范围里
+static void halfAngleSinCos(float angle, float& s, float& c)
+{
+    float half = angle * 0.5f;
+    if (half > 0.25f || half < -0.25f)
+    {
+        s = sin(half);
+        c = cos(half);
+        return;
+    }
+    float h2 = half * half;
+    s = half * (1.0f - h2 / 6.0f * (1.0f - h2 / 20.0f));
+    c = 1.0f - h2 * 0.5f * (1.0f - h2 / 12.0f);
+}
+
+void Camera::UpdateOrientation()
+{
+    if (!HasPendingRotation())
+        return;
+    //偏航绕世界上方向(+y)，乘在左边；俯仰绕摄像机自己的右方向(局部 +z)，乘在右边
+    //两个旋转四元数都只有两个非零分量，乘法直接展开，比通用的四元数乘法少一多半运算
+    const float degreesToRadians = 0.017453292519943295f;
+    float ys, yc, ps, pc;
+    halfAngleSinCos(-pendingYaw * degreesToRadians, ys, yc);
+    halfAngleSinCos(pendingPitch * degreesToRadians, ps, pc);
+    quat q = Orientation;
+    quat yawed(yc * q.w - ys * q.y, yc * q.x + ys * q.z, yc * q.y + ys * q.w, yc * q.z - ys * q.x);
+    quat pitched(yawed.w * pc - yawed.z * ps, yawed.x * pc + yawed.y * ps, yawed.y * pc - yawed.x * ps, yawed.w * ps + yawed.z * pc);
+    Orientation = normalize(pitched);
+    Yaw += pendingYaw;
+    Pitch += pendingPitch;
+    pendingYaw = 0.0f;
+    pendingPitch = 0.0f;
+    updateVectorsFromOrientation();
 }
 
 // processes input received from a mouse scroll-wheel event. Only requires input on the vertical wheel-axis
@@ -76,17 +205,34 @@ void Camera::ProcessMouseScroll(float yoffset)
     Zoom -= (float)yoffset;
     Zoom = glm::min(80.0f, Zoom);
     Zoom = glm::max(1.0f, Zoom);
+    dirty |= PROJECTION_CHANGED;
 }
 
+void Camera::SetPose(vec3 position, float yaw, float pitch, float zoom)
+{
+    Position = position;
+    Yaw = yaw;
+    Pitch = pitch;
+    pendingYaw = 0.0f;
+    pendingPitch = 0.0f;
+    if (zoom != Zoom)
+        dirty |= PROJECTION_CHANGED;
+    Zoom = zoom;
+    updateCameraVectors();
+}
+
+//只在构造和 SetPose 时从角度重建朝向，和原来的公式一致：front = (cos(yaw)cos(pitch), sin(pitch), sin(yaw)cos(pitch))
 void Camera::updateCameraVectors(){
-    vec3 front;
-    front.x = cos(radians(Yaw)) * cos(radians(Pitch));
-    front.y = sin(radians(Pitch));
-    front.z = sin(radians(Yaw)) * cos(radians(Pitch));
-    Front = normalize(front);
-    // also re-calculate the Right and Up vector
-    // normalize the vectors, because their length gets closer to 0 the more you look up or down which results in slower movement.
-    Right = normalize(cross(Front, WorldUp));
-    Up = normalize(cross(Right, Front));
+    Orientation = angleAxis(-radians(Yaw), vec3(0.0f, 1.0f, 0.0f)) * angleAxis(radians(Pitch), vec3(0.0f, 0.0f, 1.0f));
+    updateVectorsFromOrientation();
+}
+
+void Camera::updateVectorsFromOrientation(){
+    //旋转矩阵的三列就是摄像机自己的三个轴在世界空间中的方向，已经是单位长度且互相垂直
+    mat3 axes = mat3_cast(Orientation);
+    Front = axes[0];
+    Up = axes[1];
+    Right = axes[2];
+    dirty |= VIEW_CHANGED;
 }
 
@@ -4,9 +4,11 @@
 #include <GLFW/glfw3.h>
 #include <stdio.h>
 #include <iostream>
+#include <limits>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 using namespace std;
 using namespace glm;
@@ -25,6 +27,11 @@ const float PITCH = 0.0f;
 const float SPEED = 3.5f;
 const float SENSITIVITY = 0.1f;
 const float ZOOM = 60.0f;
+const float ASPECT_RATIO = 1.0f;
+const float NEAR_PLANE = 0.1f;
+const float FAR_PLANE = 100.0f;
+//远平面放到无穷远：透视矩阵取 far → ∞ 的极限，不会裁掉任何远处的物体
+const float INFINITE_FAR_PLANE = numeric_limits<float>::infinity();
 
 class Camera {
 public:
@@ -36,23 +43,74 @@ public:
 
     float Yaw;              //偏航角，在xoz平面中 与x轴的夹角，相当于一条与x轴平行的射线 往z轴正负方向偏来偏去
     float Pitch;            //俯仰角，在xoy平面中 与x轴的夹角，相当于一条与x轴平行的射线 往y轴正负方向偏来偏去
+    //朝向四元数：把摄像机自己的坐标系(前 +x，上 +y，右 +z)转到世界空间，Front/Right/Up 由它直接旋转得到，不再用三角函数
+    //鼠标转动时在它上面增量地乘上偏航(绕世界上方向)和俯仰(绕自己的右方向)两个小旋转；假设世界上方向是 +y
+    quat Orientation;
     
     float MovementSpeed;    //移动速度
     float MouseSensitivity; //鼠标灵敏度
     float Zoom;             //视野，用于缩放
+    float AspectRatio;      //视口宽 / 高
+    float NearPlane;        //近平面距离
+    float FarPlane;         //远平面距离，可以是 INFINITE_FAR_PLANE
+    //反向 Z：近平面的深度是 1，越远越接近 0，配合浮点深度缓冲时远处的精度几乎和近处一样
+    //需要 glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE) 把裁剪空间的深度范围改成 [0, 1]，深度测试用 GL_GREATER，深度清成 0
+    bool ReversedZ;
+    //上面这些字段只能通过下面的函数修改，矩阵缓存靠这些函数设置的脏标记失效
 
     //构造函数声明
     Camera(vec3 position = vec3(0,0,0), vec3 up = vec3(0,1,0), float yaw = YAW, float pitch = PITCH);
     Camera(float posX, float posY, float posZ, float upX, float upY, float upZ, float yaw, float pitch);
     //函数声明
-    mat4 GetViewMatrix();
+    //矩阵第一次用到时才计算，之后直到摄像机再被移动、转动或缩放前都返回缓存的结果
+    const mat4& GetViewMatrix() const;
+    const mat4& GetProjectionMatrix() const;
+    const mat4& GetViewProjectionMatrix() const;
+    const mat4& GetInverseViewMatrix() const;
+    const mat4& GetInverseProjectionMatrix() const;
+    const mat4& GetInverseViewProjectionMatrix() const;
+    // perspective projection with the field of view Zoom; only marks the projection dirty when a value changes
+    void SetProjection(float aspectRatio, float nearPlane, float farPlane);
+    void SetAspectRatio(float aspectRatio);
+    // switches GetProjectionMatrix() between the standard [-1, 1] depth range and reversed-Z in [0, 1] (see ReversedZ)
+    void SetReversedZ(bool reversedZ);
     void ProcessKeyboard(Camera_Movement dir, float deltaTime);
+    // only accumulates the offsets; Front/Right/Up follow after the next UpdateOrientation()
     void ProcessMouseMovement(float xoffset, float yoffset, GLboolean constrainPitch = true);
+    // applies the mouse movement accumulated since the last call as one rotation; call once per frame before using the vectors
+    void UpdateOrientation();
+    bool HasPendingRotation() const { return pendingYaw != 0.0f || pendingPitch != 0.0f; }
     void ProcessMouseScroll(float yoffset);
+    // places the camera directly, e.g. when replaying a recorded path; angles in degrees
+    void SetPose(vec3 position, float yaw, float pitch, float zoom);
     
 private:
-    // calculates the front vector from the Camera's (updated) Euler Angles
+    //哪些缓存的矩阵需要重新计算
+    enum DirtyFlags {
+        VIEW_DIRTY = 1 << 0,
+        PROJECTION_DIRTY = 1 << 1,
+        VIEW_PROJECTION_DIRTY = 1 << 2,
+        INVERSE_VIEW_DIRTY = 1 << 3,
+        INVERSE_PROJECTION_DIRTY = 1 << 4,
+        INVERSE_VIEW_PROJECTION_DIRTY = 1 << 5,
+        VIEW_CHANGED = VIEW_DIRTY | VIEW_PROJECTION_DIRTY | INVERSE_VIEW_DIRTY | INVERSE_VIEW_PROJECTION_DIRTY,
+        PROJECTION_CHANGED = PROJECTION_DIRTY | VIEW_PROJECTION_DIRTY | INVERSE_PROJECTION_DIRTY | INVERSE_VIEW_PROJECTION_DIRTY
+    };
+
+    // rebuilds Orientation from Yaw and Pitch, then the vectors from Orientation
     void updateCameraVectors();
+    // calculates Front, Right and Up by rotating the camera's own axes with Orientation
+    void updateVectorsFromOrientation();
+
+    float pendingYaw;       //还没应用到朝向上的鼠标转动，单位度
+    float pendingPitch;
+    mutable unsigned int dirty;
+    mutable mat4 view;
+    mutable mat4 projection;
+    mutable mat4 viewProjection;
+    mutable mat4 inverseView;
+    mutable mat4 inverseProjection;
+    mutable mat4 inverseViewProjection;
 };
 
 #endif /* Camera_hpp */
@@ -0,0 +1,141 @@
+#include "CameraPath.hpp"
+#include <cstdio>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+using namespace std;
+using namespace glm;
+
+CameraPath::CameraPath()
+{
+}
+
+bool CameraPath::load(const string& path)
+{
+    ifstream file(path.c_str());
+    if (!file)
+    {
+        cout << "ERROR::CAMERA_PATH::FILE_NOT_READ: " << path << endl;
+        return false;
+    }
+    keys.clear();
+    string line;
+    int lineNumber = 0;
+    while (getline(file, line))
+    {
+        lineNumber++;
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == string::npos || line[start] == '#')
+            continue;
+        istringstream fields(line);
+        Key key;
+        if (!(fields >> key.time >> key.position.x >> key.position.y >> key.position.z >> key.yaw >> key.pitch >> key.zoom))
+        {
+            cout << "ERROR::CAMERA_PATH::INVALID_KEY: " << path << ":" << lineNumber << endl;
+            keys.clear();
+            return false;
+        }
+        if (!keys.empty() && key.time < keys.back().time)
+        {
+            cout << "ERROR::CAMERA_PATH::TIME_GOES_BACKWARDS: " << path << ":" << lineNumber << endl;
+            keys.clear();
+            return false;
+        }
+        keys.push_back(key);
+    }
+    if (keys.empty())
+    {
+        cout << "ERROR::CAMERA_PATH::NO_KEYS: " << path << endl;
+        return false;
+    }
+    return true;
+}
+
+bool CameraPath::save(const string& path) const
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+        cout << "ERROR::CAMERA_PATH::FILE_NOT_WRITTEN: " << path << endl;
+        return false;
+    }
+    fprintf(file, "# time x y z yaw pitch zoom\n");
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        const Key& key = keys[i];
+        fprintf(file, "%.6f %.6f %.6f %.6f %.4f %.4f %.4f\n", key.time, key.position.x, key.position.y, key.position.z,
+                key.yaw, key.pitch, key.zoom);
+    }
+    bool written = ferror(file) == 0;
+    if (fclose(file) != 0 || !written)
+    {
+        cout << "ERROR::CAMERA_PATH::FILE_NOT_WRITTEN: " << path << endl;
+        return false;
+    }
+    return true;
+}
+
+void CameraPath::addKey(float time, const Camera& camera)
+{
+    Key key;
+    key.time = time;
+    key.position = camera.Position;
+    key.yaw = camera.Yaw;
+    key.pitch = camera.Pitch;
+    key.zoom = camera.Zoom;
+    keys.push_back(key);
+}
+
+void CameraPath::apply(float t, Camera& camera) const
+{
+    if (keys.empty())
+        return;
+    if (t <= keys.front().time)
+    {
+        camera.SetPose(keys.front().position, keys.front().yaw, keys.front().pitch, keys.front().zoom);
+        return;
+    }
+    if (t >= keys.back().time)
+    {
+        camera.SetPose(keys.back().position, keys.back().yaw, keys.back().pitch, keys.back().zoom);
+        return;
+    }
+    //二分查找 t 所在的区间 [keys[low], keys[low + 1])
+    size_t low = 0, high = keys.size() - 1;
+    while (high - low > 1)
+    {
+        size_t middle = (low + high) / 2;
+        if (keys[middle].time <= t)
+            low = middle;
+        else
+            high = middle;
+    }
+    const Key& a = keys[low];
+    const Key& b = keys[high];
+    float span = b.time - a.time;
+    float f = span > 0.0f ? (t - a.time) / span : 1.0f;
+    camera.SetPose(a.position + (b.position - a.position) * f, a.yaw + (b.yaw - a.yaw) * f,
+                   a.pitch + (b.pitch - a.pitch) * f, a.zoom + (b.zoom - a.zoom) * f);
+}
+
+CameraPath CameraPath::orbit(vec3 center, float radius, float height, float seconds)
+{
+    //每 5 度一个关键帧，摄像机始终看向 center
+    const int steps = 72;
+    CameraPath path;
+    float pitch = degrees(-atanf(height / radius));
+    for (int i = 0; i <= steps; i++)
+    {
+        float angle = 360.0f * i / steps;
+        Key key;
+        key.time = seconds * i / steps;
+        key.position = center + vec3(radius * cosf(radians(angle)), height, radius * sinf(radians(angle)));
+        key.yaw = angle + 180.0f;
+        key.pitch = pitch;
+        key.zoom = ZOOM;
+        path.keys.push_back(key);
+    }
+    return path;
+}
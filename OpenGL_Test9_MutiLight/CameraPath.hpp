@@ -0,0 +1,50 @@
+#ifndef CameraPath_hpp
+#define CameraPath_hpp
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Camera.hpp"
+
+using namespace std;
+using namespace glm;
+
+//摄像机路径：按时间排列的一组关键帧，回放时在相邻关键帧之间线性插值
+//用于基准测试，让每次运行看到完全相同的画面序列
+//
+//文本格式，每行一个关键帧，# 开头的行是注释：
+//  time x y z yaw pitch zoom
+//时间单位是秒，角度单位是度；yaw 不做回绕，想转一整圈就写 -90 到 270
+class CameraPath {
+public:
+    struct Key {
+        float time;
+        vec3 position;
+        float yaw;
+        float pitch;
+        float zoom;
+    };
+
+    CameraPath();
+
+    bool load(const string& path);
+    bool save(const string& path) const;
+
+    // appends a key; times must not decrease
+    void addKey(float time, const Camera& camera);
+    // moves the camera to the interpolated pose at time t (clamped to the path's first and last key)
+    void apply(float t, Camera& camera) const;
+
+    bool empty() const { return keys.empty(); }
+    size_t keyCount() const { return keys.size(); }
+    float startTime() const { return keys.empty() ? 0.0f : keys.front().time; }
+    float duration() const { return keys.empty() ? 0.0f : keys.back().time - keys.front().time; }
+
+    // scripted path circling center at the given radius and height, one full turn in `seconds`
+    static CameraPath orbit(vec3 center, float radius, float height, float seconds);
+
+private:
+    vector<Key> keys;
+};
+
+#endif /* CameraPath_hpp */
@@ -0,0 +1,33 @@
+#include "CameraUniforms.hpp"
+
+CameraUniforms::CameraUniforms()
+: buffer(0)
+{
+}
+
+CameraUniforms::~CameraUniforms()
+{
+    // the buffer is released by destroy() while the context is still current
+}
+
+void CameraUniforms::create()
+{
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, buffer);
+}
+
+void CameraUniforms::update(const CameraBlock& block)
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void CameraUniforms::destroy()
+{
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+}
@@ -0,0 +1,40 @@
+#ifndef CameraUniforms_hpp
+#define CameraUniforms_hpp
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+using namespace glm;
+
+//每帧一次的摄像机 uniform 块，光照和灯泡着色器共用同一个缓冲：
+//  layout (std140) uniform CameraBlock { mat4 view; mat4 projection; mat4 viewProjection; vec4 viewPosition; };
+//着色器里顶点只需要乘一次 viewProjection，不用每个程序分别上传 view 和 projection
+struct CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 viewPosition;      //w 不用，std140 里 vec3 也占 16 字节
+};
+
+class CameraUniforms {
+public:
+    //uniform 块绑定点，着色器程序用 Shader::setUniformBlockBinding 指过来
+    static const unsigned int BINDING = 0;
+
+    CameraUniforms();
+    ~CameraUniforms();
+
+    // creates the buffer and binds it to BINDING; needs a current GL context
+    void create();
+    // uploads the block for the next draws
+    void update(const CameraBlock& block);
+    void destroy();
+
+private:
+    unsigned int buffer;
+
+    CameraUniforms(const CameraUniforms&);
+    CameraUniforms& operator=(const CameraUniforms&);
+};
+
+#endif /* CameraUniforms_hpp */
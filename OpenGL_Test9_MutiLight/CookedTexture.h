@@ -0,0 +1,123 @@
+#ifndef CookedTexture_h
+#define CookedTexture_h
+
+#include <cstdint>
+#include <cstring>
+#include "BlockCompression.hpp"
+
+//烘焙贴图(.ctex)文件格式，TextureCooker 写出，TextureLoader 在运行时 mmap 后直接上传
+//
+//  CookedTextureHeader
+//  CookedTextureLevel[levelCount]    每一级 mipmap 在文件中的位置
+//  level 0 数据, level 1 数据, ...    每级起始地址按 CTEX_DATA_ALIGNMENT 对齐，行与行之间紧密排列
+//                                    BC1/BC3/BC4 格式按 4x4 块从左到右、从上到下排列
+//
+//所有字段都是小端序，与 macOS / Linux 上的 x86_64 和 arm64 一致，因此可以原地使用
+
+const uint32_t CTEX_VERSION = 1;
+const uint32_t CTEX_DATA_ALIGNMENT = 16;
+
+enum CookedTextureFormat {
+    CTEX_FORMAT_R8    = 1,
+    CTEX_FORMAT_RGB8  = 2,
+    CTEX_FORMAT_RGBA8 = 3,
+    CTEX_FORMAT_BC1   = 4,      //块压缩 RGB，对应 GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+    CTEX_FORMAT_BC4   = 5,      //块压缩单通道，对应 GL_COMPRESSED_RED_RGTC1
+    CTEX_FORMAT_BC3   = 6       //块压缩 RGBA，对应 GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+};
+
+enum CookedTextureFlags {
+    CTEX_FLAG_SRGB            = 1 << 0,     //颜色通道是 sRGB 编码，mipmap 是在线性空间里滤波的
+    CTEX_FLAG_PACKED_SPECULAR = 1 << 1      //RGBA 材质贴图：rgb 是漫反射颜色，a 是镜面反射强度
+};
+
+struct CookedTextureHeader {
+    char magic[4];          // "CTEX"
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;        // CookedTextureFormat
+    uint32_t flags;         // CookedTextureFlags
+    uint32_t levelCount;
+    uint32_t reserved;
+};
+
+struct CookedTextureLevel {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;        //相对文件开头的字节偏移
+    uint64_t size;          //字节数
+};
+
+inline unsigned int cookedTextureChannels(uint32_t format)
+{
+    switch (format) {
+        case CTEX_FORMAT_R8:    return 1;
+        case CTEX_FORMAT_RGB8:  return 3;
+        case CTEX_FORMAT_RGBA8: return 4;
+        case CTEX_FORMAT_BC1:   return 3;
+        case CTEX_FORMAT_BC4:   return 1;
+        case CTEX_FORMAT_BC3:   return 4;
+        default:                return 0;
+    }
+}
+
+inline bool cookedTextureIsCompressed(uint32_t format)
+{
+    return format == CTEX_FORMAT_BC1 || format == CTEX_FORMAT_BC4 || format == CTEX_FORMAT_BC3;
+}
+
+inline uint64_t cookedTextureLevelSize(uint32_t format, uint32_t width, uint32_t height)
+{
+    if (cookedTextureIsCompressed(format))
+        return bcImageSize(width, height, format == CTEX_FORMAT_BC3 ? BC3_BLOCK_BYTES : BC_BLOCK_BYTES);
+    return (uint64_t)width * height * cookedTextureChannels(format);
+}
+
+//把一级块压缩数据解压成 cookedTextureChannels(format) 个通道的紧密像素，驱动不支持对应的压缩格式时使用
+inline void decompressCookedLevel(uint32_t format, const unsigned char* blocks, uint32_t width, uint32_t height, unsigned char* pixels)
+{
+    if (format == CTEX_FORMAT_BC1)
+        decompressBC1(blocks, width, height, pixels);
+    else if (format == CTEX_FORMAT_BC3)
+        decompressBC3(blocks, width, height, pixels);
+    else
+        decompressBC4(blocks, width, height, pixels);
+}
+
+//把漫反射(RGB8)和镜面反射强度(R8)合并成一张 RGBA8 材质贴图，着色器一次采样拿到两者
+inline void packDiffuseSpecular(const unsigned char* rgb, const unsigned char* specular, size_t pixelCount, unsigned char* rgba)
+{
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+        rgba[i * 4]     = rgb[i * 3];
+        rgba[i * 4 + 1] = rgb[i * 3 + 1];
+        rgba[i * 4 + 2] = rgb[i * 3 + 2];
+        rgba[i * 4 + 3] = specular[i];
+    }
+}
+
+// checks that a mapped .ctex image is well formed before any of its offsets are trusted
+inline bool validateCookedTexture(const unsigned char* bytes, size_t size)
+{
+    if (size < sizeof(CookedTextureHeader))
+        return false;
+    const CookedTextureHeader* header = (const CookedTextureHeader*)bytes;
+    if (memcmp(header->magic, "CTEX", 4) != 0 || header->version != CTEX_VERSION)
+        return false;
+    if (cookedTextureChannels(header->format) == 0 || header->levelCount == 0 || header->levelCount > 32)
+        return false;
+    if (size < sizeof(CookedTextureHeader) + header->levelCount * sizeof(CookedTextureLevel))
+        return false;
+    const CookedTextureLevel* levels = (const CookedTextureLevel*)(header + 1);
+    for (uint32_t i = 0; i < header->levelCount; i++)
+    {
+        if (levels[i].size != cookedTextureLevelSize(header->format, levels[i].width, levels[i].height))
+            return false;
+        if (levels[i].offset > size || levels[i].size > size - levels[i].offset)
+            return false;
+    }
+    return true;
+}
+
+#endif /* CookedTexture_h */
@@ -0,0 +1,281 @@
+#include "FrameBenchmark.hpp"
+#include "RenderStats.h"
+#include "GpuProfiler.hpp"
+#include "TraceRecorder.hpp"
+#include "FramePipeline.hpp"
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+using namespace std;
+
+//把 profiler 读回的一帧记进报告：整帧的 GPU 时间进样本，各个 pass 累加到平均值里；预热帧丢掉
+static void recordFrame(const GpuFrameTimings& timings, int warmupFrames, BenchmarkReport& report)
+{
+    int measured = (int)timings.frame - 1 - warmupFrames;
+    if (measured < 0 || measured >= (int)report.gpuMilliseconds.size())
+        return;
+    for (size_t i = 0; i < timings.passes.size(); i++)
+    {
+        const GpuPassTiming& pass = timings.passes[i];
+        if (pass.depth == 0)
+        {
+            report.gpuMilliseconds[measured] = pass.gpuMilliseconds;
+            continue;
+        }
+        size_t p = 0;
+        while (p < report.passes.size() && report.passes[p].name != pass.name)
+            p++;
+        if (p == report.passes.size())
+        {
+            BenchmarkPass entry = { pass.name, 0, 0.0, 0.0 };
+            report.passes.push_back(entry);
+        }
+        BenchmarkPass& entry = report.passes[p];
+        entry.frames++;
+        entry.cpuMilliseconds += (pass.cpuMilliseconds - entry.cpuMilliseconds) / entry.frames;
+        entry.gpuMilliseconds += (pass.gpuMilliseconds - entry.gpuMilliseconds) / entry.frames;
+    }
+}
+
+bool runFrameBenchmark(LightingScene& scene, OffscreenTarget& target, const CameraPath& path, const BenchmarkSettings& settings, BenchmarkReport& report)
+{
+    if (path.empty() || settings.frames < 1 || settings.warmupFrames < 0 || settings.timestep <= 0.0f)
+    {
+        cout << "ERROR::BENCHMARK::INVALID_SETTINGS" << endl;
+        return false;
+    }
+    report.width = target.width();
+    report.height = target.height();
+    report.timestep = settings.timestep;
+    report.renderer = (const char*)glGetString(GL_RENDERER);
+    report.version = (const char*)glGetString(GL_VERSION);
+    report.cpuMilliseconds.clear();
+    report.gpuMilliseconds.clear();
+    report.gpuFramesDropped = 0;
+    report.drawCalls.clear();
+    report.instances.clear();
+    report.uniformCalls.clear();
+    report.culled.clear();
+    report.passes.clear();
+    report.pipelined = settings.pipelined;
+    report.reversedDepth = scene.reversedDepth();
+    report.latencyMilliseconds = 0.0;
+
+    //整帧是最外层的 "frame" pass，场景的 clear/containers/lamps 嵌套在里面
+    GpuProfiler profiler;
+    profiler.init();
+    scene.setProfiler(&profiler);
+
+    int totalFrames = settings.warmupFrames + settings.frames;
+    //没有读回结果的帧保持 -1，结束时从样本里去掉
+    report.gpuMilliseconds.resize(settings.frames, -1.0);
+    Camera camera;
+    GpuFrameTimings timings;
+    //时间只由帧号决定，每次运行摄像机经过完全相同的位置；比路径长时从头循环
+    auto frameTime = [&](int frame) {
+        return path.startTime() + (path.duration() > 0.0f ? fmodf(frame * settings.timestep, path.duration()) : 0.0f);
+    };
+    //流水线模式：先交出第 0 帧的摄像机，之后每帧提交之前交出下一帧的，模拟线程和本线程的 GL 提交重叠
+    FramePipeline pipeline;
+    scene.setupCamera(camera, target.width(), target.height());
+    if (settings.pipelined)
+    {
+        pipeline.start([&scene](const Camera& packetCamera, FramePacket& packet) {
+            scene.buildPacket(packetCamera, packet);
+        });
+        path.apply(frameTime(0), camera);
+        pipeline.submitInput(camera);
+    }
+    for (int frame = 0; frame < totalFrames; frame++)
+    {
+        resetRenderStats();
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        double cpuMilliseconds;
+        {
+            TraceScope trace("frame");
+            profiler.beginFrame();
+            profiler.beginPass("frame");
+            target.bind();
+            if (settings.pipelined)
+            {
+                if (frame + 1 < totalFrames)
+                {
+                    path.apply(frameTime(frame + 1), camera);
+                    pipeline.submitInput(camera);
+                }
+                const FramePacket* packet = pipeline.acquire();
+                scene.submit(*packet);
+                pipeline.release();
+            }
+            else
+            {
+                path.apply(frameTime(frame), camera);
+                scene.render(camera, target.width(), target.height());
+            }
+            profiler.endPass();
+            profiler.endFrame();
+            cpuMilliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            //没有 SwapBuffers 时驱动不一定马上开始执行，手动 flush 让 GPU 和下一帧的 CPU 工作重叠
+            glFlush();
+        }
+
+        while (profiler.popFrame(timings))
+            recordFrame(timings, settings.warmupFrames, report);
+        //预热帧的 GL 调用不计入统计
+        glInstrumentationEndFrame();
+        if (frame + 1 == settings.warmupFrames)
+            resetGLCallStats();
+        if (frame < settings.warmupFrames)
+            continue;
+        report.cpuMilliseconds.push_back(cpuMilliseconds);
+        report.drawCalls.push_back(renderStats().drawCalls);
+        report.instances.push_back(renderStats().instances);
+        report.uniformCalls.push_back(renderStats().uniformCalls);
+        report.culled.push_back(renderStats().culled);
+    }
+    if (settings.pipelined)
+    {
+        report.latencyMilliseconds = pipeline.averageLatencyMilliseconds();
+        pipeline.stop();
+    }
+    //最后几帧的查询还在路上，等它们完成
+    profiler.flush();
+    while (profiler.popFrame(timings))
+        recordFrame(timings, settings.warmupFrames, report);
+    //查询没来得及完成的帧不计入 GPU 时间的统计，只记下数量
+    size_t gpuFrames = 0;
+    for (size_t i = 0; i < report.gpuMilliseconds.size(); i++)
+        if (report.gpuMilliseconds[i] >= 0.0)
+            report.gpuMilliseconds[gpuFrames++] = report.gpuMilliseconds[i];
+    report.gpuFramesDropped = (int)(report.gpuMilliseconds.size() - gpuFrames);
+    report.gpuMilliseconds.resize(gpuFrames);
+    if (report.gpuFramesDropped > 0)
+        cout << "Benchmark: GPU timings of " << report.gpuFramesDropped << " frame(s) were not ready in time and are left out" << endl;
+    scene.setProfiler(nullptr);
+    profiler.shutdown();
+    report.glCalls.clear();
+    if (glInstrumentationEnabled())
+        glCallStats(report.glCalls);
+    return true;
+}
+
+struct SampleSummary {
+    double mean;
+    double p50;
+    double p99;
+    double min;
+    double max;
+};
+
+// nearest-rank percentiles over a copy of the samples
+template <typename T>
+static SampleSummary summarize(const vector<T>& samples)
+{
+    SampleSummary summary = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+    if (samples.empty())
+        return summary;
+    vector<double> sorted(samples.begin(), samples.end());
+    sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (size_t i = 0; i < sorted.size(); i++)
+        total += sorted[i];
+    size_t n = sorted.size();
+    summary.mean = total / n;
+    summary.p50 = sorted[(n * 50 + 99) / 100 - 1];
+    summary.p99 = sorted[(n * 99 + 99) / 100 - 1];
+    summary.min = sorted.front();
+    summary.max = sorted.back();
+    return summary;
+}
+
+static void writeSummary(FILE* file, const char* name, const SampleSummary& summary, bool last)
+{
+    fprintf(file, "  \"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p99\": %.4f, \"min\": %.4f, \"max\": %.4f }%s\n",
+            name, summary.mean, summary.p50, summary.p99, summary.min, summary.max, last ? "" : ",");
+}
+
+// escapes the characters JSON does not allow inside a string
+static string jsonString(const string& value)
+{
+    string escaped = "\"";
+    for (size_t i = 0; i < value.size(); i++)
+    {
+        char c = value[i];
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", c);
+            escaped += code;
+        }
+        else
+            escaped += c;
+    }
+    return escaped + "\"";
+}
+
+bool writeBenchmarkJSON(const string& path, const BenchmarkReport& report)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+        cout << "ERROR::BENCHMARK::FILE_NOT_WRITTEN: " << path << endl;
+        return false;
+    }
+    fprintf(file, "{\n");
+    fprintf(file, "  \"frames\": %d,\n", (int)report.cpuMilliseconds.size());
+    fprintf(file, "  \"timestep\": %.6f,\n", report.timestep);
+    fprintf(file, "  \"width\": %d,\n", report.width);
+    fprintf(file, "  \"height\": %d,\n", report.height);
+    fprintf(file, "  \"camera_path\": %s,\n", jsonString(report.pathName).c_str());
+    fprintf(file, "  \"renderer\": %s,\n", jsonString(report.renderer).c_str());
+    fprintf(file, "  \"gl_version\": %s,\n", jsonString(report.version).c_str());
+    fprintf(file, "  \"context\": %s,\n", jsonString(report.backend).c_str());
+    fprintf(file, "  \"pipelined\": %s,\n", report.pipelined ? "true" : "false");
+    fprintf(file, "  \"reversed_depth\": %s,\n", report.reversedDepth ? "true" : "false");
+    fprintf(file, "  \"job_workers\": %d,\n", report.jobWorkers);
+    if (report.pipelined)
+        fprintf(file, "  \"input_latency_ms\": %.4f,\n", report.latencyMilliseconds);
+    writeSummary(file, "cpu_frame_ms", summarize(report.cpuMilliseconds), false);
+    writeSummary(file, "gpu_frame_ms", summarize(report.gpuMilliseconds), false);
+    fprintf(file, "  \"gpu_frames_dropped\": %d,\n", report.gpuFramesDropped);
+    writeSummary(file, "draw_calls", summarize(report.drawCalls), false);
+    writeSummary(file, "instances", summarize(report.instances), false);
+    writeSummary(file, "uniform_calls", summarize(report.uniformCalls), false);
+    writeSummary(file, "culled", summarize(report.culled), false);
+    fprintf(file, "  \"passes\": [\n");
+    for (size_t i = 0; i < report.passes.size(); i++)
+    {
+        const BenchmarkPass& pass = report.passes[i];
+        fprintf(file, "    { \"name\": %s, \"cpu_ms_mean\": %.4f, \"gpu_ms_mean\": %.4f }%s\n", jsonString(pass.name).c_str(),
+                pass.cpuMilliseconds, pass.gpuMilliseconds, i + 1 < report.passes.size() ? "," : "");
+    }
+    fprintf(file, "  ]%s\n", report.glCalls.empty() ? "" : ",");
+    if (!report.glCalls.empty())
+    {
+        fprintf(file, "  \"gl_calls\": [\n");
+        for (size_t i = 0; i < report.glCalls.size(); i++)
+        {
+            const GLCallStat& call = report.glCalls[i];
+            fprintf(file, "    { \"name\": \"%s\", \"calls_per_frame\": %.2f, \"redundant_per_frame\": %.2f, \"us_per_frame\": %.3f }%s\n",
+                    call.name, call.callsPerFrame, call.redundantPerFrame, call.microsecondsPerFrame, i + 1 < report.glCalls.size() ? "," : "");
+        }
+        fprintf(file, "  ]\n");
+    }
+    fprintf(file, "}\n");
+    bool written = ferror(file) == 0;
+    if (fclose(file) != 0 || !written)
+    {
+        cout << "ERROR::BENCHMARK::FILE_NOT_WRITTEN: " << path << endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+#ifndef FrameBenchmark_hpp
+#define FrameBenchmark_hpp
+
+#include <string>
+#include <vector>
+#include "LightingScene.hpp"
+#include "OffscreenTarget.hpp"
+#include "CameraPath.hpp"
+#include "GLInstrumentation.hpp"
+
+using namespace std;
+
+//可复现的帧基准测试：沿摄像机路径按固定时间步长渲染 N 帧，时间与墙上时钟无关
+//每帧记录 CPU 提交时间（更新摄像机 + 设置 uniform + 发出绘制调用）、GPU 时间（GpuProfiler 的时间戳查询）
+//以及绘制/uniform 调用次数，另外给出场景里每个 pass 的平均 CPU/GPU 时间，结果写成 JSON，方便比较不同版本的构建
+struct BenchmarkSettings {
+    int frames;             //计入统计的帧数
+    int warmupFrames;       //先渲染但不计入统计的帧数，让驱动编译好着色器、分配好资源
+    float timestep;         //每帧在路径上前进的秒数
+    bool pipelined;         //剔除和帧包由 FramePipeline 的模拟线程提前一帧生成，本线程只提交 GL
+};
+
+struct BenchmarkPass {
+    string name;
+    unsigned long frames;
+    double cpuMilliseconds;     //平均值
+    double gpuMilliseconds;
+};
+
+struct BenchmarkReport {
+    int width;
+    int height;
+    float timestep;
+    string pathName;
+    string renderer;        //GL_RENDERER
+    string version;         //GL_VERSION
+    string backend;         //上下文是怎么创建的
+    bool pipelined;
+    bool reversedDepth;             //反向 Z + 无穷远的远平面(见 LightingScene::setupCamera)
+    int jobWorkers;                 //剔除和矩阵计算用的任务线程数(JobSystem)
+    double latencyMilliseconds;     //流水线模式下摄像机采样到帧包被领取的平均时间
+    vector<double> cpuMilliseconds;
+    vector<double> gpuMilliseconds; //只含读回了计时结果的帧
+    int gpuFramesDropped;           //GPU 计时没有读回的帧数
+    vector<unsigned long> drawCalls;
+    vector<unsigned long> instances;
+    vector<unsigned long> uniformCalls;
+    vector<unsigned long> culled;
+    vector<BenchmarkPass> passes;   //不含整帧的 "frame" pass
+    vector<GLCallStat> glCalls;     //只有开启 GL 调用统计时才有
+};
+
+// renders settings.warmupFrames + settings.frames frames of path into target and fills report
+// (including per-entry GL call counts if GL instrumentation is enabled)
+bool runFrameBenchmark(LightingScene& scene, OffscreenTarget& target, const CameraPath& path, const BenchmarkSettings& settings, BenchmarkReport& report);
+// writes the summary (mean/p50/p99/min/max per metric) as JSON
+bool writeBenchmarkJSON(const string& path, const BenchmarkReport& report);
+
+#endif /* FrameBenchmark_hpp */
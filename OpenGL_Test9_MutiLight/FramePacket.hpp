@@ -0,0 +1,45 @@
+#ifndef FramePacket_hpp
+#define FramePacket_hpp
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "SceneData.hpp"
+
+using namespace std;
+using namespace glm;
+
+//每个箱子实例的数据，对应光照顶点着色器中 location 3~10 的逐实例属性
+struct ContainerInstance {
+    mat4 model;
+    mat3 normalMatrix;  //法线矩阵，由 TransformBatch 和模型矩阵一起算好，着色器里不再逐顶点求逆
+    float layer;        //材质在纹理数组中的层
+    int array;          //材质所在的纹理数组，只在 CPU 端用于分批
+};
+
+//使用同一个纹理数组的一段连续实例，一次 glDrawArraysInstanced 画完
+struct InstanceBatch {
+    int array;
+    int first;
+    int count;
+};
+
+//一帧要提交给 GL 的全部数据：摄像机矩阵、光源参数、剔除之后可见的实例和分批
+//由 LightingScene::buildPacket 一次写好(流水线模式下在模拟线程里)，之后只读；提交时不再访问场景和摄像机
+struct FramePacket {
+    uint64_t frame;                         //输入的编号，从 0 开始
+    uint64_t inputNanoseconds;              //摄像机状态被采样的时刻(traceNow)
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 viewPos;
+    SceneLighting lighting;
+    vector<ContainerInstance> containers;   //视锥内的箱子，按纹理数组排好
+    vector<InstanceBatch> batches;
+    vector<mat4> lamps;                     //视锥内的灯泡
+    unsigned int culled;                    //被视锥剔除的物体数
+
+    FramePacket() : frame(0), inputNanoseconds(0), culled(0) {}
+};
+
+#endif /* FramePacket_hpp */
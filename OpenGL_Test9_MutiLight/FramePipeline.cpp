@@ -0,0 +1,133 @@
+#include "FramePipeline.hpp"
+#include "TraceRecorder.hpp"
+
+using namespace std;
+
+FramePipeline::FramePipeline()
+: acquiredSlot(-1), running(false), stopping(false), hasInput(false), pendingNanoseconds(0), nextFrame(0), inFlight(0),
+  acquiredCount(0), latencyNanoseconds(0), waitNanoseconds(0)
+{
+    states[0] = states[1] = SLOT_FREE;
+}
+
+FramePipeline::~FramePipeline()
+{
+    stop();
+}
+
+void FramePipeline::start(const BuildFunction& build)
+{
+    stop();
+    buildPacket = build;
+    states[0] = states[1] = SLOT_FREE;
+    acquiredSlot = -1;
+    stopping = false;
+    hasInput = false;
+    nextFrame = 0;
+    inFlight = 0;
+    acquiredCount = 0;
+    latencyNanoseconds = 0;
+    waitNanoseconds = 0;
+    running = true;
+    worker = thread(&FramePipeline::run, this);
+}
+
+void FramePipeline::stop()
+{
+    if (!running)
+        return;
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    changed.notify_all();
+    worker.join();
+    running = false;
+}
+
+int FramePipeline::slotIn(SlotState state) const
+{
+    //两个槽位都就绪时先给编号小的那个
+    int found = -1;
+    for (int i = 0; i < 2; i++)
+        if (states[i] == state && (found < 0 || packets[i].frame < packets[found].frame))
+            found = i;
+    return found;
+}
+
+void FramePipeline::run()
+{
+    traceSetThreadName("simulation");
+    unique_lock<mutex> guard(lock);
+    while (true)
+    {
+        changed.wait(guard, [this]() { return stopping || (hasInput && slotIn(SLOT_FREE) >= 0); });
+        if (stopping)
+            break;
+        int slot = slotIn(SLOT_FREE);
+        Camera camera = pendingCamera;
+        FramePacket& packet = packets[slot];
+        packet.frame = nextFrame++;
+        packet.inputNanoseconds = pendingNanoseconds;
+        hasInput = false;
+        states[slot] = SLOT_BUILDING;
+        changed.notify_all();
+
+        //填写帧包时不持锁，GL 线程可以同时提交上一帧、交出下一帧的输入
+        guard.unlock();
+        {
+            TraceScope trace("build packet");
+            buildPacket(camera, packet);
+        }
+        guard.lock();
+        states[slot] = SLOT_READY;
+        changed.notify_all();
+    }
+}
+
+void FramePipeline::submitInput(const Camera& camera)
+{
+    unique_lock<mutex> guard(lock);
+    changed.wait(guard, [this]() { return !hasInput || stopping; });
+    if (stopping)
+        return;
+    pendingCamera = camera;
+    pendingNanoseconds = traceNow();
+    hasInput = true;
+    inFlight++;
+    changed.notify_all();
+}
+
+const FramePacket* FramePipeline::acquire()
+{
+    unique_lock<mutex> guard(lock);
+    if (inFlight == 0 || acquiredSlot >= 0 || !running)
+        return nullptr;
+    uint64_t start = traceNow();
+    changed.wait(guard, [this]() { return slotIn(SLOT_READY) >= 0; });
+    uint64_t now = traceNow();
+    waitNanoseconds += now - start;
+    acquiredSlot = slotIn(SLOT_READY);
+    states[acquiredSlot] = SLOT_ACQUIRED;
+    inFlight--;
+    acquiredCount++;
+    latencyNanoseconds += now - packets[acquiredSlot].inputNanoseconds;
+    return &packets[acquiredSlot];
+}
+
+void FramePipeline::release()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        if (acquiredSlot < 0)
+            return;
+        states[acquiredSlot] = SLOT_FREE;
+        acquiredSlot = -1;
+    }
+    changed.notify_all();
+}
+
+double FramePipeline::averageLatencyMilliseconds() const
+{
+    return acquiredCount ? latencyNanoseconds / 1e6 / acquiredCount : 0.0;
+}
@@ -0,0 +1,78 @@
+#ifndef FramePipeline_hpp
+#define FramePipeline_hpp
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "Camera.hpp"
+#include "FramePacket.hpp"
+
+using namespace std;
+
+//两级帧流水线：模拟线程根据第 N+1 帧的输入(摄像机状态)做剔除、算矩阵和光源，写成帧包，同时 GL 线程提交第 N 帧
+//两个帧包轮流使用(双缓冲)：一个在 GL 线程手里，另一个由模拟线程填写；输入只有一个位置，
+//所以模拟线程最多领先一帧，摄像机从被采样到被提交最多经过两帧
+//GL 线程每帧的顺序：submitInput(下一帧的摄像机) -> acquire() -> 提交 -> release()
+//流水线运行期间场景(SceneStore)只能由模拟线程访问
+class FramePipeline {
+public:
+    // fills the packet for one input; runs on the simulation thread
+    typedef function<void(const Camera& camera, FramePacket& packet)> BuildFunction;
+
+    FramePipeline();
+    ~FramePipeline();
+
+    void start(const BuildFunction& build);
+    // lets the packet being built finish and joins the simulation thread; inputs and packets not acquired yet are dropped
+    void stop();
+
+    // hands the camera state of the next frame to the simulation thread; waits while the previous input has not been taken
+    void submitInput(const Camera& camera);
+    // waits for the oldest packet not yet acquired; nullptr if no input is in flight; owned by the caller until release()
+    const FramePacket* acquire();
+    void release();
+
+    uint64_t framesAcquired() const { return acquiredCount; }
+    //摄像机被采样到帧包被 GL 线程领取的平均时间
+    double averageLatencyMilliseconds() const;
+    //GL 线程在 acquire 里等模拟线程的总时间，接近 0 说明模拟线程一直跑在前面
+    double waitMilliseconds() const { return waitNanoseconds / 1e6; }
+
+private:
+    enum SlotState {
+        SLOT_FREE,
+        SLOT_BUILDING,
+        SLOT_READY,
+        SLOT_ACQUIRED
+    };
+
+    void run();
+    int slotIn(SlotState state) const;
+
+    mutex lock;
+    condition_variable changed;
+    thread worker;
+    BuildFunction buildPacket;
+    FramePacket packets[2];
+    SlotState states[2];
+    int acquiredSlot;
+    bool running;
+    bool stopping;
+
+    bool hasInput;
+    Camera pendingCamera;
+    uint64_t pendingNanoseconds;
+    uint64_t nextFrame;
+    uint64_t inFlight;              //已提交、还没被领取的输入数
+
+    uint64_t acquiredCount;
+    uint64_t latencyNanoseconds;
+    uint64_t waitNanoseconds;
+
+    FramePipeline(const FramePipeline&);
+    FramePipeline& operator=(const FramePipeline&);
+};
+
+#endif /* FramePipeline_hpp */
@@ -0,0 +1,46 @@
+#ifndef FrustumCulling_h
+#define FrustumCulling_h
+
+#include <algorithm>
+#include <glm/glm.hpp>
+
+using namespace glm;
+
+//包围球视锥剔除，LightingScene 和 JobBenchmark 共用
+//包围球存成 vec4：xyz 是球心，w 是半径
+
+//视锥的六个平面取自 projection * view 的行(Gribb-Hartmann)，法线朝里，已经归一化
+//按 [-1, 1] 的深度范围取平面；反向 Z 的 [0, 1] 投影下 z <= w 仍然是近平面，z >= -w 变成摄像机身后的一个平面，
+//相当于不剔除远处(无穷远的远平面本来就没有，它那一行是退化的)，结果只会偏保守
+inline void frustumPlanes(const mat4& viewProjection, vec4 planes[6])
+{
+    vec4 row[4];
+    for (int i = 0; i < 4; i++)
+        row[i] = vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    planes[0] = row[3] + row[0];
+    planes[1] = row[3] - row[0];
+    planes[2] = row[3] + row[1];
+    planes[3] = row[3] - row[1];
+    planes[4] = row[3] + row[2];
+    planes[5] = row[3] - row[2];
+    for (int i = 0; i < 6; i++)
+        planes[i] /= length(vec3(planes[i]));
+}
+
+//包围球在任意一个平面的外侧就看不见
+inline bool sphereVisible(const vec4 planes[6], const vec4& sphere)
+{
+    for (int i = 0; i < 6; i++)
+        if (dot(vec3(planes[i]), vec3(sphere)) + planes[i].w < -sphere.w)
+            return false;
+    return true;
+}
+
+//模型矩阵作用在以原点为中心的单位立方体上：半径取外接球(√3/2)乘最大的缩放，旋转和非均匀缩放下都不会小于真正的范围
+inline vec4 boundingSphere(const mat4& model)
+{
+    float scale = std::max(length(vec3(model[0])), std::max(length(vec3(model[1])), length(vec3(model[2]))));
+    return vec4(vec3(model[3]), 0.8660254f * scale);
+}
+
+#endif /* FrustumCulling_h */
@@ -0,0 +1,42 @@
+#include "GLExtensions.hpp"
+#include <cstring>
+
+typedef void (APIENTRYP ClipControlFunction)(GLenum origin, GLenum depth);
+
+static ClipControlFunction clipControlFunction = nullptr;
+
+void loadGLExtensions(GLADloadproc load)
+{
+    //GL 4.5 的核心函数和 ARB_clip_control 的函数同名，没有后缀
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    bool core45 = major > 4 || (major == 4 && minor >= 5);
+    clipControlFunction = nullptr;
+    if (core45 || hasGLExtension("GL_ARB_clip_control"))
+        clipControlFunction = (ClipControlFunction)load("glClipControl");
+}
+
+bool hasGLExtension(const char* name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (extension && strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool hasClipControl()
+{
+    return clipControlFunction != nullptr;
+}
+
+void clipControl(GLenum origin, GLenum depth)
+{
+    if (clipControlFunction)
+        clipControlFunction(origin, depth);
+}
@@ -0,0 +1,25 @@
+#ifndef GLExtensions_hpp
+#define GLExtensions_hpp
+
+#include <glad/glad.h>
+
+//glad 只生成了 OpenGL 3.3 core 的函数，比它新的功能在这里按需查询和加载
+//上下文创建后、gladLoadGLLoader 成功后用同一个加载函数调用一次 loadGLExtensions
+
+#ifndef GL_NEGATIVE_ONE_TO_ONE
+#define GL_NEGATIVE_ONE_TO_ONE 0x935E
+#endif
+#ifndef GL_ZERO_TO_ONE
+#define GL_ZERO_TO_ONE 0x935F
+#endif
+
+// looks up the optional entry points for the current context; call right after gladLoadGLLoader with the same loader
+void loadGLExtensions(GLADloadproc load);
+// whether the current context lists the extension (core profile: enumerated with glGetStringi)
+bool hasGLExtension(const char* name);
+// glClipControl from GL 4.5 or GL_ARB_clip_control
+bool hasClipControl();
+// does nothing when hasClipControl() is false
+void clipControl(GLenum origin, GLenum depth);
+
+#endif /* GLExtensions_hpp */
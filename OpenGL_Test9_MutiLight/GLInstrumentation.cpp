@@ -0,0 +1,443 @@
+#include "GLInstrumentation.hpp"
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <utility>
+
+using namespace std;
+
+//统计的入口列表：glad 的函数指针类型和去掉 gl 前缀的函数名
+#define GL_INSTRUMENTED_CALLS(X) \
+    X(PFNGLACTIVETEXTUREPROC, ActiveTexture) \
+    X(PFNGLATTACHSHADERPROC, AttachShader) \
+    X(PFNGLBEGINQUERYPROC, BeginQuery) \
+    X(PFNGLBINDBUFFERPROC, BindBuffer) \
+    X(PFNGLBINDBUFFERBASEPROC, BindBufferBase) \
+    X(PFNGLBINDFRAMEBUFFERPROC, BindFramebuffer) \
+    X(PFNGLBINDRENDERBUFFERPROC, BindRenderbuffer) \
+    X(PFNGLBINDTEXTUREPROC, BindTexture) \
+    X(PFNGLBINDVERTEXARRAYPROC, BindVertexArray) \
+    X(PFNGLBUFFERDATAPROC, BufferData) \
+    X(PFNGLBUFFERSUBDATAPROC, BufferSubData) \
+    X(PFNGLCHECKFRAMEBUFFERSTATUSPROC, CheckFramebufferStatus) \
+    X(PFNGLCLEARPROC, Clear) \
+    X(PFNGLCLEARCOLORPROC, ClearColor) \
+    X(PFNGLCLEARDEPTHPROC, ClearDepth) \
+    X(PFNGLCOMPILESHADERPROC, CompileShader) \
+    X(PFNGLCOMPRESSEDTEXIMAGE2DPROC, CompressedTexImage2D) \
+    X(PFNGLCREATEPROGRAMPROC, CreateProgram) \
+    X(PFNGLCREATESHADERPROC, CreateShader) \
+    X(PFNGLDELETEBUFFERSPROC, DeleteBuffers) \
+    X(PFNGLDELETEFRAMEBUFFERSPROC, DeleteFramebuffers) \
+    X(PFNGLDELETEPROGRAMPROC, DeleteProgram) \
+    X(PFNGLDELETEQUERIESPROC, DeleteQueries) \
+    X(PFNGLDELETERENDERBUFFERSPROC, DeleteRenderbuffers) \
+    X(PFNGLDELETESHADERPROC, DeleteShader) \
+    X(PFNGLDELETETEXTURESPROC, DeleteTextures) \
+    X(PFNGLDELETEVERTEXARRAYSPROC, DeleteVertexArrays) \
+    X(PFNGLDEPTHFUNCPROC, DepthFunc) \
+    X(PFNGLDISABLEPROC, Disable) \
+    X(PFNGLDRAWARRAYSPROC, DrawArrays) \
+    X(PFNGLDRAWARRAYSINSTANCEDPROC, DrawArraysInstanced) \
+    X(PFNGLENABLEPROC, Enable) \
+    X(PFNGLENABLEVERTEXATTRIBARRAYPROC, EnableVertexAttribArray) \
+    X(PFNGLENDQUERYPROC, EndQuery) \
+    X(PFNGLFLUSHPROC, Flush) \
+    X(PFNGLFRAMEBUFFERRENDERBUFFERPROC, FramebufferRenderbuffer) \
+    X(PFNGLGENBUFFERSPROC, GenBuffers) \
+    X(PFNGLGENFRAMEBUFFERSPROC, GenFramebuffers) \
+    X(PFNGLGENQUERIESPROC, GenQueries) \
+    X(PFNGLGENRENDERBUFFERSPROC, GenRenderbuffers) \
+    X(PFNGLGENTEXTURESPROC, GenTextures) \
+    X(PFNGLGENVERTEXARRAYSPROC, GenVertexArrays) \
+    X(PFNGLGENERATEMIPMAPPROC, GenerateMipmap) \
+    X(PFNGLGETERRORPROC, GetError) \
+    X(PFNGLGETINTEGER64VPROC, GetInteger64v) \
+    X(PFNGLGETINTEGERVPROC, GetIntegerv) \
+    X(PFNGLGETPROGRAMINFOLOGPROC, GetProgramInfoLog) \
+    X(PFNGLGETPROGRAMIVPROC, GetProgramiv) \
+    X(PFNGLGETQUERYOBJECTIVPROC, GetQueryObjectiv) \
+    X(PFNGLGETQUERYOBJECTUI64VPROC, GetQueryObjectui64v) \
+    X(PFNGLGETQUERYIVPROC, GetQueryiv) \
+    X(PFNGLGETSHADERINFOLOGPROC, GetShaderInfoLog) \
+    X(PFNGLGETSHADERIVPROC, GetShaderiv) \
+    X(PFNGLGETSTRINGPROC, GetString) \
+    X(PFNGLGETSTRINGIPROC, GetStringi) \
+    X(PFNGLGETUNIFORMBLOCKINDEXPROC, GetUniformBlockIndex) \
+    X(PFNGLGETUNIFORMLOCATIONPROC, GetUniformLocation) \
+    X(PFNGLLINKPROGRAMPROC, LinkProgram) \
+    X(PFNGLPIXELSTOREIPROC, PixelStorei) \
+    X(PFNGLQUERYCOUNTERPROC, QueryCounter) \
+    X(PFNGLREADBUFFERPROC, ReadBuffer) \
+    X(PFNGLREADPIXELSPROC, ReadPixels) \
+    X(PFNGLRENDERBUFFERSTORAGEPROC, RenderbufferStorage) \
+    X(PFNGLSHADERSOURCEPROC, ShaderSource) \
+    X(PFNGLTEXIMAGE2DPROC, TexImage2D) \
+    X(PFNGLTEXIMAGE3DPROC, TexImage3D) \
+    X(PFNGLTEXPARAMETERIPROC, TexParameteri) \
+    X(PFNGLTEXSUBIMAGE3DPROC, TexSubImage3D) \
+    X(PFNGLUNIFORM1FPROC, Uniform1f) \
+    X(PFNGLUNIFORM1IPROC, Uniform1i) \
+    X(PFNGLUNIFORM3FPROC, Uniform3f) \
+    X(PFNGLUNIFORMBLOCKBINDINGPROC, UniformBlockBinding) \
+    X(PFNGLUNIFORMMATRIX4FVPROC, UniformMatrix4fv) \
+    X(PFNGLUSEPROGRAMPROC, UseProgram) \
+    X(PFNGLVERTEXATTRIBDIVISORPROC, VertexAttribDivisor) \
+    X(PFNGLVERTEXATTRIBPOINTERPROC, VertexAttribPointer) \
+    X(PFNGLVIEWPORTPROC, Viewport)
+
+enum GLCallID {
+#define GL_CALL_ID(type, name) GL_CALL_##name,
+    GL_INSTRUMENTED_CALLS(GL_CALL_ID)
+#undef GL_CALL_ID
+    GL_CALL_COUNT
+};
+
+static const char* const callNames[GL_CALL_COUNT] = {
+#define GL_CALL_NAME(type, name) "gl" #name,
+    GL_INSTRUMENTED_CALLS(GL_CALL_NAME)
+#undef GL_CALL_NAME
+};
+
+struct CallCounters {
+    unsigned long calls;
+    unsigned long redundant;
+    unsigned long long nanoseconds;
+};
+
+static bool instrumentationEnabled = false;
+static CallCounters frameCounters[GL_CALL_COUNT];      //当前帧
+static CallCounters totalCounters[GL_CALL_COUNT];      //已结束的帧的累计
+static unsigned long closedFrames = 0;
+
+//影子状态：只记录开启统计之后见过的值，没见过的一律当作未知，不会误报
+struct ShadowState {
+    bool programKnown;
+    GLuint program;
+    bool activeUnitKnown;
+    GLenum activeUnit;
+    map<GLenum, GLuint> buffers;                            //target -> buffer
+    map<pair<GLenum, GLuint>, GLuint> indexedBuffers;       //(target, index) -> buffer，glBindBufferBase
+    map<GLenum, GLuint> framebuffers;
+    bool vertexArrayKnown;
+    GLuint vertexArray;
+    map<pair<GLenum, GLenum>, GLuint> textures;             //(unit, target) -> texture
+    map<GLenum, bool> capabilities;                         //glEnable/glDisable
+    bool depthFuncKnown;
+    GLenum depthFunc;
+    map<pair<GLuint, GLint>, vector<unsigned char> > uniforms;  //(program, location) -> 上次写入的字节
+};
+
+static ShadowState shadow;
+
+static void forgetShadowState()
+{
+    shadow.programKnown = false;
+    shadow.activeUnitKnown = false;
+    shadow.vertexArrayKnown = false;
+    shadow.depthFuncKnown = false;
+    shadow.buffers.clear();
+    shadow.indexedBuffers.clear();
+    shadow.framebuffers.clear();
+    shadow.textures.clear();
+    shadow.capabilities.clear();
+    shadow.uniforms.clear();
+}
+
+// returns true if the same bytes were last written to this uniform of the current program
+static bool uniformRedundant(GLint location, const void* bytes, size_t size)
+{
+    if (!shadow.programKnown || location < 0)
+        return false;
+    vector<unsigned char>& last = shadow.uniforms[make_pair(shadow.program, location)];
+    bool same = last.size() == size && memcmp(last.data(), bytes, size) == 0;
+    last.assign((const unsigned char*)bytes, (const unsigned char*)bytes + size);
+    return same;
+}
+
+static bool updateBinding(bool& known, GLuint& current, GLuint value)
+{
+    bool same = known && current == value;
+    known = true;
+    current = value;
+    return same;
+}
+
+template <typename Key>
+static bool updateBinding(map<Key, GLuint>& bindings, const Key& key, GLuint value)
+{
+    typename map<Key, GLuint>::iterator found = bindings.find(key);
+    bool same = found != bindings.end() && found->second == value;
+    bindings[key] = value;
+    return same;
+}
+
+//冗余检查：默认不检查，下面对状态设置类的入口逐个特化
+template <int ID, typename... Args>
+static bool isRedundant(Args...)
+{
+    return false;
+}
+
+template <> bool isRedundant<GL_CALL_UseProgram, GLuint>(GLuint program)
+{
+    return updateBinding(shadow.programKnown, shadow.program, program);
+}
+
+template <> bool isRedundant<GL_CALL_ActiveTexture, GLenum>(GLenum unit)
+{
+    return updateBinding(shadow.activeUnitKnown, shadow.activeUnit, unit);
+}
+
+template <> bool isRedundant<GL_CALL_BindVertexArray, GLuint>(GLuint vertexArray)
+{
+    return updateBinding(shadow.vertexArrayKnown, shadow.vertexArray, vertexArray);
+}
+
+template <> bool isRedundant<GL_CALL_BindBuffer, GLenum, GLuint>(GLenum target, GLuint buffer)
+{
+    //GL_ELEMENT_ARRAY_BUFFER 的绑定属于 VAO，换 VAO 时会变，这里不跟踪
+    if (target == GL_ELEMENT_ARRAY_BUFFER)
+        return false;
+    return updateBinding(shadow.buffers, target, buffer);
+}
+
+//glBindBufferBase 同时改变编号绑定点和 target 的通用绑定(glBindBuffer 看到的那个)，两者都没变才算冗余
+template <> bool isRedundant<GL_CALL_BindBufferBase, GLenum, GLuint, GLuint>(GLenum target, GLuint index, GLuint buffer)
+{
+    bool same = updateBinding(shadow.indexedBuffers, make_pair(target, index), buffer);
+    return updateBinding(shadow.buffers, target, buffer) && same;
+}
+
+template <> bool isRedundant<GL_CALL_BindFramebuffer, GLenum, GLuint>(GLenum target, GLuint framebuffer)
+{
+    if (target == GL_FRAMEBUFFER)
+    {
+        bool same = updateBinding(shadow.framebuffers, (GLenum)GL_DRAW_FRAMEBUFFER, framebuffer);
+        return updateBinding(shadow.framebuffers, (GLenum)GL_READ_FRAMEBUFFER, framebuffer) && same;
+    }
+    return updateBinding(shadow.framebuffers, target, framebuffer);
+}
+
+template <> bool isRedundant<GL_CALL_BindTexture, GLenum, GLuint>(GLenum target, GLuint texture)
+{
+    if (!shadow.activeUnitKnown)
+        return false;
+    return updateBinding(shadow.textures, make_pair(shadow.activeUnit, target), texture);
+}
+
+static bool capabilityRedundant(GLenum capability, bool enabled)
+{
+    map<GLenum, bool>::iterator found = shadow.capabilities.find(capability);
+    bool same = found != shadow.capabilities.end() && found->second == enabled;
+    shadow.capabilities[capability] = enabled;
+    return same;
+}
+
+template <> bool isRedundant<GL_CALL_Enable, GLenum>(GLenum capability)
+{
+    return capabilityRedundant(capability, true);
+}
+
+template <> bool isRedundant<GL_CALL_Disable, GLenum>(GLenum capability)
+{
+    return capabilityRedundant(capability, false);
+}
+
+template <> bool isRedundant<GL_CALL_DepthFunc, GLenum>(GLenum function)
+{
+    return updateBinding(shadow.depthFuncKnown, shadow.depthFunc, function);
+}
+
+template <> bool isRedundant<GL_CALL_Uniform1i, GLint, GLint>(GLint location, GLint value)
+{
+    return uniformRedundant(location, &value, sizeof(value));
+}
+
+template <> bool isRedundant<GL_CALL_Uniform1f, GLint, GLfloat>(GLint location, GLfloat value)
+{
+    return uniformRedundant(location, &value, sizeof(value));
+}
+
+template <> bool isRedundant<GL_CALL_Uniform3f, GLint, GLfloat, GLfloat, GLfloat>(GLint location, GLfloat x, GLfloat y, GLfloat z)
+{
+    GLfloat value[3] = { x, y, z };
+    return uniformRedundant(location, value, sizeof(value));
+}
+
+template <> bool isRedundant<GL_CALL_UniformMatrix4fv, GLint, GLsizei, GLboolean, const GLfloat*>(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+    //转置标志也算进比较的内容里
+    vector<unsigned char> bytes(count * 16 * sizeof(GLfloat) + 1);
+    memcpy(bytes.data(), value, bytes.size() - 1);
+    bytes.back() = transpose;
+    return uniformRedundant(location, bytes.data(), bytes.size());
+}
+
+//删除对象后名字可能被新对象复用，影子状态里的绑定不再可信，全部丢掉
+template <> bool isRedundant<GL_CALL_DeleteProgram, GLuint>(GLuint)
+{
+    forgetShadowState();
+    return false;
+}
+
+template <> bool isRedundant<GL_CALL_DeleteTextures, GLsizei, const GLuint*>(GLsizei, const GLuint*)
+{
+    forgetShadowState();
+    return false;
+}
+
+template <> bool isRedundant<GL_CALL_DeleteBuffers, GLsizei, const GLuint*>(GLsizei, const GLuint*)
+{
+    forgetShadowState();
+    return false;
+}
+
+template <> bool isRedundant<GL_CALL_DeleteVertexArrays, GLsizei, const GLuint*>(GLsizei, const GLuint*)
+{
+    forgetShadowState();
+    return false;
+}
+
+template <> bool isRedundant<GL_CALL_DeleteFramebuffers, GLsizei, const GLuint*>(GLsizei, const GLuint*)
+{
+    forgetShadowState();
+    return false;
+}
+
+//每个入口一个包装函数：先查冗余，再计时调用原来的函数指针
+//GL 的 APIENTRY 在 macOS 和 Linux 上为空，函数指针类型可以直接按普通函数拆出参数
+template <int ID, typename Pointer>
+struct GLCallHook;
+
+template <int ID, typename Result, typename... Args>
+struct GLCallHook<ID, Result (*)(Args...)> {
+    typedef Result (*Pointer)(Args...);
+    static Pointer real;
+
+    //析构时把耗时记到这个入口上，返回值类型为 void 时也能用同一种写法
+    struct Timer {
+        chrono::steady_clock::time_point start;
+        Timer() : start(chrono::steady_clock::now()) {}
+        ~Timer()
+        {
+            frameCounters[ID].nanoseconds += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        }
+    };
+
+    static Result call(Args... args)
+    {
+        CallCounters& counters = frameCounters[ID];
+        counters.calls++;
+        if (isRedundant<ID, Args...>(args...))
+            counters.redundant++;
+        Timer timer;
+        return real(args...);
+    }
+};
+
+template <int ID, typename Result, typename... Args>
+typename GLCallHook<ID, Result (*)(Args...)>::Pointer GLCallHook<ID, Result (*)(Args...)>::real = nullptr;
+
+void setGLInstrumentationEnabled(bool enabled)
+{
+    if (enabled == instrumentationEnabled)
+        return;
+    if (enabled)
+    {
+        forgetShadowState();
+        memset(frameCounters, 0, sizeof(frameCounters));
+        //glad 没有加载到的入口(指针为空)保持为空，不包装
+#define GL_CALL_INSTALL(type, name) \
+        if (glad_gl##name) \
+        { \
+            GLCallHook<GL_CALL_##name, type>::real = glad_gl##name; \
+            glad_gl##name = &GLCallHook<GL_CALL_##name, type>::call; \
+        }
+        GL_INSTRUMENTED_CALLS(GL_CALL_INSTALL)
+#undef GL_CALL_INSTALL
+    }
+    else
+    {
+#define GL_CALL_REMOVE(type, name) \
+        if (GLCallHook<GL_CALL_##name, type>::real) \
+        { \
+            glad_gl##name = GLCallHook<GL_CALL_##name, type>::real; \
+            GLCallHook<GL_CALL_##name, type>::real = nullptr; \
+        }
+        GL_INSTRUMENTED_CALLS(GL_CALL_REMOVE)
+#undef GL_CALL_REMOVE
+    }
+    instrumentationEnabled = enabled;
+}
+
+bool glInstrumentationEnabled()
+{
+    return instrumentationEnabled;
+}
+
+void glInstrumentationEndFrame()
+{
+    if (!instrumentationEnabled)
+        return;
+    for (int i = 0; i < GL_CALL_COUNT; i++)
+    {
+        totalCounters[i].calls += frameCounters[i].calls;
+        totalCounters[i].redundant += frameCounters[i].redundant;
+        totalCounters[i].nanoseconds += frameCounters[i].nanoseconds;
+    }
+    memset(frameCounters, 0, sizeof(frameCounters));
+    closedFrames++;
+}
+
+void glCallStats(vector<GLCallStat>& stats)
+{
+    stats.clear();
+    if (closedFrames == 0)
+        return;
+    for (int i = 0; i < GL_CALL_COUNT; i++)
+    {
+        if (totalCounters[i].calls == 0)
+            continue;
+        GLCallStat stat;
+        stat.name = callNames[i];
+        stat.callsPerFrame = (double)totalCounters[i].calls / closedFrames;
+        stat.redundantPerFrame = (double)totalCounters[i].redundant / closedFrames;
+        stat.microsecondsPerFrame = totalCounters[i].nanoseconds / 1000.0 / closedFrames;
+        stats.push_back(stat);
+    }
+    sort(stats.begin(), stats.end(), [](const GLCallStat& a, const GLCallStat& b) { return a.callsPerFrame > b.callsPerFrame; });
+}
+
+unsigned long glInstrumentedFrames()
+{
+    return closedFrames;
+}
+
+void resetGLCallStats()
+{
+    memset(totalCounters, 0, sizeof(totalCounters));
+    closedFrames = 0;
+}
+
+void printGLCallReport()
+{
+    vector<GLCallStat> stats;
+    glCallStats(stats);
+    if (stats.empty())
+        return;
+    double calls = 0.0, redundant = 0.0, microseconds = 0.0;
+    printf("GL calls per frame over %lu frames:\n", closedFrames);
+    printf("  %-28s %10s %10s %12s\n", "entry point", "calls", "redundant", "time (us)");
+    for (size_t i = 0; i < stats.size(); i++)
+    {
+        printf("  %-28s %10.1f %10.1f %12.2f\n", stats[i].name, stats[i].callsPerFrame, stats[i].redundantPerFrame, stats[i].microsecondsPerFrame);
+        calls += stats[i].callsPerFrame;
+        redundant += stats[i].redundantPerFrame;
+        microseconds += stats[i].microsecondsPerFrame;
+    }
+    printf("  %-28s %10.1f %10.1f %12.2f\n", "total", calls, redundant, microseconds);
+}
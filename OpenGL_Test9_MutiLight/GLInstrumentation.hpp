@@ -0,0 +1,34 @@
+#ifndef GLInstrumentation_hpp
+#define GLInstrumentation_hpp
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//GL 调用统计层
+//开启时把 glad 的函数指针(glad_glXxx)换成带统计的包装函数：记录每个入口的调用次数、耗时，
+//并用一份影子状态找出冗余调用（重复绑定同一个对象、重复设置相同的 uniform 值、重复 glEnable 等）
+//关闭时恢复原来的指针，调用路径和没有这一层时完全一样，没有任何额外开销
+//只统计在 GL 线程上调用、且在 GLInstrumentation.cpp 的入口列表里的函数
+
+struct GLCallStat {
+    const char* name;
+    double callsPerFrame;       //自上次 reset 以来每帧的平均值
+    double redundantPerFrame;
+    double microsecondsPerFrame;
+};
+
+// swaps the glad pointers for the counting wrappers; needs glad to be loaded already
+void setGLInstrumentationEnabled(bool enabled);
+bool glInstrumentationEnabled();
+
+// closes the current frame's counters; call once per frame (does nothing while disabled)
+void glInstrumentationEndFrame();
+// per-entry averages over the frames closed since the last reset, most called first; entries never called are left out
+void glCallStats(vector<GLCallStat>& stats);
+unsigned long glInstrumentedFrames();
+void resetGLCallStats();
+void printGLCallReport();
+
+#endif /* GLInstrumentation_hpp */
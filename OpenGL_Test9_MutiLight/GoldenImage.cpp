@@ -0,0 +1,77 @@
+#include "GoldenImage.hpp"
+#include "ImageArena.hpp"
+#include "stb_image.h"
+#include <cstdlib>
+
+using namespace std;
+using namespace glm;
+
+const vector<GoldenPose>& goldenPoses()
+{
+    static const GoldenPose poses[] = {
+        { "front",   vec3(0.0f, 0.0f, 3.0f),    -90.0f,   0.0f, 45.0f },
+        { "closeup", vec3(0.3f, 0.2f, 1.3f),    -95.0f,  -5.0f, 45.0f },
+        { "wide",    vec3(2.0f, 1.5f, 7.0f),   -100.0f, -10.0f, 45.0f },
+        { "far",     vec3(0.5f, 0.8f, -2.0f),  -104.0f,   2.0f, 30.0f }
+    };
+    static const vector<GoldenPose> list(poses, poses + sizeof(poses) / sizeof(poses[0]));
+    return list;
+}
+
+void compareImages(const unsigned char* expected, const unsigned char* actual, int width, int height, int channelTolerance,
+                   vector<unsigned char>& diff, ImageComparison& result)
+{
+    size_t pixelCount = (size_t)width * height;
+    diff.resize(pixelCount * 4);
+    result.failingPixels = 0;
+    result.maxDelta = 0;
+    unsigned long long deltaSum = 0;
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+        const unsigned char* e = expected + i * 4;
+        const unsigned char* a = actual + i * 4;
+        int delta = 0;
+        for (int c = 0; c < 3; c++)
+        {
+            int d = abs((int)e[c] - (int)a[c]);
+            deltaSum += d;
+            if (d > delta)
+                delta = d;
+        }
+        if (delta > result.maxDelta)
+            result.maxDelta = delta;
+
+        unsigned char* out = &diff[i * 4];
+        if (delta > channelTolerance)
+        {
+            result.failingPixels++;
+            out[0] = (unsigned char)(delta * 2 < 127 ? 128 + delta * 2 : 255);
+            out[1] = 0;
+            out[2] = 0;
+        }
+        else
+        {
+            //合格的像素画成变暗的灰度图，方便看出不合格的区域在画面的哪里
+            unsigned char gray = (unsigned char)((e[0] * 77 + e[1] * 150 + e[2] * 29) >> 10);
+            out[0] = out[1] = out[2] = gray;
+        }
+        out[3] = 255;
+    }
+    result.failingPercent = pixelCount ? 100.0 * result.failingPixels / pixelCount : 0.0;
+    result.meanDelta = pixelCount ? (double)deltaSum / (pixelCount * 3) : 0.0;
+}
+
+bool readPNG(const string& path, int& width, int& height, vector<unsigned char>& pixels)
+{
+    int nrComponents;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrComponents, 4);
+    if (!data)
+    {
+        resetImageArena();
+        return false;
+    }
+    pixels.assign(data, data + (size_t)width * height * 4);
+    stbi_image_free(data);
+    resetImageArena();
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef GoldenImage_hpp
+#define GoldenImage_hpp
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+using namespace std;
+using namespace glm;
+
+//金图(golden image)回归检查：固定的几个摄像机位置各渲染一帧，和事先存好的 PNG 逐像素比较
+//改光照着色器或渲染路径做性能优化之后跑一遍，确认画面没有变
+//容差分两层：单个像素任意通道差值超过 channelTolerance 才算不合格，不合格像素占比超过 maxFailingPercent 才算失败，
+//这样驱动或 CPU/GPU 之间 1~2 个色阶的舍入差异不会误报，而真正的光照错误(通常成片出现)一定会被发现
+
+struct GoldenPose {
+    const char* name;       //金图文件名 <name>.png
+    vec3 position;
+    float yaw;
+    float pitch;
+    float zoom;
+};
+
+// the fixed poses every golden run renders; covers the default view, a close-up inside the spot light,
+// a wide shot with all lamps and a narrow field of view on the far containers
+const vector<GoldenPose>& goldenPoses();
+
+struct ImageComparison {
+    unsigned long failingPixels;    //任意通道差值超过容差的像素数
+    double failingPercent;
+    int maxDelta;                   //所有像素、所有通道里最大的差值
+    double meanDelta;               //RGB 通道差值的平均值
+};
+
+// compares the RGB channels of two RGBA8 images of the same size; diff receives an RGBA8 visualisation where
+// passing pixels are the darkened expected image and failing pixels are red, brighter for larger deltas
+void compareImages(const unsigned char* expected, const unsigned char* actual, int width, int height, int channelTolerance,
+                   vector<unsigned char>& diff, ImageComparison& result);
+
+// decodes a PNG into RGBA8, rows from top to bottom; returns false if the file is missing or not an image
+bool readPNG(const string& path, int& width, int& height, vector<unsigned char>& pixels);
+
+#endif /* GoldenImage_hpp */
@@ -0,0 +1,222 @@
+#include "GpuProfiler.hpp"
+#include "TraceRecorder.hpp"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+//没人取走的帧结果最多保留这么多，窗口模式只看平均值时不会无限增长
+static const size_t MAX_RESOLVED_FRAMES = 64;
+//GPU 时钟和 CPU 时钟会慢慢漂移，记录时间线时每隔这么多帧重新对齐一次
+static const unsigned long CALIBRATION_INTERVAL = 60;
+
+GpuProfiler::GpuProfiler()
+: current(nullptr), frameCount(0), dropped(0), lastCalibration(0), traceOffset(0), hasTimestamps(false), profilerEnabled(false)
+{
+    for (int i = 0; i < FRAMES_IN_FLIGHT; i++)
+    {
+        slots[i].frame = 0;
+        slots[i].traceOffset = 0;
+    }
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    // query objects are released by shutdown() while the context is still current
+}
+
+bool GpuProfiler::init()
+{
+    GLint bits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+    hasTimestamps = bits > 0;
+    profilerEnabled = true;
+    if (!hasTimestamps)
+        cout << "ERROR::GPU_PROFILER::NO_TIMESTAMP_QUERIES: only CPU timings will be reported" << endl;
+    return hasTimestamps;
+}
+
+void GpuProfiler::shutdown()
+{
+    for (int i = 0; i < FRAMES_IN_FLIGHT; i++)
+    {
+        if (!slots[i].queries.empty())
+            glDeleteQueries((GLsizei)slots[i].queries.size(), slots[i].queries.data());
+        slots[i].queries.clear();
+        slots[i].passes.clear();
+        slots[i].frame = 0;
+    }
+    current = nullptr;
+    profilerEnabled = false;
+}
+
+void GpuProfiler::beginFrame()
+{
+    if (!profilerEnabled)
+        return;
+    frameCount++;
+    current = &slots[frameCount % FRAMES_IN_FLIGHT];
+    //这组查询上一次属于 FRAMES_IN_FLIGHT 帧之前，先把那一帧的结果读出来再复用
+    if (current->frame != 0)
+        resolve(*current, false);
+    if (hasTimestamps && tracingEnabled() && (lastCalibration == 0 || frameCount - lastCalibration >= CALIBRATION_INTERVAL))
+        calibrateTraceClock();
+    current->frame = frameCount;
+    current->traceOffset = traceOffset;
+    current->passes.clear();
+    openPasses.clear();
+}
+
+//glGetInteger64v(GL_TIMESTAMP) 返回的是命令到达 GPU 时的时钟，不等前面的命令执行完，和 traceNow() 配对得到两个时钟的差
+void GpuProfiler::calibrateTraceClock()
+{
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    traceOffset = (int64_t)traceNow() - gpuNow;
+    lastCalibration = frameCount;
+}
+
+void GpuProfiler::endFrame()
+{
+    if (!current)
+        return;
+    //忘记 endPass 的 pass 在帧末自动结束，保证时间戳成对
+    while (!openPasses.empty())
+        endPass();
+    current = nullptr;
+}
+
+void GpuProfiler::beginPass(const char* name)
+{
+    if (!current)
+        return;
+    size_t index = current->passes.size();
+    if (hasTimestamps && current->queries.size() < (index + 1) * 2)
+    {
+        current->queries.resize((index + 1) * 2);
+        glGenQueries(2, &current->queries[index * 2]);
+    }
+    PassRecord record;
+    record.name = name;
+    record.depth = (int)openPasses.size();
+    record.cpuBegin = chrono::steady_clock::now();
+    record.cpuEnd = record.cpuBegin;
+    current->passes.push_back(record);
+    openPasses.push_back((int)index);
+    if (hasTimestamps)
+        glQueryCounter(current->queries[index * 2], GL_TIMESTAMP);
+}
+
+void GpuProfiler::endPass()
+{
+    if (!current || openPasses.empty())
+        return;
+    int index = openPasses.back();
+    openPasses.pop_back();
+    if (hasTimestamps)
+        glQueryCounter(current->queries[index * 2 + 1], GL_TIMESTAMP);
+    current->passes[index].cpuEnd = chrono::steady_clock::now();
+}
+
+void GpuProfiler::resolve(FrameSlot& slot, bool wait)
+{
+    size_t passCount = slot.passes.size();
+    if (hasTimestamps && passCount > 0 && !wait)
+    {
+        //只要有一个时间戳还没完成就放弃这一帧，绝不等待
+        for (size_t i = 0; i < passCount * 2; i++)
+        {
+            GLint available = 0;
+            glGetQueryObjectiv(slot.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+            {
+                dropped++;
+                slot.frame = 0;
+                return;
+            }
+        }
+    }
+
+    GpuFrameTimings timings;
+    timings.frame = slot.frame;
+    timings.passes.resize(passCount);
+    for (size_t i = 0; i < passCount; i++)
+    {
+        const PassRecord& record = slot.passes[i];
+        GpuPassTiming& pass = timings.passes[i];
+        pass.name = record.name;
+        pass.depth = record.depth;
+        pass.cpuMilliseconds = chrono::duration<double, milli>(record.cpuEnd - record.cpuBegin).count();
+        pass.gpuMilliseconds = 0.0;
+        pass.gpuBegin = pass.gpuEnd = 0;
+        if (hasTimestamps)
+        {
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(slot.queries[i * 2], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(slot.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+            pass.gpuMilliseconds = end > begin ? (end - begin) / 1e6 : 0.0;
+            pass.gpuBegin = begin;
+            pass.gpuEnd = end;
+            if (tracingEnabled() && slot.traceOffset != 0)
+                traceGpuEvent(pass.name, (uint64_t)((int64_t)begin + slot.traceOffset), (uint64_t)((int64_t)end + slot.traceOffset));
+        }
+
+        //同名的 pass 合在一起求平均
+        size_t a = 0;
+        while (a < averages.size() && strcmp(averages[a].name, pass.name) != 0)
+            a++;
+        if (a == averages.size())
+        {
+            PassAverage average = { pass.name, 0, 0.0, 0.0 };
+            averages.push_back(average);
+        }
+        averages[a].count++;
+        averages[a].cpuTotal += pass.cpuMilliseconds;
+        averages[a].gpuTotal += pass.gpuMilliseconds;
+    }
+    slot.frame = 0;
+
+    resolved.push_back(timings);
+    if (resolved.size() > MAX_RESOLVED_FRAMES)
+        resolved.pop_front();
+}
+
+bool GpuProfiler::popFrame(GpuFrameTimings& timings)
+{
+    if (resolved.empty())
+        return false;
+    timings = resolved.front();
+    resolved.pop_front();
+    return true;
+}
+
+void GpuProfiler::flush()
+{
+    //按帧序号从旧到新读取，保证 popFrame 取出的顺序不乱
+    unsigned long first = frameCount >= FRAMES_IN_FLIGHT ? frameCount + 1 - FRAMES_IN_FLIGHT : 1;
+    for (unsigned long frame = first; frame <= frameCount; frame++)
+    {
+        FrameSlot& slot = slots[frame % FRAMES_IN_FLIGHT];
+        if (slot.frame == frame && &slot != current)
+            resolve(slot, true);
+    }
+}
+
+void GpuProfiler::printAverages()
+{
+    for (size_t i = 0; i < averages.size(); i++)
+    {
+        const PassAverage& average = averages[i];
+        printf("  %-16s gpu %8.3f ms   cpu %8.3f ms   (%lu frames)\n", average.name,
+               average.gpuTotal / average.count, average.cpuTotal / average.count, average.count);
+    }
+    if (dropped > 0)
+        printf("  %lu frame(s) dropped: GPU results were not ready when their queries were reused\n", dropped);
+}
+
+void GpuProfiler::resetAverages()
+{
+    averages.clear();
+    dropped = 0;
+}
@@ -0,0 +1,126 @@
+#ifndef GpuProfiler_hpp
+#define GpuProfiler_hpp
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+
+using namespace std;
+
+//一个 pass 在一帧里的耗时：GPU 时间来自 GL_TIMESTAMP 查询，CPU 时间是提交这些命令花的时间
+struct GpuPassTiming {
+    const char* name;
+    int depth;                  //嵌套层数，最外层为 0
+    double cpuMilliseconds;
+    double gpuMilliseconds;     //没有计时查询支持时为 0
+    uint64_t gpuBegin;          //GL_TIMESTAMP 原始值（GPU 时钟，纳秒）
+    uint64_t gpuEnd;
+};
+
+struct GpuFrameTimings {
+    unsigned long frame;        //beginFrame 的序号，从 1 开始
+    vector<GpuPassTiming> passes;
+};
+
+//分 pass 的 GPU 计时器
+//每个 pass 的开始和结束各发一个 glQueryCounter(GL_TIMESTAMP)，用时间戳而不是 GL_TIME_ELAPSED 是因为后者不能嵌套
+//查询对象按帧轮换使用 FRAMES_IN_FLIGHT 组，一帧的结果在它的那组查询被下次复用时才读取，
+//这时 GPU 早已执行完，读取不会让 CPU 等待；万一还没完成，这一帧的结果直接丢弃
+//开启帧时间线记录(TraceRecorder)时，读回的 pass 也会换算到 CPU 时钟，画在时间线的 GPU 轨道上
+class GpuProfiler {
+public:
+    static const int FRAMES_IN_FLIGHT = 4;
+
+    GpuProfiler();
+    ~GpuProfiler();
+
+    // needs a current context; returns false (CPU timings only) if the driver has no timestamp queries
+    bool init();
+    void shutdown();
+    void setEnabled(bool enabled) { profilerEnabled = enabled; }
+    bool enabled() const { return profilerEnabled; }
+
+    void beginFrame();
+    void endFrame();
+    // passes may nest; name must be a string literal (only the pointer is kept)
+    void beginPass(const char* name);
+    void endPass();
+
+    // takes the oldest frame whose results have been read back; false if none is waiting
+    bool popFrame(GpuFrameTimings& timings);
+    // waits for every frame still in flight and reads back its results (end of a benchmark run)
+    void flush();
+
+    // per-pass means over every frame read back since the last reset
+    void printAverages();
+    void resetAverages();
+    unsigned long droppedFrames() const { return dropped; }
+
+private:
+    struct PassRecord {
+        const char* name;
+        int depth;
+        chrono::steady_clock::time_point cpuBegin;
+        chrono::steady_clock::time_point cpuEnd;
+    };
+
+    struct FrameSlot {
+        unsigned long frame;            //0 表示这组查询没有在用
+        int64_t traceOffset;            //这一帧开始时 CPU 记录时钟减 GPU 时钟的差
+        vector<unsigned int> queries;   //每个 pass 两个：开始和结束的时间戳
+        vector<PassRecord> passes;
+    };
+
+    struct PassAverage {
+        const char* name;
+        unsigned long count;
+        double cpuTotal;
+        double gpuTotal;
+    };
+
+    void resolve(FrameSlot& slot, bool wait);
+    void calibrateTraceClock();
+
+    FrameSlot slots[FRAMES_IN_FLIGHT];
+    FrameSlot* current;
+    vector<int> openPasses;
+    deque<GpuFrameTimings> resolved;
+    vector<PassAverage> averages;
+    unsigned long frameCount;
+    unsigned long dropped;
+    unsigned long lastCalibration;
+    int64_t traceOffset;
+    bool hasTimestamps;
+    bool profilerEnabled;
+
+    GpuProfiler(const GpuProfiler&);
+    GpuProfiler& operator=(const GpuProfiler&);
+};
+
+//作用域计时：构造时 beginPass，析构时 endPass；profiler 为空时什么都不做
+class GpuProfileScope {
+public:
+    GpuProfileScope(GpuProfiler* profiler, const char* name)
+    : owner(profiler && profiler->enabled() ? profiler : nullptr)
+    {
+        if (owner)
+            owner->beginPass(name);
+    }
+
+    ~GpuProfileScope()
+    {
+        if (owner)
+            owner->endPass();
+    }
+
+private:
+    GpuProfiler* owner;
+
+    GpuProfileScope(const GpuProfileScope&);
+    GpuProfileScope& operator=(const GpuProfileScope&);
+};
+
+#endif /* GpuProfiler_hpp */
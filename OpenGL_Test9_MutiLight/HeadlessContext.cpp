@@ -0,0 +1,183 @@
+#include "HeadlessContext.hpp"
+#include "GLExtensions.hpp"
+#include <cstring>
+#include <iostream>
+#ifdef __linux__
+#include <EGL/eglext.h>
+#endif
+
+using namespace std;
+
+#ifdef __linux__
+
+static bool hasEGLExtension(const char* extensions, const char* name)
+{
+    if (!extensions)
+        return false;
+    size_t length = strlen(name);
+    for (const char* p = strstr(extensions, name); p; p = strstr(p + length, name))
+    {
+        if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0'))
+            return true;
+    }
+    return false;
+}
+
+HeadlessContext::HeadlessContext()
+: display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT), surface(EGL_NO_SURFACE), backendName("none")
+{
+}
+
+bool HeadlessContext::create()
+{
+    //Mesa 的 surfaceless 平台不需要 X11/Wayland，也不需要 GPU 设备节点
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay && hasEGLExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+    {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        backendName = "EGL surfaceless";
+    }
+    if (display == EGL_NO_DISPLAY)
+    {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        backendName = "EGL default display";
+    }
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        cout << "ERROR::HEADLESS::EGL_INITIALIZE_FAILED: 0x" << hex << eglGetError() << dec << endl;
+        return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        cout << "ERROR::HEADLESS::EGL_OPENGL_API_UNAVAILABLE" << endl;
+        destroy();
+        return false;
+    }
+
+    //eglChooseConfig 默认只找能建窗口表面的配置，surfaceless 平台只有 pbuffer 配置
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+    {
+        cout << "ERROR::HEADLESS::EGL_NO_CONFIG" << endl;
+        destroy();
+        return false;
+    }
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+        EGL_CONTEXT_MINOR_VERSION_KHR, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT)
+    {
+        cout << "ERROR::HEADLESS::EGL_CREATE_CONTEXT_FAILED: 0x" << hex << eglGetError() << dec << endl;
+        destroy();
+        return false;
+    }
+
+    //没有 EGL_KHR_surfaceless_context 的驱动退回到一个 1x1 的 pbuffer，只是为了能 MakeCurrent
+    if (!hasEGLExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+    {
+        const EGLint pbufferAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, config, pbufferAttributes);
+    }
+    if (!eglMakeCurrent(display, surface, surface, context))
+    {
+        cout << "ERROR::HEADLESS::EGL_MAKE_CURRENT_FAILED: 0x" << hex << eglGetError() << dec << endl;
+        destroy();
+        return false;
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+    {
+        cout << "Failed to initialize GLAD" << endl;
+        destroy();
+        return false;
+    }
+    loadGLExtensions((GLADloadproc)eglGetProcAddress);
+    cout << "Headless context: " << backendName << " (EGL " << major << "." << minor << "), "
+         << (const char*)glGetString(GL_RENDERER) << endl;
+    return true;
+}
+
+void HeadlessContext::destroy()
+{
+    if (display == EGL_NO_DISPLAY)
+        return;
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (surface != EGL_NO_SURFACE)
+        eglDestroySurface(display, surface);
+    if (context != EGL_NO_CONTEXT)
+        eglDestroyContext(display, context);
+    eglTerminate(display);
+    display = EGL_NO_DISPLAY;
+    context = EGL_NO_CONTEXT;
+    surface = EGL_NO_SURFACE;
+}
+
+#else
+
+HeadlessContext::HeadlessContext()
+: window(NULL), backendName("none")
+{
+}
+
+bool HeadlessContext::create()
+{
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    //窗口永远不显示，只用它的上下文
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    window = glfwCreateWindow(1, 1, "headless", NULL, NULL);
+    if (window == NULL)
+    {
+        cout << "Failed to create GLFW window" << endl;
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        cout << "Failed to initialize GLAD" << endl;
+        destroy();
+        return false;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    backendName = "hidden GLFW window";
+    cout << "Headless context: " << backendName << ", " << (const char*)glGetString(GL_RENDERER) << endl;
+    return true;
+}
+
+void HeadlessContext::destroy()
+{
+    if (!window)
+        return;
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    window = NULL;
+}
+
+#endif
+
+HeadlessContext::~HeadlessContext()
+{
+    destroy();
+}
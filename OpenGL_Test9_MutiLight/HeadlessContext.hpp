@@ -0,0 +1,40 @@
+#ifndef HeadlessContext_hpp
+#define HeadlessContext_hpp
+
+#include <glad/glad.h>
+#ifdef __linux__
+#include <EGL/egl.h>
+#else
+#include <GLFW/glfw3.h>
+#endif
+
+//不需要显示器的 OpenGL 3.3 core 上下文，用于在没有 GPU 或没有桌面的构建机上渲染
+//  Linux: EGL，优先使用 Mesa 的 surfaceless 平台（llvmpipe 软件渲染也可以），不创建任何窗口或表面；链接 -lEGL
+//  其它平台: 不可见的 GLFW 窗口，只借用它的上下文
+//渲染结果需要画进 OffscreenTarget，上下文本身没有可用的默认帧缓冲
+class HeadlessContext {
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+
+    // creates the context, makes it current and loads the GL function pointers through glad
+    bool create();
+    void destroy();
+    // short description of how the context was created, for logs
+    const char* backend() const { return backendName; }
+
+private:
+#ifdef __linux__
+    EGLDisplay display;
+    EGLContext context;
+    EGLSurface surface;         //只有驱动不支持 surfaceless 上下文时才创建的 1x1 pbuffer
+#else
+    GLFWwindow* window;
+#endif
+    const char* backendName;
+
+    HeadlessContext(const HeadlessContext&);
+    HeadlessContext& operator=(const HeadlessContext&);
+};
+
+#endif /* HeadlessContext_hpp */
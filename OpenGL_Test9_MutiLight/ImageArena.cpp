@@ -0,0 +1,179 @@
+#include "ImageArena.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <iostream>
+
+using namespace std;
+
+const size_t ARENA_ALIGNMENT = 16;
+//第一块内存的大小，够解码一张 512x512 的 RGBA 贴图和它的 zlib 缓冲，不够时再追加
+const size_t ARENA_INITIAL_CHUNK = 4 * 1024 * 1024;
+
+static size_t alignArenaSize(size_t size)
+{
+    return (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+}
+
+class ImageArena {
+public:
+    ImageArena()
+    : used(0), retired(0), live(0), last(nullptr), lastOffset(0)
+    {
+        memset(&counters, 0, sizeof(counters));
+    }
+
+    ~ImageArena()
+    {
+        for (size_t i = 0; i < chunks.size(); i++)
+            ::free(chunks[i].base);
+    }
+
+    void* alloc(size_t size)
+    {
+        size = alignArenaSize(size > 0 ? size : 1);
+        if (chunks.empty() || used + size > chunks.back().capacity)
+        {
+            if (!addChunk(size > ARENA_INITIAL_CHUNK ? size : ARENA_INITIAL_CHUNK))
+                return nullptr;
+        }
+        lastOffset = used;
+        last = chunks.back().base + used;
+        used += size;
+        live++;
+        counters.allocations++;
+        if (retired + used > counters.highWater)
+            counters.highWater = retired + used;
+        return last;
+    }
+
+    void* realloc(void* p, size_t oldSize, size_t newSize)
+    {
+        if (!p)
+            return alloc(newSize);
+        counters.reallocs++;
+        //最后一次分配的块后面还有空间时直接原地扩大
+        size_t size = alignArenaSize(newSize > 0 ? newSize : 1);
+        if (p == last && lastOffset + size <= chunks.back().capacity)
+        {
+            used = lastOffset + size;
+            counters.reallocsInPlace++;
+            if (retired + used > counters.highWater)
+                counters.highWater = retired + used;
+            return p;
+        }
+        void* moved = alloc(newSize);
+        if (!moved)
+            return nullptr;
+        memcpy(moved, p, oldSize < newSize ? oldSize : newSize);
+        free(p);
+        return moved;
+    }
+
+    void free(void* p)
+    {
+        if (!p)
+            return;
+        counters.frees++;
+        live--;
+        if (p == last)
+        {
+            used = lastOffset;
+            last = nullptr;
+        }
+    }
+
+    void reset()
+    {
+        if (live != 0)
+        {
+            cout << "ERROR::IMAGE_ARENA::RESET_WITH_LIVE_ALLOCATIONS: " << live << endl;
+            return;
+        }
+        //这次解码用了多块内存，合并成一块足够大的，下次就不用再追加
+        if (chunks.size() > 1)
+        {
+            size_t total = 0;
+            for (size_t i = 0; i < chunks.size(); i++)
+            {
+                total += chunks[i].capacity;
+                ::free(chunks[i].base);
+            }
+            chunks.clear();
+            counters.capacity = 0;
+            addChunk(total);
+        }
+        used = 0;
+        retired = 0;
+        last = nullptr;
+        counters.resets++;
+    }
+
+    const ImageArenaStats& stats() const { return counters; }
+
+private:
+    struct Chunk {
+        unsigned char* base;
+        size_t capacity;
+    };
+
+    bool addChunk(size_t capacity)
+    {
+        unsigned char* base = (unsigned char*)::malloc(capacity);
+        if (!base)
+            return false;
+        if (!chunks.empty())
+            retired += used;
+        Chunk chunk = { base, capacity };
+        chunks.push_back(chunk);
+        used = 0;
+        last = nullptr;
+        counters.heapAllocations++;
+        counters.heapBytes += capacity;
+        counters.capacity += capacity;
+        return true;
+    }
+
+    vector<Chunk> chunks;       //只在最后一块里分配，前面的块等 reset 时回收
+    size_t used;                //最后一块已用的字节数
+    size_t retired;             //前面几块已用的字节数
+    size_t live;                //还没有 free 的分配
+    unsigned char* last;
+    size_t lastOffset;
+    ImageArenaStats counters;
+};
+
+static thread_local ImageArena arena;
+
+void* imageArenaAlloc(size_t size)
+{
+    return arena.alloc(size);
+}
+
+void* imageArenaRealloc(void* p, size_t oldSize, size_t newSize)
+{
+    return arena.realloc(p, oldSize, newSize);
+}
+
+void imageArenaFree(void* p)
+{
+    arena.free(p);
+}
+
+void resetImageArena()
+{
+    arena.reset();
+}
+
+const ImageArenaStats& imageArenaStats()
+{
+    return arena.stats();
+}
+
+void printImageArenaStats()
+{
+    const ImageArenaStats& s = arena.stats();
+    cout << "ImageArena: " << s.allocations << " allocs, " << s.reallocs << " reallocs (" << s.reallocsInPlace << " in place), "
+         << s.frees << " frees over " << s.resets << " images; " << s.heapAllocations << " heap allocations / "
+         << s.heapBytes / 1024 << " KB, high water " << s.highWater / 1024 << " KB" << endl;
+}
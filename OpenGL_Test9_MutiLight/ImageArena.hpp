@@ -0,0 +1,34 @@
+#ifndef ImageArena_hpp
+#define ImageArena_hpp
+
+#include <cstddef>
+
+//stb_image 解码用的线性分配器(arena)，每个加载线程一个
+//  stb 在 inflate/解码过程中的 malloc/realloc/free 都从当前线程的 arena 里切内存，
+//  一张贴图上传完毕后 resetImageArena() 把整个 arena 归零，下一张贴图复用同一块内存
+//  一次解码用掉多块内存时，reset 会把它们合并成一块，之后同样大小的贴图不再向系统申请内存
+//  只有最后一次分配可以被真正释放或原地扩大(zlib 输出缓冲正是这种用法)，其余的 free 什么都不做
+
+struct ImageArenaStats {
+    size_t allocations;         //STBI_MALLOC 次数（realloc 需要搬家时也算一次）
+    size_t reallocs;
+    size_t reallocsInPlace;     //在 arena 末尾原地扩大、没有拷贝的 realloc
+    size_t frees;
+    size_t resets;              //resetImageArena 的次数，约等于解码的贴图数
+    size_t heapAllocations;     //arena 向系统申请内存块的次数
+    size_t heapBytes;
+    size_t highWater;           //两次 reset 之间占用的最大字节数
+    size_t capacity;            //arena 当前持有的内存
+};
+
+void* imageArenaAlloc(size_t size);
+void* imageArenaRealloc(void* p, size_t oldSize, size_t newSize);
+void imageArenaFree(void* p);
+// call once the decoded pixels are uploaded or copied; every stb allocation of this thread must have been freed
+void resetImageArena();
+
+// counters of the calling thread's arena
+const ImageArenaStats& imageArenaStats();
+void printImageArenaStats();
+
+#endif /* ImageArena_hpp */
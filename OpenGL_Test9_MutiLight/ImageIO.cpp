@@ -0,0 +1,75 @@
+#include "ImageIO.hpp"
+#include <cstring>
+#include <unordered_map>
+#include <iostream>
+
+using namespace std;
+
+//stdio 的缓冲区大小，glibc 按文件块大小(通常 4KB)分配，这里只用于估算
+const size_t STDIO_BUFFER_SIZE = 4096;
+
+static ImageIOStats ioStats = { 0, 0, 0, 0, 0, 0 };
+static unordered_map<string, shared_ptr<MappedFile> > prefetched;
+
+static shared_ptr<MappedFile> mapFile(const string& path, int advice)
+{
+    shared_ptr<MappedFile> file = make_shared<MappedFile>(path.c_str());
+    file->advise(advice);
+    ioStats.syscalls += file->syscalls();
+    if (file->isOpen())
+    {
+        ioStats.filesMapped++;
+        ioStats.bytesMapped += file->size();
+        ioStats.stdioReadsAvoided += (file->size() + STDIO_BUFFER_SIZE - 1) / STDIO_BUFFER_SIZE;
+        ioStats.bytesCopiesAvoided += 2 * file->size();
+    }
+    return file;
+}
+
+shared_ptr<MappedFile> mapImageFile(const string& path)
+{
+    unordered_map<string, shared_ptr<MappedFile> >::iterator it = prefetched.find(path);
+    if (it != prefetched.end())
+    {
+        ioStats.prefetchHits++;
+        return it->second;
+    }
+    return mapFile(path, MADV_SEQUENTIAL);
+}
+
+void prefetchImageFiles(const vector<string>& paths)
+{
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        if (prefetched.count(paths[i]))
+            continue;
+        shared_ptr<MappedFile> file = mapFile(paths[i], MADV_WILLNEED);
+        if (file->isOpen())
+            prefetched[paths[i]] = file;
+    }
+}
+
+void dropPrefetchedImageFiles()
+{
+    prefetched.clear();
+}
+
+bool sameImageFileContents(const MappedFile& file, const string& path)
+{
+    shared_ptr<MappedFile> other = mapImageFile(path);
+    if (!other->isOpen() || !file.isOpen() || other->size() != file.size())
+        return false;
+    return other.get() == &file || memcmp(other->data(), file.data(), file.size()) == 0;
+}
+
+const ImageIOStats& imageIOStats()
+{
+    return ioStats;
+}
+
+void printImageIOStats()
+{
+    cout << "ImageIO: " << ioStats.filesMapped << " files / " << ioStats.bytesMapped / 1024 << " KB mapped, "
+         << ioStats.prefetchHits << " prefetch hits, " << ioStats.syscalls << " syscalls; stdio would need ~"
+         << ioStats.stdioReadsAvoided << " read() calls and " << ioStats.bytesCopiesAvoided / 1024 << " KB of copies" << endl;
+}
@@ -0,0 +1,36 @@
+#ifndef ImageIO_hpp
+#define ImageIO_hpp
+
+#include "MappedFile.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//贴图文件的 I/O 层：所有贴图都通过 mmap 读取，再交给 stbi_load_from_memory 解码
+//  单个文件映射后标记 MADV_SEQUENTIAL，让内核按顺序预读
+//  场景加载前可以用 prefetchImageFiles 一次性映射所有贴图并标记 MADV_WILLNEED，
+//  内核在后台并行读盘，之后的 mapImageFile 直接复用这些映射
+
+struct ImageIOStats {
+    size_t filesMapped;         //实际映射的文件数
+    size_t prefetchHits;        //mapImageFile 命中预取映射的次数
+    size_t bytesMapped;
+    size_t syscalls;            //open/fstat/mmap/madvise/close 的总次数
+    size_t stdioReadsAvoided;   //同样的数据走 stdio 时估计需要的 read() 次数
+    size_t bytesCopiesAvoided;  //stdio 需要的两次拷贝(内核 -> FILE 缓冲 -> stb 缓冲)省下的字节数
+};
+
+// returns a mapping of path, reusing a prefetched one if present; the result may be !isOpen() when the file is missing
+shared_ptr<MappedFile> mapImageFile(const string& path);
+// maps every existing file in paths with MADV_WILLNEED and keeps the mappings until dropPrefetchedImageFiles()
+void prefetchImageFiles(const vector<string>& paths);
+void dropPrefetchedImageFiles();
+// true if path exists and holds exactly the bytes of file; used to confirm a content-hash match before sharing
+bool sameImageFileContents(const MappedFile& file, const string& path);
+
+const ImageIOStats& imageIOStats();
+void printImageIOStats();
+
+#endif /* ImageIO_hpp */
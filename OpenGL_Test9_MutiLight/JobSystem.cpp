@@ -0,0 +1,277 @@
+#include "JobSystem.hpp"
+#include "TraceRecorder.hpp"
+
+using namespace std;
+
+//当前线程在哪个 JobSystem 里用哪个队列，第一次提交任务时查一次
+static thread_local uint64_t cachedInstance = 0;
+static thread_local int cachedSlot = -1;
+
+static atomic<uint64_t> nextInstanceId(1);
+
+bool JobSystem::JobDeque::push(Job* job)
+{
+    int64_t b = bottom.load(memory_order_relaxed);
+    int64_t t = top.load(memory_order_acquire);
+    if (b - t >= DEQUE_CAPACITY)
+        return false;
+    buffer[b & (DEQUE_CAPACITY - 1)].store(job, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    bottom.store(b + 1, memory_order_relaxed);
+    return true;
+}
+
+JobSystem::Job* JobSystem::JobDeque::pop()
+{
+    int64_t b = bottom.load(memory_order_relaxed) - 1;
+    bottom.store(b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = top.load(memory_order_relaxed);
+    if (t > b)
+    {
+        //队列是空的
+        bottom.store(b + 1, memory_order_relaxed);
+        return nullptr;
+    }
+    Job* job = buffer[b & (DEQUE_CAPACITY - 1)].load(memory_order_relaxed);
+    if (t == b)
+    {
+        //只剩最后一个，和偷的线程抢 top
+        if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+            job = nullptr;
+        bottom.store(b + 1, memory_order_relaxed);
+    }
+    return job;
+}
+
+JobSystem::Job* JobSystem::JobDeque::steal()
+{
+    int64_t t = top.load(memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t b = bottom.load(memory_order_acquire);
+    if (t >= b)
+        return nullptr;
+    Job* job = buffer[t & (DEQUE_CAPACITY - 1)].load(memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+        return nullptr;
+    return job;
+}
+
+JobSystem::JobSystem()
+: queued(0), sleepers(0), stopping(false), instanceId(nextInstanceId++)
+{
+    for (int i = 0; i < MAX_EXTERNAL_THREADS; i++)
+    {
+        externalOwners[i].store(thread::id());
+        slots.push_back(new ThreadSlot());
+    }
+    for (size_t i = 0; i < slots.size(); i++)
+        slots[i]->nextVictim = 0;
+}
+
+JobSystem::~JobSystem()
+{
+    stop();
+    for (size_t i = 0; i < slots.size(); i++)
+        delete slots[i];
+}
+
+void JobSystem::start(int workers)
+{
+    stop();
+    stopping = false;
+    for (int i = 0; i < workers; i++)
+    {
+        ThreadSlot* slot = new ThreadSlot();
+        slot->nextVictim = 0;
+        slots.push_back(slot);
+    }
+    for (int i = 0; i < workers; i++)
+        threads.push_back(thread(&JobSystem::workerMain, this, MAX_EXTERNAL_THREADS + i));
+}
+
+void JobSystem::stop()
+{
+    if (threads.empty())
+        return;
+    {
+        lock_guard<mutex> lock(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+    threads.clear();
+    while ((int)slots.size() > MAX_EXTERNAL_THREADS)
+    {
+        delete slots.back();
+        slots.pop_back();
+    }
+}
+
+int JobSystem::currentSlot()
+{
+    if (cachedInstance == instanceId)
+        return cachedSlot;
+    //外部线程：找自己已经领过的队列，没有就领一个空的
+    thread::id self = this_thread::get_id();
+    int slot = -1;
+    for (int i = 0; i < MAX_EXTERNAL_THREADS && slot < 0; i++)
+        if (externalOwners[i].load() == self)
+            slot = i;
+    for (int i = 0; i < MAX_EXTERNAL_THREADS && slot < 0; i++)
+    {
+        thread::id empty;
+        if (externalOwners[i].compare_exchange_strong(empty, self))
+            slot = i;
+    }
+    cachedInstance = instanceId;
+    cachedSlot = slot;
+    return slot;
+}
+
+void JobSystem::push(int slot, Job* job)
+{
+    //先计数再入队，偷到任务的线程减计数时不会减成负数
+    queued.fetch_add(1);
+    if (!slots[slot]->deque.push(job))
+    {
+        queued.fetch_sub(1);
+        execute(slot, job);
+        return;
+    }
+    //睡着的线程先把 sleepers 加一再检查 queued，这里先改 queued 再看 sleepers，两边至少有一方能看到对方
+    if (sleepers.load() > 0)
+    {
+        lock_guard<mutex> lock(sleepLock);
+        wake.notify_one();
+    }
+}
+
+JobSystem::Job* JobSystem::findJob(int slot)
+{
+    Job* job = slots[slot]->deque.pop();
+    if (!job)
+    {
+        //自己的队列空了，从下一个线程开始轮流偷
+        ThreadSlot* self = slots[slot];
+        size_t count = slots.size();
+        for (size_t i = 0; i < count && !job; i++)
+        {
+            size_t victim = self->nextVictim++ % count;
+            if ((int)victim != slot)
+                job = slots[victim]->deque.steal();
+        }
+    }
+    if (job)
+        queued.fetch_sub(1);
+    return job;
+}
+
+void JobSystem::execute(int slot, Job* job)
+{
+    Job local = *job;
+    delete job;
+    //比 grain 大的区间对半拆：后一半压进队列给别人偷，自己继续拆前一半
+    while (local.grain > 0 && local.end - local.begin > local.grain)
+    {
+        size_t middle = local.begin + (local.end - local.begin) / 2;
+        Job* half = new Job(local);
+        half->begin = middle;
+        local.end = middle;
+        local.counter->pending.fetch_add(1, memory_order_relaxed);
+        push(slot, half);
+    }
+    local.function(local.data, local.begin, local.end);
+    local.counter->pending.fetch_sub(1, memory_order_release);
+}
+
+void JobSystem::run(JobFunction function, void* data, size_t begin, size_t end, JobCounter& counter)
+{
+    counter.pending.fetch_add(1, memory_order_relaxed);
+    int slot = currentSlot();
+    if (slot < 0)
+    {
+        function(data, begin, end);
+        counter.pending.fetch_sub(1, memory_order_release);
+        return;
+    }
+    Job* job = new Job();
+    job->function = function;
+    job->data = data;
+    job->begin = begin;
+    job->end = end;
+    job->grain = 0;
+    job->counter = &counter;
+    push(slot, job);
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, JobFunction function, void* data, JobCounter& counter)
+{
+    if (count == 0)
+        return;
+    counter.pending.fetch_add(1, memory_order_relaxed);
+    int slot = currentSlot();
+    if (slot < 0)
+    {
+        function(data, 0, count);
+        counter.pending.fetch_sub(1, memory_order_release);
+        return;
+    }
+    Job* job = new Job();
+    job->function = function;
+    job->data = data;
+    job->begin = 0;
+    job->end = count;
+    job->grain = grain > 0 ? grain : 1;
+    job->counter = &counter;
+    push(slot, job);
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+    int slot = currentSlot();
+    while (!counter.done())
+    {
+        Job* job = slot >= 0 ? findJob(slot) : nullptr;
+        if (job)
+            execute(slot, job);
+        else
+            this_thread::yield();
+    }
+}
+
+void JobSystem::workerMain(int slot)
+{
+    cachedInstance = instanceId;
+    cachedSlot = slot;
+    traceSetThreadName("job worker");
+    int idle = 0;
+    while (!stopping.load())
+    {
+        Job* job = findJob(slot);
+        if (job)
+        {
+            execute(slot, job);
+            idle = 0;
+            continue;
+        }
+        //先让出几次时间片，马上有新任务时不用经过条件变量；还是没有就睡到有任务入队
+        if (++idle < 64)
+        {
+            this_thread::yield();
+            continue;
+        }
+        unique_lock<mutex> lock(sleepLock);
+        sleepers.fetch_add(1);
+        wake.wait(lock, [this]() { return queued.load() > 0 || stopping.load(); });
+        sleepers.fetch_sub(1);
+        idle = 0;
+    }
+}
+
+JobSystem& jobSystem()
+{
+    static JobSystem system;
+    return system;
+}
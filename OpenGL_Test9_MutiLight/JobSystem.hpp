@@ -0,0 +1,129 @@
+#ifndef JobSystem_hpp
+#define JobSystem_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+//每帧 CPU 任务(剔除、变换、包围球)用的任务窃取调度器
+//每个线程有自己的 Chase-Lev 双端队列：自己从底部压入/取出(不加锁)，空闲的线程从别人的顶部偷
+//parallelFor 把区间对半拆开，一半压进队列给别人偷，另一半自己继续拆，直到不超过 grain 再执行，
+//所以队列里最多只有 log(count / grain) 层任务，先被偷走的总是最大的那一块
+//计数器(JobCounter)记录还没完成的任务数，wait 在等待期间也执行队列里的任务，不会空等
+//
+//工作线程之外的线程(主线程、FramePipeline 的模拟线程)第一次提交任务时领到一个自己的队列，最多 MAX_EXTERNAL_THREADS 个；
+//领不到时任务直接在调用线程上串行执行，结果一样
+//队列里存的是 new 出来的任务，执行它的线程取出参数后就释放；每帧的任务数只有几百个(见 grain)，分配的开销可以忽略
+
+// counts the jobs that have been started and not yet finished; a job may only be waited on through its counter
+struct JobCounter {
+    atomic<int> pending;
+
+    JobCounter() : pending(0) {}
+    bool done() const { return pending.load(memory_order_acquire) == 0; }
+
+private:
+    JobCounter(const JobCounter&);
+    JobCounter& operator=(const JobCounter&);
+};
+
+class JobSystem {
+public:
+    // runs items [begin, end) of a job; data is the pointer handed to run()/parallelFor()
+    typedef void (*JobFunction)(void* data, size_t begin, size_t end);
+
+    static const int MAX_EXTERNAL_THREADS = 4;
+    static const int DEQUE_CAPACITY = 4096;
+
+    JobSystem();
+    ~JobSystem();
+
+    // starts workers background threads (0 = every job runs on the thread that waits for it)
+    void start(int workers);
+    // joins the workers; jobs queued afterwards run on the threads that wait for them
+    // start and stop must not overlap with other threads submitting or waiting for jobs
+    void stop();
+    int workerCount() const { return (int)threads.size(); }
+
+    // queues function(data, begin, end) as a single job and adds it to counter
+    void run(JobFunction function, void* data, size_t begin, size_t end, JobCounter& counter);
+    // queues function over [0, count), split into ranges of at most grain items; adds the jobs to counter
+    void parallelFor(size_t count, size_t grain, JobFunction function, void* data, JobCounter& counter);
+    // executes queued jobs until counter reaches zero
+    void wait(JobCounter& counter);
+
+    // blocking parallel-for over a callable taking (size_t begin, size_t end)
+    template <typename Function>
+    void parallelFor(size_t count, size_t grain, const Function& function)
+    {
+        JobCounter counter;
+        parallelFor(count, grain, &callRange<Function>, (void*)&function, counter);
+        wait(counter);
+    }
+
+private:
+    struct Job {
+        JobFunction function;
+        void* data;
+        size_t begin, end;
+        size_t grain;               //0 = 不拆分
+        JobCounter* counter;
+    };
+
+    //Chase-Lev 双端队列(Lê 等人 2013 年给出的 C11 内存序版本)，容量固定，满了由调用者直接执行
+    class JobDeque {
+    public:
+        JobDeque() : top(0), bottom(0) {}
+        bool push(Job* job);
+        Job* pop();
+        Job* steal();
+
+    private:
+        atomic<int64_t> top;
+        char padding[64];           //top 被偷的线程改，bottom 被队列的主人改，分开放在不同的缓存行
+        atomic<int64_t> bottom;
+        atomic<Job*> buffer[DEQUE_CAPACITY];
+    };
+
+    //每个线程一份：自己的队列和下一个去偷的线程
+    struct ThreadSlot {
+        JobDeque deque;
+        unsigned int nextVictim;
+    };
+
+    template <typename Function>
+    static void callRange(void* data, size_t begin, size_t end)
+    {
+        (*(const Function*)data)(begin, end);
+    }
+
+    int currentSlot();
+    void push(int slot, Job* job);
+    Job* findJob(int slot);
+    void execute(int slot, Job* job);
+    void workerMain(int slot);
+
+    vector<ThreadSlot*> slots;          //0 ~ MAX_EXTERNAL_THREADS-1 给外部线程，后面依次是工作线程
+    vector<thread> threads;
+    atomic<thread::id> externalOwners[MAX_EXTERNAL_THREADS];
+    atomic<int> queued;                 //所有队列里的任务数，空闲的工作线程靠它判断要不要睡
+    atomic<int> sleepers;
+    atomic<bool> stopping;
+    mutex sleepLock;
+    condition_variable wake;
+    uint64_t instanceId;                //线程局部缓存的队列编号属于哪个 JobSystem，地址可能被后来的实例复用，所以另外编号
+
+    JobSystem(const JobSystem&);
+    JobSystem& operator=(const JobSystem&);
+};
+
+// the job system shared by the renderer; runs everything on the calling thread until start() is called
+JobSystem& jobSystem();
+
+#endif /* JobSystem_hpp */
@@ -1,11 +1,17 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
+//逐实例的模型矩阵，占 3~6 四个位置
+layout (location = 3) in mat4 aModel;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+//每帧的摄像机参数，所有程序共用一个缓冲(见 CameraUniforms.hpp)
+layout (std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 viewPosition;
+};
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = viewProjection * (aModel * vec4(aPos, 1.0));
 }
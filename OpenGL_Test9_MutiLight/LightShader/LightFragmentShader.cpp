@@ -2,11 +2,10 @@
 out vec4 FragColor;
 //材质属性结构
 struct Material {
-    sampler2D diffuse;      //漫反射贴图
-    sampler2D specular;     //镜面反射贴图
-    float shininess;    //反光度
+    sampler2DArray maps;    //材质贴图数组，每层 rgb 漫反射，a 镜面反射强度
 };
 
+//以下光源结构都放在 std140 的 LightingBlock 里(见 LightingUniforms.hpp)，vec3 后面跟一个 float 正好凑满 16 字节
 //平行光
 struct DirLight {
     vec3 direction;     //光照射方向
@@ -19,37 +18,54 @@ struct DirLight {
 struct PointLight {
     vec3 position;
     float constant;
-    float linear;
-    float quadratic;
     vec3 ambient;       //环境光
+    float linear;
     vec3 diffuse;       //漫反射
+    float quadratic;
     vec3 specular;      //镜面反射
 };
 
 //聚光灯
 struct SpotLight {
     vec3 position;      //光源位置
-    vec3 direction;     //光照射方向
     float cutOff;       //内圆锥切光角的余弦值
+    vec3 direction;     //光照射方向
     float outerCutOff;  //外圆锥切光角的余弦值
-    float constant;
-    float linear;
-    float quadratic;
     vec3 ambient;       //环境光
+    float constant;
     vec3 diffuse;       //漫反射
+    float linear;
     vec3 specular;      //镜面反射
+    float quadratic;
 };
 
-#define NR_POINT_LIGHTS 4
-uniform DirLight dirLight;
-uniform PointLight pointLights[NR_POINT_LIGHTS];
-uniform SpotLight spotLight;
+//点光源的个数由场景决定，最多 MAX_POINT_LIGHTS 个(与 SceneData.hpp 一致)
+#define MAX_POINT_LIGHTS 32
+//每帧的光照参数，整块用一次 glBufferSubData 上传
+layout (std140) uniform LightingBlock {
+    int pointLightCount;
+    float shininess;    //反光度
+    DirLight dirLight;
+    SpotLight spotLight;
+    PointLight pointLights[MAX_POINT_LIGHTS];
+};
 uniform Material material;  //材质
-uniform vec3 viewPos;
+//与顶点着色器中的声明相同，这里只用到摄像机位置
+layout (std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 viewPosition;
+};
 
 in vec3 FragPos;        //片段的坐标位置
 in vec3 Normal;         //片段的法向量
 in vec2 TexCoords;
+flat in float Layer;    //材质所在的纹理数组层
+
+//每个片段只采样一次材质贴图，所有光源共用
+vec3 diffuseColor;
+vec3 specularColor;
 
 vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
 vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
@@ -57,11 +73,15 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
 
 void main()
 {
+    vec4 texel = texture(material.maps, vec3(TexCoords, Layer));
+    diffuseColor = texel.rgb;
+    specularColor = vec3(texel.a);
+
     vec3 norm = normalize(Normal);  //标准化法向量
-    vec3 viewDir = normalize(viewPos - FragPos);    //观察方向
+    vec3 viewDir = normalize(viewPosition.xyz - FragPos);    //观察方向
     
     vec3 result = CalcDirLight(dirLight, norm, viewDir);
-    for (int i = 0; i < NR_POINT_LIGHTS; i++)
+    for (int i = 0; i < pointLightCount; i++)
     {
         result += CalcPointLight(pointLights[i], norm, FragPos, viewDir);
     }
@@ -77,11 +97,11 @@ vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
     float diff = max(dot(normal, lightDir), 0.0);
     // 镜面光着色
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
     // 合并结果
-    vec3 ambient  = light.ambient  * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse  = light.diffuse  * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
+    vec3 ambient  = light.ambient  * diffuseColor;
+    vec3 diffuse  = light.diffuse  * diff * diffuseColor;
+    vec3 specular = light.specular * spec * specularColor;
     return (ambient + diffuse + specular);
 }
 
@@ -92,14 +112,14 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     float diff = max(dot(normal, lightDir), 0.0);
     // 镜面光着色
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
     // 衰减
     float distance    = length(light.position - fragPos);
     float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
     // 合并结果
-    vec3 ambient  = light.ambient  * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse  = light.diffuse  * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
+    vec3 ambient  = light.ambient  * diffuseColor;
+    vec3 diffuse  = light.diffuse  * diff * diffuseColor;
+    vec3 specular = light.specular * spec * specularColor;
     ambient  *= attenuation;
     diffuse  *= attenuation;
     specular *= attenuation;
@@ -113,7 +133,7 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     float diff = max(dot(normal, lightDir), 0.0);
     // specular shading
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
     // attenuation
     float distance = length(light.position - fragPos);
     float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
@@ -122,9 +142,9 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     float epsilon = light.cutOff - light.outerCutOff;
     float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
     // combine results
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
+    vec3 ambient = light.ambient * diffuseColor;
+    vec3 diffuse = light.diffuse * diff * diffuseColor;
+    vec3 specular = light.specular * spec * specularColor;
     ambient *= attenuation * intensity;
     diffuse *= attenuation * intensity;
     specular *= attenuation * intensity;
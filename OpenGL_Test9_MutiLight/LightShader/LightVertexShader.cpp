@@ -2,23 +2,32 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+//逐实例属性：模型矩阵占 3~6 四个位置，材质所在的纹理数组层，法线矩阵占 8~10 三个位置
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in float aLayer;
+layout (location = 8) in mat3 aNormalMatrix;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+//每帧的摄像机参数，所有程序共用一个缓冲(见 CameraUniforms.hpp)
+layout (std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 viewPosition;
+};
 
 out vec3 FragPos;   //片段的坐标位置
 out vec3 Normal;    //片段的法向量
 
 out vec2 TexCoords;
+flat out float Layer;
 
 void main()
 {    
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    FragPos = vec3(aModel * vec4(aPos, 1.0));
+    Normal = aNormalMatrix * aNormal;
     TexCoords = aTexCoords;
-    //使用inverse和transpose函数自己生成这个法线矩阵
-    //法线矩阵让法向量转换在世界空间坐标中
-    //inverse函数：得到逆矩阵。      transpose函数：得到转置矩阵
-    gl_Position = projection * view * vec4(FragPos, 1.0);
+    Layer = aLayer;
+    //法线矩阵让法向量转换在世界空间坐标中，即 transpose(inverse(mat3(aModel)))
+    //每个实例只需要算一次，放在 CPU 上批量算好(见 TransformBatch)，不再每个顶点调用 inverse
+    gl_Position = viewProjection * vec4(FragPos, 1.0);
 }
@@ -0,0 +1,428 @@
+#include "LightingScene.hpp"
+#include "TextureLoader.hpp"
+#include "ImageIO.hpp"
+#include "ImageArena.hpp"
+#include "RenderStats.h"
+#include "TraceRecorder.hpp"
+#include "SceneData.hpp"
+#include "TransformBatch.hpp"
+#include "SceneFile.hpp"
+#include "FrustumCulling.h"
+#include "JobSystem.hpp"
+#include "GLExtensions.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cmath>
+#include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+using namespace std;
+using namespace glm;
+
+LightingScene::LightingScene()
+: lightingShader(nullptr), lightCubeShader(nullptr), VBO(0), cubeVAO(0), lightCubeVAO(0), instanceVBO(0), lampInstanceVBO(0),
+  textureCache(256 * 1024 * 1024),     //显存预算 256MB，超出时淘汰最久没用且没有被引用的贴图
+  materials(&textureCache), cachedVersion(0), profiler(nullptr), reversedDepthAllowed(true), reversedDepthEnabled(false)
+{
+}
+
+LightingScene::~LightingScene()
+{
+    delete lightingShader;
+    delete lightCubeShader;
+}
+
+bool LightingScene::init(const string& shaderDir, const string& textureDir, const SceneFile* sceneFile)
+{
+    // build and compile our shader program
+    // ------------------------------------
+    lightingShader = new Shader((shaderDir + "LightShader/LightVertexShader.cpp").c_str(), (shaderDir + "LightShader/LightFragmentShader.cpp").c_str());
+    lightCubeShader = new Shader((shaderDir + "LampShader/LampVertexShader.cpp").c_str(), (shaderDir + "LampShader/LampFragmentShader.cpp").c_str());
+    //着色器读不到或编译不过时画出来的只有清屏颜色，无窗口模式下必须当成失败
+    if (!lightingShader->isValid() || !lightCubeShader->isValid())
+        return false;
+    // set up vertex data (and buffer(s)) and configure vertex attributes
+    // ------------------------------------------------------------------
+    
+    glGenBuffers(1, &VBO);
+    //被照射的立方体顶点缓冲数组
+    glGenVertexArrays(1, &cubeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
+    glBindVertexArray(cubeVAO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    //光源立方体顶点缓冲数组
+    glGenVertexArrays(1, &lightCubeVAO);
+    glBindVertexArray(lightCubeVAO);
+    // we only need to bind to the VBO (to link it with glVertexAttribPointer), no need to fill it; the VBO's data already contains all we need (it's already bound, but we do it again for educational purposes)
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    //场景用到的材质：默认场景只有箱子一种；场景文件按材质表的顺序注册，场景里的材质编号就是表中的下标
+    vector<string> diffusePaths, specularPaths;
+    if (sceneFile)
+    {
+        for (uint32_t i = 0; i < sceneFile->materialCount(); i++)
+        {
+            diffusePaths.push_back(textureDir + sceneFile->materials()[i].diffusePath.pointer);
+            specularPaths.push_back(textureDir + sceneFile->materials()[i].specularPath.pointer);
+        }
+    }
+    else
+    {
+        diffusePaths.push_back(textureDir + "container2.png");     //CONTAINER_MATERIAL
+        specularPaths.push_back(textureDir + "container2_specular.png");
+    }
+    //先把场景用到的所有贴图文件映射进来，让内核在后台一起预读，解码时直接命中页缓存
+    vector<string> sceneImages;
+    for (size_t i = 0; i < diffusePaths.size(); i++)
+    {
+        sceneImages.push_back(cookedTexturePath(diffusePaths[i].c_str()));
+        sceneImages.push_back(diffusePaths[i]);
+        sceneImages.push_back(specularPaths[i]);
+    }
+    prefetchImageFiles(sceneImages);
+    //场景里的材质编号 -> 注册表里的材质
+    sceneMaterials.clear();
+    bool materialsLoaded = true;
+    for (size_t i = 0; i < diffusePaths.size(); i++)
+    {
+        sceneMaterials.push_back(materials.addMaterial(diffusePaths[i].c_str(), specularPaths[i].c_str()));
+        if (sceneMaterials.back().array < 0)
+        {
+            cout << "ERROR::LIGHTING_SCENE::MATERIAL_LOAD_FAILED: " << diffusePaths[i] << ", " << specularPaths[i] << endl;
+            materialsLoaded = false;
+        }
+    }
+    materialsLoaded = materials.upload() && materialsLoaded;
+    dropPrefetchedImageFiles();
+    if (!materialsLoaded)
+        return false;
+    printImageIOStats();
+    printImageArenaStats();
+
+    sceneStore.clear();
+    if (sceneFile)
+        sceneFile->populate(sceneStore);
+    else
+        populateDefaultScene(sceneStore);
+
+    glGenBuffers(1, &instanceVBO);
+    glGenBuffers(1, &lampInstanceVBO);
+    //灯泡的逐实例属性只有模型矩阵，一次实例化绘制画完，属性设置一次就不用再动
+    glBindVertexArray(lightCubeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, lampInstanceVBO);
+    for (unsigned int column = 0; column < 4; column++)
+    {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(mat4), (void*)(column * sizeof(vec4)));
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribDivisor(3 + column, 1);
+    }
+    updateSceneCache();
+
+    glEnable(GL_DEPTH_TEST);
+    //支持 glClipControl 时用反向 Z：深度范围 [0, 1]，近处为 1，远平面在无穷远处为 0，深度测试和清屏的值都反过来
+    //不支持时保持标准的 [-1, 1] 深度范围和 FAR_PLANE，画面上看不出区别，只是远处的深度精度差
+    reversedDepthEnabled = reversedDepthAllowed && hasClipControl();
+    if (reversedDepthEnabled)
+    {
+        clipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE);
+        glDepthFunc(GL_GREATER);
+        glClearDepth(0.0);
+    }
+    //写入帧缓冲时由硬件把线性颜色编码回 sRGB
+    glEnable(GL_FRAMEBUFFER_SRGB);
+    //清屏颜色也会被编码，所以用线性空间的颜色，屏幕上看起来保持不变
+    clearColor = sceneClearColor();
+    //两个程序的 CameraBlock 都指向同一个 uniform 缓冲，每帧上传一次
+    cameraUniforms.create();
+    lightingShader->setUniformBlockBinding("CameraBlock", CameraUniforms::BINDING);
+    lightCubeShader->setUniformBlockBinding("CameraBlock", CameraUniforms::BINDING);
+    //光照参数只有光照程序用到，同样每帧整块上传一次
+    lightingUniforms.create();
+    lightingShader->setUniformBlockBinding("LightingBlock", LightingUniforms::BINDING);
+    lightingShader->use();
+    lightingShader->setInt("material.maps", 0);
+    return true;
+}
+
+void LightingScene::setupCamera(Camera& camera, int width, int height) const
+{
+    camera.SetReversedZ(reversedDepthEnabled);
+    camera.SetProjection((float)width / (float)height, camera.NearPlane, reversedDepthEnabled ? INFINITE_FAR_PLANE : FAR_PLANE);
+}
+
+void LightingScene::render(Camera& camera, int width, int height)
+{
+    setupCamera(camera, width, height);
+    buildPacket(camera, serialPacket);
+    submit(serialPacket);
+}
+
+//剔除和矩阵计算按块交给任务系统：每块的大小(物体数)，块内的工作足够多，拆分和窃取的开销可以忽略
+static const size_t CULL_CHUNK = 2048;
+static const size_t TRANSFORM_GRAIN = 2048;
+
+void LightingScene::buildPacket(const Camera& camera, FramePacket& packet)
+{
+    if (sceneStore.version() != cachedVersion)
+        updateSceneCache();
+
+    // view/projection transformations, cached by the camera until it moves
+    packet.projection = camera.GetProjectionMatrix();
+    packet.view = camera.GetViewMatrix();
+    packet.viewProjection = camera.GetViewProjectionMatrix();
+    packet.viewPos = camera.Position;
+    {
+        TraceScope trace("light selection");
+        packet.lighting = sceneLighting(sceneStore, camera);
+    }
+
+    TraceScope trace("frustum culling");
+    vec4 planes[6];
+    frustumPlanes(packet.viewProjection, planes);
+    //分两遍并行：先逐块标记可见并计数，前缀和得到每块在帧包里的起点，再逐块拷贝，结果和串行剔除的顺序一样
+    size_t count = sceneContainers.size();
+    size_t chunks = (count + CULL_CHUNK - 1) / CULL_CHUNK;
+    containerVisible.resize(count);
+    cullChunkOffsets.resize(chunks + 1);
+    jobSystem().parallelFor(chunks, 1, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; chunk++)
+        {
+            size_t visible = 0;
+            for (size_t i = chunk * CULL_CHUNK; i < std::min(count, (chunk + 1) * CULL_CHUNK); i++)
+            {
+                containerVisible[i] = sphereVisible(planes, containerBounds[i]);
+                visible += containerVisible[i];
+            }
+            cullChunkOffsets[chunk + 1] = visible;
+        }
+    });
+    cullChunkOffsets[0] = 0;
+    for (size_t chunk = 0; chunk < chunks; chunk++)
+        cullChunkOffsets[chunk + 1] += cullChunkOffsets[chunk];
+    packet.containers.resize(cullChunkOffsets[chunks]);
+    jobSystem().parallelFor(chunks, 1, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; chunk++)
+        {
+            size_t out = cullChunkOffsets[chunk];
+            for (size_t i = chunk * CULL_CHUNK; i < std::min(count, (chunk + 1) * CULL_CHUNK); i++)
+                if (containerVisible[i])
+                    packet.containers[out++] = sceneContainers[i];
+        }
+    });
+    packet.culled = (unsigned int)(count - packet.containers.size());
+
+    //缓存里的实例已经按纹理数组排好，剔除后依旧有序，直接切成批次
+    packet.batches.clear();
+    for (size_t i = 0; i < packet.containers.size(); i++)
+    {
+        if (packet.batches.empty() || packet.batches.back().array != packet.containers[i].array)
+        {
+            InstanceBatch batch = { packet.containers[i].array, (int)i, 0 };
+            packet.batches.push_back(batch);
+        }
+        packet.batches.back().count++;
+    }
+    packet.lamps.clear();
+    for (size_t i = 0; i < sceneLamps.size(); i++)
+    {
+        if (sphereVisible(planes, lampBounds[i]))
+            packet.lamps.push_back(sceneLamps[i]);
+        else
+            packet.culled++;
+    }
+}
+
+void LightingScene::submit(const FramePacket& packet)
+{
+    renderStats().culled += packet.culled;
+    {
+        //可见的实例每帧都不一样，整块重新上传；先用 nullptr 分配让驱动换一块新存储，不必等上一帧的绘制用完旧的
+        TraceScope trace("instance upload");
+        glBindVertexArray(cubeVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, packet.containers.size() * sizeof(ContainerInstance), nullptr, GL_STREAM_DRAW);
+        if (!packet.containers.empty())
+            glBufferSubData(GL_ARRAY_BUFFER, 0, packet.containers.size() * sizeof(ContainerInstance), packet.containers.data());
+        setContainerInstanceAttributes(0);
+        glBindBuffer(GL_ARRAY_BUFFER, lampInstanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, packet.lamps.size() * sizeof(mat4), nullptr, GL_STREAM_DRAW);
+        if (!packet.lamps.empty())
+            glBufferSubData(GL_ARRAY_BUFFER, 0, packet.lamps.size() * sizeof(mat4), packet.lamps.data());
+
+        //两个程序共用的摄像机 uniform 块
+        CameraBlock block;
+        block.view = packet.view;
+        block.projection = packet.projection;
+        block.viewProjection = packet.viewProjection;
+        block.viewPosition = vec4(packet.viewPos, 1.0f);
+        cameraUniforms.update(block);
+    }
+
+    {
+        GpuProfileScope scope(profiler, "clear");
+        glClearColor(clearColor.x, clearColor.y, clearColor.z, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    {
+        GpuProfileScope scope(profiler, "containers");
+        {
+            TraceScope trace("light uniforms");
+            //所有光源参数在一个 std140 uniform 块里，一次 glBufferSubData 上传
+            lightingUniforms.update(packet.lighting);
+        }
+
+        {
+            TraceScope trace("container draws");
+            // be sure to activate shader when drawing objects
+            lightingShader->use();
+            // render containers: one instanced draw per material texture array
+            const vector<InstanceBatch>& batches = packet.batches;
+            glBindVertexArray(cubeVAO);
+            for (size_t b = 0; b < batches.size(); b++)
+            {
+                if (batches[b].array >= 0)
+                    materials.bindArray(batches[b].array, 0);
+                if (batches.size() > 1)
+                {
+                    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+                    setContainerInstanceAttributes(batches[b].first);
+                }
+                glDrawArraysInstanced(GL_TRIANGLES, 0, 36, batches[b].count);
+                renderStats().drawCalls++;
+                renderStats().instances += batches[b].count;
+            }
+        }
+    }
+
+    {
+        GpuProfileScope scope(profiler, "lamps");
+        TraceScope trace("lamp draws");
+        // also draw the lamp object(s)
+        lightCubeShader->use();
+    
+        // we now draw as many light bulbs as are in view, in one instanced draw
+        glBindVertexArray(lightCubeVAO);
+        int lampCount = (int)packet.lamps.size();
+        if (lampCount > 0)
+        {
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 36, lampCount);
+            renderStats().drawCalls++;
+            renderStats().instances += lampCount;
+        }
+    }
+}
+
+void LightingScene::cleanup()
+{
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    glDeleteVertexArrays(1, &cubeVAO);
+    glDeleteVertexArrays(1, &lightCubeVAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &instanceVBO);
+    glDeleteBuffers(1, &lampInstanceVBO);
+    cameraUniforms.destroy();
+    lightingUniforms.destroy();
+    if (reversedDepthEnabled)
+    {
+        //把深度状态还原成默认值，同一个上下文之后的绘制不受影响
+        clipControl(GL_LOWER_LEFT, GL_NEGATIVE_ONE_TO_ONE);
+        glDepthFunc(GL_LESS);
+        glClearDepth(1.0);
+        reversedDepthEnabled = false;
+    }
+    if (lightingShader)
+        glDeleteProgram(lightingShader->ID);
+    if (lightCubeShader)
+        glDeleteProgram(lightCubeShader->ID);
+    materials.clear();
+    const TextureCache::Stats& textureStats = textureCache.stats();
+    cout << "TextureCache: " << textureStats.residentCount << " textures / " << textureStats.residentBytes / 1024
+         << " KB resident, " << textureStats.evictions << " evictions" << endl;
+    textureCache.clear();
+}
+
+//场景有变化时重新计算所有实例的矩阵和包围球，按纹理数组排好；场景不变时每帧只做剔除
+void LightingScene::updateSceneCache()
+{
+    TraceScope trace("instance matrices");
+    size_t count = sceneStore.renderableCount();
+    vector<ContainerInstance> computed(count);
+    if (count > 0)
+    {
+        //按 8 个一组分给任务系统，每段的起点都是 8 的倍数
+        const TransformBatch& transforms = sceneStore.renderableTransforms();
+        jobSystem().parallelFor((count + 7) / 8, TRANSFORM_GRAIN / 8, [&](size_t begin, size_t end) {
+            transforms.computeMatrices(begin * 8, end * 8, &computed[0].model, sizeof(ContainerInstance), &computed[0].normalMatrix, sizeof(ContainerInstance));
+        });
+    }
+
+    const vector<int>& meshes = sceneStore.renderableMeshes();
+    const vector<int>& materialIds = sceneStore.renderableMaterials();
+    sceneContainers.clear();
+    sceneLamps.clear();
+    sceneContainers.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (meshes[i] == MESH_LAMP)
+        {
+            sceneLamps.push_back(computed[i].model);
+            continue;
+        }
+        //没有注册过的材质编号退回第一个材质，一个材质都没有时不绑定贴图
+        MaterialHandle material = { -1, 0 };
+        if (materialIds[i] >= 0 && materialIds[i] < (int)sceneMaterials.size())
+            material = sceneMaterials[materialIds[i]];
+        else if (!sceneMaterials.empty())
+            material = sceneMaterials[CONTAINER_MATERIAL];
+        computed[i].layer = (float)material.layer;
+        computed[i].array = material.array;
+        sceneContainers.push_back(computed[i]);
+    }
+    //按纹理数组排序，同一个数组的实例连在一起画
+    stable_sort(sceneContainers.begin(), sceneContainers.end(), [](const ContainerInstance& a, const ContainerInstance& b) { return a.array < b.array; });
+
+    containerBounds.resize(sceneContainers.size());
+    jobSystem().parallelFor(sceneContainers.size(), TRANSFORM_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            containerBounds[i] = boundingSphere(sceneContainers[i].model);
+    });
+    lampBounds.resize(sceneLamps.size());
+    for (size_t i = 0; i < sceneLamps.size(); i++)
+        lampBounds[i] = boundingSphere(sceneLamps[i]);
+    cachedVersion = sceneStore.version();
+}
+
+// points the per-instance attributes (locations 3-10) of the bound VAO at the instance buffer, starting at firstInstance
+// (GL 3.3 has no base-instance draws, so each batch re-points the attributes instead)
+void LightingScene::setContainerInstanceAttributes(int firstInstance)
+{
+    size_t base = firstInstance * sizeof(ContainerInstance);
+    for (unsigned int column = 0; column < 4; column++)
+    {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(ContainerInstance), (void*)(base + column * sizeof(vec4)));
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribDivisor(3 + column, 1);
+    }
+    glVertexAttribPointer(7, 1, GL_FLOAT, GL_FALSE, sizeof(ContainerInstance), (void*)(base + offsetof(ContainerInstance, layer)));
+    glEnableVertexAttribArray(7);
+    glVertexAttribDivisor(7, 1);
+    for (unsigned int column = 0; column < 3; column++)
+    {
+        size_t offset = base + offsetof(ContainerInstance, normalMatrix) + column * sizeof(vec3);
+        glVertexAttribPointer(8 + column, 3, GL_FLOAT, GL_FALSE, sizeof(ContainerInstance), (void*)offset);
+        glEnableVertexAttribArray(8 + column);
+        glVertexAttribDivisor(8 + column, 1);
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef LightingScene_hpp
+#define LightingScene_hpp
+
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Shader.h"
+#include "Camera.hpp"
+#include "TextureCache.hpp"
+#include "MaterialRegistry.hpp"
+#include "GpuProfiler.hpp"
+#include "SceneStore.hpp"
+#include "SceneFile.hpp"
+#include "FramePacket.hpp"
+#include "CameraUniforms.hpp"
+#include "LightingUniforms.hpp"
+
+using namespace std;
+using namespace glm;
+
+//多光源场景：SceneStore 里的箱子和点光源灯泡(默认 10 个箱子 + 4 个灯泡) + 平行光 + 跟随摄像机的聚光灯
+//每帧分两步：buildPacket 只在 CPU 上做视锥剔除、算矩阵和光源，写成帧包；submit 只做 GL 调用
+//两步可以在同一个线程里依次执行(render)，也可以交给 FramePipeline 放到两个线程上重叠执行
+//场景可以在运行时增删物体，下一次 buildPacket 发现版本号变了就重新计算所有实例的矩阵
+//只依赖当前的 GL 上下文，窗口模式和无窗口(headless)模式共用同一份场景和绘制代码
+class LightingScene {
+public:
+    LightingScene();
+    ~LightingScene();
+
+    // compiles the shaders and uploads geometry and materials into the current context
+    // shaderDir holds LightShader/ and LampShader/, textureDir holds container2.png and container2_specular.png
+    // with a sceneFile its instances, lights and materials (relative to textureDir) replace the default scene
+    // returns false when a shader fails to read, compile or link, or a material's textures cannot be loaded
+    bool init(const string& shaderDir, const string& textureDir, const SceneFile* sceneFile = nullptr);
+    // draws one frame into the currently bound framebuffer: buildPacket followed by submit on the calling thread
+    // the camera is prepared with setupCamera() first
+    void render(Camera& camera, int width, int height);
+    // sets the camera's aspect ratio to width / height and its depth mode to the one init() chose:
+    // reversed-Z with an infinite far plane, or the standard depth range up to FAR_PLANE
+    void setupCamera(Camera& camera, int width, int height) const;
+    // CPU half of a frame: culls the scene against the camera frustum and fills the packet; makes no GL calls,
+    // so it may run on another thread as long as nothing else touches scene() meanwhile
+    // culling and matrix updates are split across jobSystem()
+    // the projection is the camera's own; prepare the camera with setupCamera() so it matches the context's depth mode
+    void buildPacket(const Camera& camera, FramePacket& packet);
+    // GL half of a frame: uploads the visible instances of the packet and draws them into the currently bound framebuffer
+    void submit(const FramePacket& packet);
+    // frees every GL object and prints the texture cache statistics; must run while the context is alive
+    void cleanup();
+    // the entities drawn by render(); filled with the default scene by init(), may be changed between frames
+    SceneStore& scene() { return sceneStore; }
+    // times the clear, container and lamp passes of every render() call; nullptr turns it off
+    void setProfiler(GpuProfiler* gpuProfiler) { profiler = gpuProfiler; }
+    // init() switches the context to reversed-Z when glClipControl is available (see Camera::ReversedZ);
+    // false keeps the standard depth range, e.g. to compare both; call before init()
+    void allowReversedDepth(bool allowed) { reversedDepthAllowed = allowed; }
+    bool reversedDepth() const { return reversedDepthEnabled; }
+
+private:
+    void updateSceneCache();
+    void setContainerInstanceAttributes(int firstInstance);
+
+    Shader* lightingShader;
+    Shader* lightCubeShader;
+    unsigned int VBO;
+    unsigned int cubeVAO;
+    unsigned int lightCubeVAO;
+    unsigned int instanceVBO;
+    unsigned int lampInstanceVBO;       //灯泡的模型矩阵
+    CameraUniforms cameraUniforms;
+    LightingUniforms lightingUniforms;
+    TextureCache textureCache;
+    MaterialRegistry materials;
+    SceneStore sceneStore;
+    vector<MaterialHandle> sceneMaterials;  //下标是场景里的材质编号
+    //场景不变时每帧复用的实例数据，已按纹理数组排好；包围球(xyz 球心, w 半径)用于视锥剔除
+    vector<ContainerInstance> sceneContainers;
+    vector<vec4> containerBounds;
+    vector<mat4> sceneLamps;
+    vector<vec4> lampBounds;
+    uint64_t cachedVersion;                 //上面这些数据对应的场景版本
+    vector<unsigned char> containerVisible; //剔除的中间结果，每帧复用
+    vector<size_t> cullChunkOffsets;
+    FramePacket serialPacket;               //render() 自己用的帧包，复用其中的数组
+    vec3 clearColor;
+    GpuProfiler* profiler;
+    bool reversedDepthAllowed;
+    bool reversedDepthEnabled;              //init() 是否打开了反向 Z
+
+    LightingScene(const LightingScene&);
+    LightingScene& operator=(const LightingScene&);
+};
+
+#endif /* LightingScene_hpp */
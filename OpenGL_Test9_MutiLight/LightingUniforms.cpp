@@ -0,0 +1,67 @@
+#include "LightingUniforms.hpp"
+
+LightingUniforms::LightingUniforms()
+: buffer(0), block()
+{
+}
+
+LightingUniforms::~LightingUniforms()
+{
+    // the buffer is released by destroy() while the context is still current
+}
+
+void LightingUniforms::create()
+{
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(LightingBlock), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, buffer);
+}
+
+void LightingUniforms::update(const SceneLighting& lighting)
+{
+    int count = (int)lighting.pointLights.size();
+    block.pointLightCount = count;
+    block.shininess = lighting.shininess;
+
+    block.dirLight.direction = lighting.dirLight.direction;
+    block.dirLight.ambient = lighting.dirLight.ambient;
+    block.dirLight.diffuse = lighting.dirLight.diffuse;
+    block.dirLight.specular = lighting.dirLight.specular;
+
+    block.spotLight.position = lighting.spotLight.position;
+    block.spotLight.direction = lighting.spotLight.direction;
+    block.spotLight.ambient = lighting.spotLight.ambient;
+    block.spotLight.diffuse = lighting.spotLight.diffuse;
+    block.spotLight.specular = lighting.spotLight.specular;
+    block.spotLight.cutOff = lighting.spotLight.cutOff;
+    block.spotLight.outerCutOff = lighting.spotLight.outerCutOff;
+    block.spotLight.constant = lighting.spotLight.constant;
+    block.spotLight.linear = lighting.spotLight.linear;
+    block.spotLight.quadratic = lighting.spotLight.quadratic;
+
+    for (int i = 0; i < count; i++)
+    {
+        const PointLight& light = lighting.pointLights[i];
+        PointLightBlock& packed = block.pointLights[i];
+        packed.position = light.position;
+        packed.ambient = light.ambient;
+        packed.diffuse = light.diffuse;
+        packed.specular = light.specular;
+        packed.constant = light.constant;
+        packed.linear = light.linear;
+        packed.quadratic = light.quadratic;
+    }
+
+    //着色器只读前 pointLightCount 个点光源，后面的不用上传
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, offsetof(LightingBlock, pointLights) + count * sizeof(PointLightBlock), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void LightingUniforms::destroy()
+{
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+}
@@ -0,0 +1,70 @@
+#ifndef LightingUniforms_hpp
+#define LightingUniforms_hpp
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include "SceneData.hpp"
+
+using namespace glm;
+
+//每帧一次的光照 uniform 块，和 CameraBlock 一样整块上传，不再逐个成员调用 glUniform*：
+//  layout (std140) uniform LightingBlock { int pointLightCount; float shininess; DirLight dirLight; SpotLight spotLight; PointLight pointLights[MAX_POINT_LIGHTS]; };
+//std140 里 vec3 按 16 字节对齐，紧跟在后面的 float 正好填进它的第 4 个分量，所以成员按 vec3 + float 成对排列
+struct DirLightBlock {
+    vec3 direction;     float pad0;
+    vec3 ambient;       float pad1;
+    vec3 diffuse;       float pad2;
+    vec3 specular;      float pad3;
+};
+
+struct PointLightBlock {
+    vec3 position;      float constant;
+    vec3 ambient;       float linear;
+    vec3 diffuse;       float quadratic;
+    vec3 specular;      float pad;
+};
+
+struct SpotLightBlock {
+    vec3 position;      float cutOff;
+    vec3 direction;     float outerCutOff;
+    vec3 ambient;       float constant;
+    vec3 diffuse;       float linear;
+    vec3 specular;      float quadratic;
+};
+
+struct LightingBlock {
+    int pointLightCount;
+    float shininess;        //材质反光度
+    float pad[2];
+    DirLightBlock dirLight;
+    SpotLightBlock spotLight;
+    PointLightBlock pointLights[MAX_POINT_LIGHTS];      //只上传前 pointLightCount 个
+};
+
+static_assert(offsetof(LightingBlock, dirLight) == 16 && offsetof(LightingBlock, spotLight) == 80 &&
+              offsetof(LightingBlock, pointLights) == 160 && sizeof(PointLightBlock) == 64, "LightingBlock must match the std140 layout");
+
+class LightingUniforms {
+public:
+    //uniform 块绑定点，紧接在 CameraUniforms::BINDING 之后
+    static const unsigned int BINDING = 1;
+
+    LightingUniforms();
+    ~LightingUniforms();
+
+    // creates the buffer and binds it to BINDING; needs a current GL context
+    void create();
+    // packs the frame's lighting into the std140 layout and uploads it with a single glBufferSubData
+    void update(const SceneLighting& lighting);
+    void destroy();
+
+private:
+    unsigned int buffer;
+    LightingBlock block;        //打包用的暂存，避免每帧在栈上放 2KB
+
+    LightingUniforms(const LightingUniforms&);
+    LightingUniforms& operator=(const LightingUniforms&);
+};
+
+#endif /* LightingUniforms_hpp */
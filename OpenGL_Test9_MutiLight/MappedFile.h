@@ -0,0 +1,72 @@
+#ifndef MappedFile_h
+#define MappedFile_h
+
+#include <cstddef>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//只读内存映射文件：打开后整个文件映射到进程地址空间，析构时自动解除映射
+//用于直接从磁盘页读取贴图数据，避免 stdio 的缓冲拷贝
+//copyOnWrite 时映射成可写的私有映射：写过的页在本进程里复制一份，不会写回文件，只读的页仍然和页缓存共享
+class MappedFile{
+public:
+    MappedFile(const char* path, bool copyOnWrite = false)
+    : bytes(nullptr), length(0), calls(0), writable(copyOnWrite)
+    {
+        int fd = open(path, O_RDONLY);
+        calls++;
+        if (fd < 0)
+            return;
+        struct stat st;
+        calls++;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void* p = mmap(nullptr, (size_t)st.st_size, copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+            calls++;
+            if (p != MAP_FAILED)
+            {
+                bytes = (const unsigned char*)p;
+                length = (size_t)st.st_size;
+            }
+        }
+        // the mapping stays valid after the descriptor is closed
+        close(fd);
+        calls++;
+    }
+
+    ~MappedFile()
+    {
+        if (bytes)
+            munmap((void*)bytes, length);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // access pattern hint for the kernel, e.g. MADV_SEQUENTIAL for a one-pass decode or MADV_WILLNEED to start read-ahead
+    void advise(int advice)
+    {
+        if (!bytes)
+            return;
+        madvise((void*)bytes, length, advice);
+        calls++;
+    }
+
+    bool isOpen() const { return bytes != nullptr; }
+    const unsigned char* data() const { return bytes; }
+    // nullptr unless the file was mapped copy-on-write
+    unsigned char* mutableData() const { return writable ? (unsigned char*)bytes : nullptr; }
+    size_t size() const { return length; }
+    //到目前为止发出的系统调用次数（不含析构时的 munmap）
+    int syscalls() const { return calls; }
+
+private:
+    const unsigned char* bytes;
+    size_t length;
+    int calls;
+    bool writable;
+};
+
+#endif /* MappedFile_h */
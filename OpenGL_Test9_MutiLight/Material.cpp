@@ -0,0 +1,83 @@
+#include "Material.hpp"
+#include "TextureLoader.hpp"
+#include "CookedTexture.h"
+#include "ImageIO.hpp"
+#include "ImageArena.hpp"
+#include "stb_image.h"
+#include <unistd.h>
+#include <iostream>
+
+using namespace std;
+
+//离线烘焙时已经合并过的材质贴图：只记下各级 mipmap 在映射里的位置，映射一直保留到上传完成
+static bool loadCookedMaterial(const char* path, PackedMaterialImage& image)
+{
+    shared_ptr<MappedFile> file = mapImageFile(path);
+    if (!file->isOpen() || !validateCookedTexture(file->data(), file->size()))
+        return false;
+    const CookedTextureHeader* header = (const CookedTextureHeader*)file->data();
+    //材质数组按 sRGB 存储，没有用 --srgb 烘焙的材质贴图不能直接用，退回原图
+    if (!(header->flags & CTEX_FLAG_PACKED_SPECULAR) || !(header->flags & CTEX_FLAG_SRGB))
+        return false;
+    if (header->format != CTEX_FORMAT_RGBA8 && header->format != CTEX_FORMAT_BC3)
+        return false;
+    //压缩格式不能由驱动生成 mipmap，BC3 必须带完整的 mipmap 链
+    if (header->format == CTEX_FORMAT_BC3 && (int)header->levelCount != fullMipLevelCount((int)header->width, (int)header->height))
+        return false;
+    const CookedTextureLevel* levels = (const CookedTextureLevel*)(header + 1);
+    image.width = (int)header->width;
+    image.height = (int)header->height;
+    image.format = header->format;
+    image.file = file;
+    image.pixels.clear();
+    image.levelOffsets.clear();
+    for (uint32_t i = 0; i < header->levelCount; i++)
+        image.levelOffsets.push_back((size_t)levels[i].offset);
+    return true;
+}
+
+bool loadPackedMaterial(const char* diffusePath, const char* specularPath, PackedMaterialImage& image)
+{
+    string cooked = cookedTexturePath(diffusePath);
+    if (access(cooked.c_str(), R_OK) == 0 && loadCookedMaterial(cooked.c_str(), image))
+        return true;
+
+    int width, height, nrComponents;
+    int specularWidth, specularHeight;
+    shared_ptr<MappedFile> diffuseFile = mapImageFile(diffusePath);
+    shared_ptr<MappedFile> specularFile = mapImageFile(specularPath);
+    unsigned char* diffuse = diffuseFile->isOpen() ? stbi_load_from_memory(diffuseFile->data(), (int)diffuseFile->size(), &width, &height, &nrComponents, 4) : NULL;
+    unsigned char* specular = specularFile->isOpen() ? stbi_load_from_memory(specularFile->data(), (int)specularFile->size(), &specularWidth, &specularHeight, &nrComponents, 1) : NULL;
+    if (!diffuse || !specular)
+    {
+        cout << "Texture failed to load at path: " << (diffuse ? specularPath : diffusePath) << endl;
+        stbi_image_free(diffuse);
+        stbi_image_free(specular);
+        resetImageArena();
+        return false;
+    }
+
+    //漫反射直接解码成 RGBA，镜面反射强度原地写进 alpha 通道，不再经过 RGB -> RGBA 的重新打包
+    //镜面反射贴图尺寸不同时，按最近点采样缩放到漫反射贴图的尺寸
+    for (int y = 0; y < height; y++)
+    {
+        int sy = (int)(((long long)y * specularHeight) / height);
+        unsigned char* row = diffuse + (size_t)y * width * 4;
+        for (int x = 0; x < width; x++)
+        {
+            int sx = (int)(((long long)x * specularWidth) / width);
+            row[x * 4 + 3] = specular[(size_t)sy * specularWidth + sx];
+        }
+    }
+
+    image.width = width;
+    image.height = height;
+    image.format = CTEX_FORMAT_RGBA8;
+    image.file.reset();
+    image.pixels.assign(diffuse, diffuse + (size_t)width * height * 4);
+    image.levelOffsets.assign(1, 0);
+    stbi_image_free(diffuse);
+    stbi_image_free(specular);
+    resetImageArena();
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef Material_hpp
+#define Material_hpp
+
+#include <memory>
+#include <vector>
+#include "MappedFile.h"
+#include "CookedTexture.h"
+
+using namespace std;
+
+//材质：漫反射 + 镜面反射贴图合并成的一张 RGBA 图(rgb 漫反射, a 镜面反射强度)
+//这样每个片段只需要一次采样，每个材质只占纹理数组中的一层
+//离线烘焙的材质保留文件映射，上传时直接从映射里取各级数据，不拷贝；从原图解码的材质只有第 0 级，放在 pixels 里
+//烘焙时用了 --compress 的材质是 BC3，上传时交给驱动按压缩格式存储
+struct PackedMaterialImage {
+    int width;
+    int height;
+    uint32_t format;                    // CTEX_FORMAT_RGBA8 or CTEX_FORMAT_BC3
+    shared_ptr<MappedFile> file;        //离线烘焙的 .ctex，带有完整的 mipmap 链
+    vector<unsigned char> pixels;       //没有 .ctex 时解码合并出的 RGBA8 原图
+    vector<size_t> levelOffsets;        //每一级在 file 或 pixels 里的起始字节
+
+    int levelCount() const { return (int)levelOffsets.size(); }
+    int levelWidth(int i) const { return width >> i > 0 ? width >> i : 1; }
+    int levelHeight(int i) const { return height >> i > 0 ? height >> i : 1; }
+    size_t levelSize(int i) const { return (size_t)cookedTextureLevelSize(format, levelWidth(i), levelHeight(i)); }
+    // texels of mip level i in format: RGBA8 rows packed tightly, or BC3 blocks
+    const unsigned char* level(int i) const { return (file ? file->data() : pixels.data()) + levelOffsets[i]; }
+};
+
+// picks the packed layout automatically: a packed .ctex if one was cooked, otherwise decodes both images and packs them,
+// resampling the specular map when its size differs from the diffuse map
+bool loadPackedMaterial(const char* diffusePath, const char* specularPath, PackedMaterialImage& image);
+
+#endif /* Material_hpp */
@@ -0,0 +1,199 @@
+#include "MaterialRegistry.hpp"
+#include "TextureLoader.hpp"
+#include "ImageIO.hpp"
+#include "ContentHash.h"
+#include <unistd.h>
+#include <atomic>
+#include <iostream>
+
+using namespace std;
+
+static atomic<uint64_t> nextRegistryId(1);
+
+MaterialRegistry::MaterialRegistry(TextureCache* cache)
+: cache(cache), registryId(nextRegistryId.fetch_add(1))
+{
+}
+
+MaterialRegistry::~MaterialRegistry()
+{
+    clear();
+}
+
+void MaterialRegistry::clear()
+{
+    for (size_t i = 0; i < buckets.size(); i++)
+    {
+        if (!buckets[i].cacheKey.empty())
+            cache->release(buckets[i].cacheKey);
+        else if (buckets[i].textureID)
+            glDeleteTextures(1, &buckets[i].textureID);
+    }
+    buckets.clear();
+    contentHandles.clear();
+}
+
+//对材质实际会读取的文件做内容哈希；打开失败时返回 false，不参与去重
+//paths/files 返回哈希的两个文件和它们的映射，用来和哈希相同的材质逐字节比较
+static bool hashMaterialFiles(const char* diffusePath, const char* specularPath, uint64_t* hash, string* paths, shared_ptr<MappedFile>* files)
+{
+    string cooked = cookedTexturePath(diffusePath);
+    paths[0] = access(cooked.c_str(), R_OK) == 0 ? cooked : string(diffusePath);
+    paths[1] = specularPath;
+    files[0] = mapImageFile(paths[0]);
+    files[1] = mapImageFile(paths[1]);
+    if (!files[0]->isOpen() || !files[1]->isOpen())
+        return false;
+    *hash = hashBytes(files[1]->data(), files[1]->size(), hashBytes(files[0]->data(), files[0]->size()));
+    return true;
+}
+
+MaterialHandle MaterialRegistry::addMaterial(const char* diffusePath, const char* specularPath)
+{
+    MaterialHandle handle = { -1, -1 };
+    uint64_t hash = 0;
+    string paths[2];
+    shared_ptr<MappedFile> files[2];
+    bool hashed = hashMaterialFiles(diffusePath, specularPath, &hash, paths, files);
+    //哈希碰撞的材质照常解码，只是不登记，之后的重复仍然共享先登记的那个
+    bool shareable = hashed;
+    if (hashed)
+    {
+        unordered_map<uint64_t, ContentEntry>::iterator it = contentHandles.find(hash);
+        if (it != contentHandles.end())
+        {
+            if (sameImageFileContents(*files[0], it->second.diffuseFile) && sameImageFileContents(*files[1], it->second.specularFile))
+                return it->second.handle;
+            shareable = false;
+        }
+    }
+
+    PackedMaterialImage image;
+    if (!loadPackedMaterial(diffusePath, specularPath, image))
+        return handle;
+
+    size_t b = 0;
+    while (b < buckets.size() && (buckets[b].width != image.width || buckets[b].height != image.height || buckets[b].format != image.format))
+        b++;
+    if (b == buckets.size())
+    {
+        Bucket bucket = { image.width, image.height, image.format, 0, string(), vector<PackedMaterialImage>() };
+        buckets.push_back(bucket);
+    }
+    handle.array = (int)b;
+    handle.layer = (int)buckets[b].layers.size();
+    buckets[b].layers.push_back(image);
+    if (shareable)
+    {
+        ContentEntry entry = { handle, paths[0], paths[1] };
+        contentHandles[hash] = entry;
+    }
+    return handle;
+}
+
+bool MaterialRegistry::upload()
+{
+    //先清掉之前留下的错误，下面只看上传本身有没有出错
+    while (glGetError() != GL_NO_ERROR)
+        ;
+    for (size_t b = 0; b < buckets.size(); b++)
+    {
+        Bucket& bucket = buckets[b];
+        GLsizei layerCount = (GLsizei)bucket.layers.size();
+        int levelCount = fullMipLevelCount(bucket.width, bucket.height);
+
+        //所有层都带有完整的离线 mipmap 时逐级上传，否则只传第 0 级再由驱动生成（BC3 在加载时已保证完整）
+        bool cookedMips = true;
+        for (size_t i = 0; i < bucket.layers.size(); i++)
+            cookedMips = cookedMips && bucket.layers[i].levelCount() == levelCount;
+
+        //BC3 材质按 DXT5 直接上传；驱动没有 s3tc 时在 CPU 上逐级解压，按 SRGB8_ALPHA8 上传
+        GLenum compressedFormat = bucket.format == CTEX_FORMAT_BC3 ? cookedCompressedInternalFormat(CTEX_FORMAT_BC3, true) : 0;
+        vector<unsigned char> decoded;
+
+        if (!bucket.textureID)
+            glGenTextures(1, &bucket.textureID);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, bucket.textureID);
+        //rgb 是 sRGB 编码的漫反射颜色，采样时只把 rgb 转到线性空间，alpha 里的镜面反射强度原样返回
+        int width = bucket.width, height = bucket.height;
+        for (int level = 0; level < levelCount; level++)
+        {
+            if (compressedFormat)
+            {
+                GLsizei levelSize = (GLsizei)bucket.layers[0].levelSize(level);
+                glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, compressedFormat, width, height, layerCount, 0, levelSize * layerCount, NULL);
+                for (GLsizei layer = 0; layer < layerCount; layer++)
+                {
+                    glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1, compressedFormat, levelSize, bucket.layers[layer].level(level));
+                }
+            }
+            else
+            {
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_SRGB8_ALPHA8, width, height, layerCount, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+                if (level == 0 || cookedMips)
+                {
+                    for (GLsizei layer = 0; layer < layerCount; layer++)
+                    {
+                        const unsigned char* pixels = bucket.layers[layer].level(level);
+                        if (bucket.format == CTEX_FORMAT_BC3)
+                        {
+                            decoded.resize((size_t)width * height * 4);
+                            decompressBC3(pixels, width, height, decoded.data());
+                            pixels = decoded.data();
+                        }
+                        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+                    }
+                }
+            }
+            width = max(1, width / 2);
+            height = max(1, height / 2);
+        }
+        if (!cookedMips)
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        //已经交给缓存的数组不再重复登记；缓存拒绝时由注册表自己在 clear() 里删除
+        if (cache && bucket.cacheKey.empty())
+        {
+            string key = "materials/" + to_string(registryId) + "/" + to_string(bucket.width) + "x" + to_string(bucket.height);
+            if (bucket.format == CTEX_FORMAT_BC3)
+                key += "/bc3";
+            GLenum storedFormat = compressedFormat ? compressedFormat : GL_SRGB8_ALPHA8;
+            if (cache->adopt(key, bucket.textureID, estimateTextureBytes(storedFormat, bucket.width, bucket.height, levelCount) * layerCount))
+                bucket.cacheKey = key;
+        }
+
+        // pixels live on the GPU now; this also drops the mappings of cooked materials
+        bucket.layers.clear();
+        bucket.layers.shrink_to_fit();
+    }
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR)
+    {
+        cout << "ERROR::MATERIAL_REGISTRY::UPLOAD_FAILED: GL error 0x" << hex << error << dec << endl;
+        return false;
+    }
+    return true;
+}
+
+int MaterialRegistry::arrayCount() const
+{
+    return (int)buckets.size();
+}
+
+unsigned int MaterialRegistry::arrayTexture(int array) const
+{
+    return buckets[array].textureID;
+}
+
+void MaterialRegistry::bindArray(int array, unsigned int unit) const
+{
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, buckets[array].textureID);
+}
@@ -0,0 +1,64 @@
+#ifndef MaterialRegistry_hpp
+#define MaterialRegistry_hpp
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Material.hpp"
+#include "TextureCache.hpp"
+
+using namespace std;
+
+//材质在注册表中的位置：第 array 个纹理数组的第 layer 层
+struct MaterialHandle {
+    int array;
+    int layer;
+};
+
+//材质注册表：相同尺寸、相同存储格式的材质贴图放进同一个 GL_TEXTURE_2D_ARRAY 的不同层，
+//每个实例只需要带一个层号，使用不同材质的立方体也能在一次实例化绘制中画完
+//传入 TextureCache 时，纹理数组交给缓存管理并计入它的显存预算
+class MaterialRegistry {
+public:
+    MaterialRegistry(TextureCache* cache = nullptr);
+    ~MaterialRegistry();
+
+    // decodes the material into CPU memory; the texture arrays are created by upload()
+    // materials whose image files are byte-identical to an earlier one share its layer without being decoded
+    // (a hash match is confirmed byte by byte before sharing)
+    MaterialHandle addMaterial(const char* diffusePath, const char* specularPath);
+    // called once after every material has been added, frees the CPU copies; false when GL reported an error while creating the arrays
+    bool upload();
+
+    int arrayCount() const;
+    unsigned int arrayTexture(int array) const;
+    void bindArray(int array, unsigned int unit) const;
+    // releases the texture arrays; must run while the GL context is still alive
+    void clear();
+
+private:
+    struct Bucket {
+        int width;
+        int height;
+        uint32_t format;            // CTEX_FORMAT_RGBA8 or CTEX_FORMAT_BC3
+        unsigned int textureID;
+        string cacheKey;            //在 TextureCache 中的键，未使用缓存时为空
+        vector<PackedMaterialImage> layers;
+    };
+    TextureCache* cache;
+    uint64_t registryId;            //缓存键里区分不同的注册表，同尺寸的数组不会互相顶掉
+    vector<Bucket> buckets;
+    //已注册的材质和计算哈希时读取的两个文件，哈希相同时逐字节比较这两个文件
+    struct ContentEntry {
+        MaterialHandle handle;
+        string diffuseFile;
+        string specularFile;
+    };
+    unordered_map<uint64_t, ContentEntry> contentHandles;     //漫反射+镜面反射文件内容的哈希 -> 已注册的材质
+
+    MaterialRegistry(const MaterialRegistry&);
+    MaterialRegistry& operator=(const MaterialRegistry&);
+};
+
+#endif /* MaterialRegistry_hpp */
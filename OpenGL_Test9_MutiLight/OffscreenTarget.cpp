@@ -0,0 +1,81 @@
+#include "OffscreenTarget.hpp"
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+OffscreenTarget::OffscreenTarget()
+: framebuffer(0), colorBuffer(0), depthBuffer(0), targetWidth(0), targetHeight(0)
+{
+}
+
+OffscreenTarget::~OffscreenTarget()
+{
+    // GL objects are released by destroy() while the context is still current
+}
+
+bool OffscreenTarget::create(int width, int height)
+{
+    targetWidth = width;
+    targetHeight = height;
+
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_SRGB8_ALPHA8, width, height);
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        cout << "ERROR::OFFSCREEN_TARGET::FRAMEBUFFER_INCOMPLETE: 0x" << hex << status << dec << endl;
+        destroy();
+        return false;
+    }
+    return true;
+}
+
+void OffscreenTarget::bind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, targetWidth, targetHeight);
+}
+
+void OffscreenTarget::readPixels(vector<unsigned char>& rgba)
+{
+    size_t rowBytes = (size_t)targetWidth * 4;
+    rgba.resize(rowBytes * targetHeight);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, targetWidth, targetHeight, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+
+    //GL 的第一行在最下面，图片文件的第一行在最上面
+    vector<unsigned char> row(rowBytes);
+    for (int y = 0; y < targetHeight / 2; y++)
+    {
+        unsigned char* top = rgba.data() + y * rowBytes;
+        unsigned char* bottom = rgba.data() + (targetHeight - 1 - y) * rowBytes;
+        memcpy(row.data(), top, rowBytes);
+        memcpy(top, bottom, rowBytes);
+        memcpy(bottom, row.data(), rowBytes);
+    }
+}
+
+void OffscreenTarget::destroy()
+{
+    if (framebuffer)
+        glDeleteFramebuffers(1, &framebuffer);
+    if (colorBuffer)
+        glDeleteRenderbuffers(1, &colorBuffer);
+    if (depthBuffer)
+        glDeleteRenderbuffers(1, &depthBuffer);
+    framebuffer = colorBuffer = depthBuffer = 0;
+}
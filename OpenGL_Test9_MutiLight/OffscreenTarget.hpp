@@ -0,0 +1,38 @@
+#ifndef OffscreenTarget_hpp
+#define OffscreenTarget_hpp
+
+#include <glad/glad.h>
+#include <vector>
+
+using namespace std;
+
+//离屏渲染目标：一个 FBO，颜色是 SRGB8_ALPHA8 渲染缓冲，深度是 32 位浮点渲染缓冲(反向 Z 时远处也有足够的精度)
+//颜色格式和窗口的 sRGB 默认帧缓冲一致，开着 GL_FRAMEBUFFER_SRGB 渲染出的结果与窗口模式相同
+class OffscreenTarget {
+public:
+    OffscreenTarget();
+    ~OffscreenTarget();
+
+    // needs a current GL context; returns false if the framebuffer is incomplete
+    bool create(int width, int height);
+    // binds the framebuffer for drawing and sets the viewport to cover it
+    void bind();
+    // reads the color attachment back as RGBA8 rows ordered top to bottom (ready for writePNG)
+    void readPixels(vector<unsigned char>& rgba);
+    void destroy();
+
+    int width() const { return targetWidth; }
+    int height() const { return targetHeight; }
+
+private:
+    unsigned int framebuffer;
+    unsigned int colorBuffer;
+    unsigned int depthBuffer;
+    int targetWidth;
+    int targetHeight;
+
+    OffscreenTarget(const OffscreenTarget&);
+    OffscreenTarget& operator=(const OffscreenTarget&);
+};
+
+#endif /* OffscreenTarget_hpp */
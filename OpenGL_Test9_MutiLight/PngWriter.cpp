@@ -0,0 +1,130 @@
+#include "PngWriter.hpp"
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+//一个 stored block 最多 65535 字节
+const size_t PNG_STORED_BLOCK_SIZE = 65535;
+
+static uint32_t crc32Update(uint32_t crc, const unsigned char* data, size_t length)
+{
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady)
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        tableReady = true;
+    }
+    for (size_t i = 0; i < length; i++)
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return crc;
+}
+
+static void appendBigEndian(vector<unsigned char>& out, uint32_t value)
+{
+    out.push_back((unsigned char)(value >> 24));
+    out.push_back((unsigned char)(value >> 16));
+    out.push_back((unsigned char)(value >> 8));
+    out.push_back((unsigned char)value);
+}
+
+//chunk = 长度 + 类型 + 数据 + CRC(类型和数据)
+static void appendChunk(vector<unsigned char>& out, const char* type, const vector<unsigned char>& data)
+{
+    appendBigEndian(out, (uint32_t)data.size());
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    uint32_t crc = crc32Update(0xffffffffu, out.data() + start, out.size() - start) ^ 0xffffffffu;
+    appendBigEndian(out, crc);
+}
+
+bool writePNG(const string& path, int width, int height, int channels, const unsigned char* pixels)
+{
+    static const unsigned char colorTypes[5] = { 0, 0, 4, 2, 6 };
+    if (width <= 0 || height <= 0 || channels < 1 || channels > 4 || !pixels)
+    {
+        cout << "ERROR::PNG_WRITER::INVALID_IMAGE: " << path << endl;
+        return false;
+    }
+
+    //每一行前面加一个字节的滤波类型 0(None)
+    size_t rowBytes = (size_t)width * channels;
+    vector<unsigned char> raw;
+    raw.reserve((rowBytes + 1) * height);
+    for (int y = 0; y < height; y++)
+    {
+        raw.push_back(0);
+        raw.insert(raw.end(), pixels + y * rowBytes, pixels + (y + 1) * rowBytes);
+    }
+
+    //zlib 流：2 字节头 + 若干 stored block + Adler-32
+    vector<unsigned char> zlib;
+    zlib.reserve(raw.size() + raw.size() / PNG_STORED_BLOCK_SIZE * 5 + 16);
+    zlib.push_back(0x78);
+    zlib.push_back(0x01);
+    for (size_t offset = 0; offset < raw.size(); offset += PNG_STORED_BLOCK_SIZE)
+    {
+        size_t length = min(PNG_STORED_BLOCK_SIZE, raw.size() - offset);
+        zlib.push_back(offset + length == raw.size() ? 1 : 0);     // BFINAL, BTYPE = 00
+        zlib.push_back((unsigned char)length);
+        zlib.push_back((unsigned char)(length >> 8));
+        zlib.push_back((unsigned char)~length);
+        zlib.push_back((unsigned char)(~length >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+    }
+    // 5552 bytes is the longest run before b can overflow 32 bits, so the modulo is only taken once per run
+    uint32_t a = 1, b = 0;
+    for (size_t offset = 0; offset < raw.size(); offset += 5552)
+    {
+        size_t end = min(raw.size(), offset + 5552);
+        for (size_t i = offset; i < end; i++)
+        {
+            a += raw[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    appendBigEndian(zlib, (b << 16) | a);
+
+    vector<unsigned char> header;
+    appendBigEndian(header, (uint32_t)width);
+    appendBigEndian(header, (uint32_t)height);
+    header.push_back(8);                        // bit depth
+    header.push_back(colorTypes[channels]);
+    header.push_back(0);                        // compression
+    header.push_back(0);                        // filter
+    header.push_back(0);                        // interlace
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    vector<unsigned char> file(signature, signature + 8);
+    appendChunk(file, "IHDR", header);
+    appendChunk(file, "IDAT", zlib);
+    appendChunk(file, "IEND", vector<unsigned char>());
+
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out)
+    {
+        cout << "ERROR::PNG_WRITER::FILE_NOT_WRITTEN: " << path << endl;
+        return false;
+    }
+    size_t written = fwrite(file.data(), 1, file.size(), out);
+    fclose(out);
+    if (written != file.size())
+    {
+        cout << "ERROR::PNG_WRITER::FILE_NOT_WRITTEN: " << path << endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,13 @@
+#ifndef PngWriter_hpp
+#define PngWriter_hpp
+
+#include <string>
+
+using namespace std;
+
+//最小的 PNG 写出器，用于保存离屏渲染的帧
+//图像数据用 deflate 的不压缩块(stored block)写出，不依赖 zlib，文件大小约等于原始像素大小
+// writes 8-bit pixels with 1-4 channels (gray, gray+alpha, RGB, RGBA), rows ordered top to bottom; returns false on failure
+bool writePNG(const string& path, int width, int height, int channels, const unsigned char* pixels);
+
+#endif /* PngWriter_hpp */
@@ -0,0 +1,24 @@
+#ifndef RenderStats_h
+#define RenderStats_h
+
+//每帧的绘制和 uniform 调用计数，由 Shader 的 set* 函数和场景的绘制代码累加
+//基准测试模式在每帧开始时清零，帧结束后读出；平时只是几次整数加法
+struct RenderStats {
+    unsigned long drawCalls;        //glDrawArrays / glDrawArraysInstanced 次数
+    unsigned long instances;        //所有绘制调用画出的实例总数
+    unsigned long uniformCalls;     //glUniform* 次数
+    unsigned long culled;           //被视锥剔除、没有提交的实例数
+};
+
+inline RenderStats& renderStats()
+{
+    static RenderStats stats = { 0, 0, 0, 0 };
+    return stats;
+}
+
+inline void resetRenderStats()
+{
+    renderStats() = RenderStats();
+}
+
+#endif /* RenderStats_h */
@@ -0,0 +1,178 @@
+#include "SceneData.hpp"
+#include "SceneStore.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace std;
+using namespace glm;
+
+const float cubeVertices[CUBE_VERTEX_COUNT * CUBE_VERTEX_STRIDE] = {
+    // positions          // normals           // texture coords
+    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
+     0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
+
+    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
+
+    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+
+     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+
+    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 0.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
+
+    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f
+};
+
+void populateDefaultScene(SceneStore& scene)
+{
+    //方块们的各个世界位置
+    static const vec3 cubePositions[] = {
+      vec3( 0.0f,  0.0f,  0.0f),
+      vec3( 2.0f,  5.0f, -15.0f),
+      vec3(-1.5f, -2.2f, -2.5f),
+      vec3(-3.8f, -2.0f, -12.3f),
+      vec3( 2.4f, -0.4f, -3.5f),
+      vec3(-1.7f,  3.0f, -7.5f),
+      vec3( 1.3f, -2.0f, -2.5f),
+      vec3( 1.5f,  2.0f, -2.5f),
+      vec3( 1.5f,  0.2f, -1.5f),
+      vec3(-1.3f,  1.0f, -1.5f)
+    };
+    static const vec3 pointLightPositions[] = {
+        vec3( 0.7f,  0.2f,  2.0f),
+        vec3( 2.3f, -3.3f, -4.0f),
+        vec3(-4.0f,  2.0f, -12.0f),
+        vec3( 0.0f,  0.0f, -3.0f)
+    };
+
+    for (int i = 0; i < (int)(sizeof(cubePositions) / sizeof(cubePositions[0])); i++)
+    {
+        float angle = 20.0f * i;
+        EntityHandle container = scene.createEntity();
+        scene.setRenderable(container, MESH_CONTAINER, CONTAINER_MATERIAL, cubePositions[i], vec3(1.0f, 0.3f, 0.5f), radians(angle), vec3(1.0f));
+    }
+    for (int i = 0; i < (int)(sizeof(pointLightPositions) / sizeof(pointLightPositions[0])); i++)
+    {
+        EntityHandle lamp = scene.createEntity();
+        scene.setPointLight(lamp, defaultPointLight(pointLightPositions[i]));
+        // Make it a smaller cube
+        scene.setRenderable(lamp, MESH_LAMP, 0, pointLightPositions[i], vec3(0.0f, 1.0f, 0.0f), 0.0f, vec3(0.2f));
+    }
+}
+
+void scatterContainers(SceneStore& scene, int count, unsigned int seed)
+{
+    //箱子散布在默认场景后方的一大片空间里，数量越多范围越大，密度大致不变
+    mt19937 random(seed);
+    float extent = 10.0f + 2.0f * cbrtf((float)count);
+    uniform_real_distribution<float> side(-extent, extent);
+    uniform_real_distribution<float> depth(-3.0f - 2.0f * extent, -3.0f);
+    uniform_real_distribution<float> axis(-1.0f, 1.0f);
+    uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    for (int i = 0; i < count; i++)
+    {
+        vec3 position(side(random), side(random), depth(random));
+        vec3 rotationAxis(axis(random), axis(random), axis(random));
+        EntityHandle container = scene.createEntity();
+        scene.setRenderable(container, MESH_CONTAINER, CONTAINER_MATERIAL, position, rotationAxis, angle(random), vec3(1.0f));
+    }
+}
+
+PointLight defaultPointLight(const vec3& position)
+{
+    PointLight light;
+    light.position = position;
+    light.ambient = vec3(0.05f, 0.05f, 0.05f);
+    light.diffuse = vec3(0.8f, 0.8f, 0.8f);
+    light.specular = vec3(1.0f, 1.0f, 1.0f);
+    light.constant = 1.0f;
+    light.linear = 0.09f;
+    light.quadratic = 0.032f;
+    return light;
+}
+
+SceneLighting sceneLighting(const SceneStore& scene, const Camera& camera)
+{
+    SceneLighting lighting;
+    lighting.shininess = 32.0f;
+    // directional light
+    lighting.dirLight.direction = vec3(-0.2f, -1.0f, -0.3f);
+    lighting.dirLight.ambient = vec3(0.05f, 0.05f, 0.05f);
+    lighting.dirLight.diffuse = vec3(0.4f, 0.4f, 0.4f);
+    lighting.dirLight.specular = vec3(0.5f, 0.5f, 0.5f);
+    // point lights
+    size_t lightCount = scene.pointLightCount();
+    vector<size_t> order(lightCount);
+    for (size_t i = 0; i < lightCount; i++)
+        order[i] = i;
+    if (lightCount > (size_t)MAX_POINT_LIGHTS)
+    {
+        //着色器里的数组装不下，只保留离摄像机最近的，保留下来的仍按存储顺序排列
+        const vector<vec3>& positions = scene.pointLightPositions();
+        vec3 eye = camera.Position;
+        nth_element(order.begin(), order.begin() + MAX_POINT_LIGHTS, order.end(), [&](size_t a, size_t b) {
+            vec3 da = positions[a] - eye, db = positions[b] - eye;
+            return dot(da, da) < dot(db, db);
+        });
+        order.resize(MAX_POINT_LIGHTS);
+        sort(order.begin(), order.end());
+    }
+    lighting.pointLights.reserve(order.size());
+    for (size_t i = 0; i < order.size(); i++)
+        lighting.pointLights.push_back(scene.pointLight(order[i]));
+    // spotLight
+    lighting.spotLight.position = camera.Position;
+    lighting.spotLight.direction = camera.Front;
+    lighting.spotLight.ambient = vec3(0.0f, 0.0f, 0.0f);
+    lighting.spotLight.diffuse = vec3(1.0f, 1.0f, 1.0f);
+    lighting.spotLight.specular = vec3(1.0f, 1.0f, 1.0f);
+    lighting.spotLight.constant = 1.0f;
+    lighting.spotLight.linear = 0.09f;
+    lighting.spotLight.quadratic = 0.032f;
+    lighting.spotLight.cutOff = cos(radians(12.5f));
+    lighting.spotLight.outerCutOff = cos(radians(15.0f));
+    return lighting;
+}
+
+vec3 sceneClearColor()
+{
+    //原来的 sRGB 清屏颜色转到线性空间，经过帧缓冲的 sRGB 编码后屏幕上看起来不变
+    return vec3(srgbToLinear(182.0f / 255.0f), srgbToLinear(135.0f / 255.0f), srgbToLinear(86.0f / 255.0f));
+}
+
+// sRGB transfer function, decoding one 0-1 channel to linear
+float srgbToLinear(float c)
+{
+    if (c <= 0.04045f)
+        return c / 12.92f;
+    return powf((c + 0.055f) / 1.055f, 2.4f);
+}
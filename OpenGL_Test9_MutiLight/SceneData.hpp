@@ -0,0 +1,78 @@
+#ifndef SceneData_hpp
+#define SceneData_hpp
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "Camera.hpp"
+
+using namespace std;
+using namespace glm;
+
+//多光源场景的数据：立方体网格、默认场景的箱子和灯泡、各个光源的参数
+//箱子和灯泡的摆放不再是全局数组，populateDefaultScene 把它们加进 SceneStore，渲染器从 SceneStore 里取
+//不依赖 GL，GL 渲染(LightingScene)和 CPU 软件光栅化(SoftwareRasterizer)用的是同一份数据
+
+class SceneStore;
+
+const int CUBE_VERTEX_COUNT = 36;
+const int CUBE_VERTEX_STRIDE = 8;       //位置 3 + 法向量 3 + 纹理坐标 2
+const int MAX_POINT_LIGHTS = 32;        //与光照片段着色器的 MAX_POINT_LIGHTS 一致
+const int CONTAINER_MATERIAL = 0;       //默认场景里箱子的材质编号
+
+//手工添加顶点法向量数据
+extern const float cubeVertices[CUBE_VERTEX_COUNT * CUBE_VERTEX_STRIDE];
+
+//以下结构与光照片段着色器里的同名结构一一对应
+struct DirLight {
+    vec3 direction;     //光照射方向
+    vec3 ambient;       //环境光
+    vec3 diffuse;       //漫反射
+    vec3 specular;      //镜面反射
+};
+
+struct PointLight {
+    vec3 position;
+    float constant;
+    float linear;
+    float quadratic;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    float cutOff;       //内圆锥切光角的余弦值
+    float outerCutOff;  //外圆锥切光角的余弦值
+    float constant;
+    float linear;
+    float quadratic;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct SceneLighting {
+    DirLight dirLight;
+    vector<PointLight> pointLights;     //最多 MAX_POINT_LIGHTS 个
+    SpotLight spotLight;        //跟随摄像机的手电筒
+    float shininess;            //材质反光度
+};
+
+// adds the 10 containers and the 4 lamps (a point light plus a lamp cube each) of the original scene
+void populateDefaultScene(SceneStore& scene);
+// adds count containers at random positions and rotations around the default scene, for testing large scenes
+void scatterContainers(SceneStore& scene, int count, unsigned int seed);
+// the point light every lamp of the default scene uses
+PointLight defaultPointLight(const vec3& position);
+// light parameters for one frame; the spot light follows the camera
+// with more than MAX_POINT_LIGHTS point lights in the scene only the ones closest to the camera are kept
+SceneLighting sceneLighting(const SceneStore& scene, const Camera& camera);
+// clear color in linear space (the framebuffer encodes to sRGB on write)
+vec3 sceneClearColor();
+
+// sRGB transfer function, decoding one 0-1 channel to linear
+float srgbToLinear(float c);
+
+#endif /* SceneData_hpp */
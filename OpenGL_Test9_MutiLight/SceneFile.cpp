@@ -0,0 +1,89 @@
+#include "SceneFile.hpp"
+#include "SceneStore.hpp"
+#include <chrono>
+#include <glm/gtc/type_ptr.hpp>
+#include <iostream>
+
+using namespace std;
+using namespace glm;
+
+SceneFile::SceneFile()
+: header(nullptr), milliseconds(0.0)
+{
+}
+
+//偏移 -> 指针，validateSceneFile 已经确认过每个偏移都落在文件里
+template <typename T>
+static void fixup(SceneFileRef<T>& ref, unsigned char* base)
+{
+    ref.pointer = (T*)(base + ref.offset);
+}
+
+bool SceneFile::load(const string& path)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    header = nullptr;
+    file = make_shared<MappedFile>(path.c_str(), true);
+    if (!file->isOpen())
+    {
+        cout << "ERROR::SCENE_FILE::FILE_NOT_READ: " << path << endl;
+        file.reset();
+        return false;
+    }
+    unsigned char* bytes = file->mutableData();
+    if (!validateSceneFile(bytes, file->size()))
+    {
+        cout << "ERROR::SCENE_FILE::INVALID_FILE: " << path << " (expected a version " << SCENE_FILE_VERSION << " .scnb file)" << endl;
+        file.reset();
+        return false;
+    }
+
+    SceneFileHeader* mutableHeader = (SceneFileHeader*)bytes;
+    fixup(mutableHeader->meshes, bytes);
+    fixup(mutableHeader->materials, bytes);
+    fixup(mutableHeader->instances, bytes);
+    fixup(mutableHeader->lights, bytes);
+    SceneFileMesh* meshes = (SceneFileMesh*)mutableHeader->meshes.pointer;
+    for (uint32_t i = 0; i < mutableHeader->meshCount; i++)
+    {
+        fixup(meshes[i].name, bytes);
+        fixup(meshes[i].vertices, bytes);
+    }
+    SceneFileMaterial* materials = (SceneFileMaterial*)mutableHeader->materials.pointer;
+    for (uint32_t i = 0; i < mutableHeader->materialCount; i++)
+    {
+        fixup(materials[i].name, bytes);
+        fixup(materials[i].diffusePath, bytes);
+        fixup(materials[i].specularPath, bytes);
+    }
+    header = mutableHeader;
+    milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+void SceneFile::populate(SceneStore& scene) const
+{
+    const SceneFileInstance* instance = instances();
+    for (uint32_t i = 0; i < instanceCount(); i++, instance++)
+    {
+        EntityHandle entity = scene.createEntity();
+        scene.setRenderable(entity, MESH_CONTAINER, (int)instance->material, make_vec3(instance->position), make_vec3(instance->axis),
+                            instance->angle, make_vec3(instance->scale));
+    }
+    const SceneFileLight* light = lights();
+    for (uint32_t i = 0; i < lightCount(); i++, light++)
+    {
+        PointLight pointLight;
+        pointLight.position = make_vec3(light->position);
+        pointLight.ambient = make_vec3(light->ambient);
+        pointLight.diffuse = make_vec3(light->diffuse);
+        pointLight.specular = make_vec3(light->specular);
+        pointLight.constant = light->constant;
+        pointLight.linear = light->linear;
+        pointLight.quadratic = light->quadratic;
+        EntityHandle entity = scene.createEntity();
+        scene.setPointLight(entity, pointLight);
+        if (light->lampMesh != SCENE_NO_LAMP)
+            scene.setRenderable(entity, MESH_LAMP, 0, pointLight.position, vec3(0.0f, 1.0f, 0.0f), 0.0f, vec3(light->lampScale));
+    }
+}
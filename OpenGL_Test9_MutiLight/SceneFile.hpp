@@ -0,0 +1,50 @@
+#ifndef SceneFile_hpp
+#define SceneFile_hpp
+
+#include <memory>
+#include <string>
+#include "SceneFormat.h"
+#include "MappedFile.h"
+
+using namespace std;
+
+class SceneStore;
+
+//加载好的二进制场景(.scnb，格式见 SceneFormat.h)
+//文件整个映射进来，检查之后把偏移原地改写成指针，不做任何解析和拷贝；网格顶点、实例和光源表直接指向映射内存
+//对象存活期间映射一直有效
+class SceneFile {
+public:
+    SceneFile();
+
+    // maps and validates the file and fixes its offsets up into pointers; prints an error and returns false on failure
+    bool load(const string& path);
+    bool isLoaded() const { return header != nullptr; }
+
+    uint32_t meshCount() const { return header->meshCount; }
+    uint32_t materialCount() const { return header->materialCount; }
+    uint32_t instanceCount() const { return header->instanceCount; }
+    uint32_t lightCount() const { return header->lightCount; }
+    const SceneFileMesh* meshes() const { return header->meshes.pointer; }
+    const SceneFileMaterial* materials() const { return header->materials.pointer; }
+    const SceneFileInstance* instances() const { return header->instances.pointer; }
+    const SceneFileLight* lights() const { return header->lights.pointer; }
+
+    // adds one container entity per instance and one point light (with its lamp cube, if any) per light;
+    // the material ids given to the store are indices into materials()
+    void populate(SceneStore& scene) const;
+
+    size_t fileSize() const { return file ? file->size() : 0; }
+    //映射、检查和改写指针花的时间
+    double loadMilliseconds() const { return milliseconds; }
+
+private:
+    shared_ptr<MappedFile> file;
+    const SceneFileHeader* header;
+    double milliseconds;
+
+    SceneFile(const SceneFile&);
+    SceneFile& operator=(const SceneFile&);
+};
+
+#endif /* SceneFile_hpp */
@@ -0,0 +1,160 @@
+#ifndef SceneFormat_h
+#define SceneFormat_h
+
+#include <cstdint>
+#include <cstring>
+
+//二进制场景(.scnb)文件格式，SceneConverter 从文本场景写出，SceneFile 在运行时 mmap 后原地使用
+//
+//  SceneFileHeader
+//  SceneFileMesh[meshCount]
+//  SceneFileMaterial[materialCount]
+//  SceneFileInstance[instanceCount]
+//  SceneFileLight[lightCount]
+//  顶点数据                          每个网格 vertexCount * SCENE_VERTEX_STRIDE 个 float，起始地址按 SCENE_DATA_ALIGNMENT 对齐
+//  字符串表                          以 0 结尾的 UTF-8 字符串(网格名、材质名、贴图路径)
+//
+//文件里的引用(SceneFileRef)存的是相对文件开头的字节偏移。加载时用写时复制的方式映射文件，
+//检查完所有偏移之后原地改写成指针，只有文件头、网格表和材质表所在的几页会被复制，实例和光源表不含引用，直接使用
+//所有字段都是小端序、指针是 64 位，与 macOS / Linux 上的 x86_64 和 arm64 一致，因此可以原地使用
+
+const uint32_t SCENE_FILE_VERSION = 1;
+const uint32_t SCENE_DATA_ALIGNMENT = 16;
+const uint32_t SCENE_VERTEX_STRIDE = 8;     //位置 3 + 法向量 3 + 纹理坐标 2，与 cubeVertices 相同
+
+static_assert(sizeof(void*) == sizeof(uint64_t), "scene files store pointers in 64-bit fields");
+
+template <typename T>
+union SceneFileRef {
+    uint64_t offset;        //文件中：相对文件开头的字节偏移
+    T* pointer;             //加载后：指向映射内存
+};
+
+struct SceneFileMesh {
+    SceneFileRef<const char> name;
+    SceneFileRef<const float> vertices;
+    uint32_t vertexCount;
+    uint32_t reserved;
+};
+
+struct SceneFileMaterial {
+    SceneFileRef<const char> name;
+    SceneFileRef<const char> diffusePath;       //相对贴图目录
+    SceneFileRef<const char> specularPath;
+};
+
+//一个被光照着色器照亮的物体：model = translate(position) * rotate(angle, axis) * scale(scale)
+struct SceneFileInstance {
+    uint32_t mesh;
+    uint32_t material;
+    float position[3];
+    float axis[3];
+    float angle;            //弧度
+    float scale[3];
+};
+
+//点光源；lampMesh 不是 SCENE_NO_LAMP 时在光源位置画一个缩放 lampScale 的纯白灯泡
+struct SceneFileLight {
+    float position[3];
+    float ambient[3];
+    float diffuse[3];
+    float specular[3];
+    float constant;
+    float linear;
+    float quadratic;
+    uint32_t lampMesh;
+    float lampScale;
+};
+
+const uint32_t SCENE_NO_LAMP = 0xffffffffu;
+
+struct SceneFileHeader {
+    char magic[4];          // "SCNB"
+    uint32_t version;
+    uint64_t fileSize;
+    uint32_t meshCount;
+    uint32_t materialCount;
+    uint32_t instanceCount;
+    uint32_t lightCount;
+    SceneFileRef<const SceneFileMesh> meshes;
+    SceneFileRef<const SceneFileMaterial> materials;
+    SceneFileRef<const SceneFileInstance> instances;
+    SceneFileRef<const SceneFileLight> lights;
+};
+
+//[offset, offset + count * elementSize) 是否整个落在文件里
+inline bool sceneRangeInFile(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t fileSize)
+{
+    if (offset > fileSize || (elementSize && count > (fileSize - offset) / elementSize))
+        return false;
+    return true;
+}
+
+//偏移处是否有一个在文件结束前以 0 结尾的字符串
+inline bool sceneStringInFile(uint64_t offset, const unsigned char* bytes, uint64_t fileSize)
+{
+    if (offset >= fileSize)
+        return false;
+    return memchr(bytes + offset, 0, (size_t)(fileSize - offset)) != nullptr;
+}
+
+// checks that a mapped .scnb file is well formed before any of its offsets are trusted
+inline bool validateSceneFile(const unsigned char* bytes, uint64_t size)
+{
+    if (size < sizeof(SceneFileHeader))
+        return false;
+    const SceneFileHeader* header = (const SceneFileHeader*)bytes;
+    if (memcmp(header->magic, "SCNB", 4) != 0 || header->version != SCENE_FILE_VERSION || header->fileSize != size)
+        return false;
+    if (!sceneRangeInFile(header->meshes.offset, header->meshCount, sizeof(SceneFileMesh), size)
+        || !sceneRangeInFile(header->materials.offset, header->materialCount, sizeof(SceneFileMaterial), size)
+        || !sceneRangeInFile(header->instances.offset, header->instanceCount, sizeof(SceneFileInstance), size)
+        || !sceneRangeInFile(header->lights.offset, header->lightCount, sizeof(SceneFileLight), size))
+        return false;
+    if ((header->meshes.offset | header->materials.offset | header->instances.offset | header->lights.offset) % 8 != 0)
+        return false;
+    //四张表必须按上面的顺序排在文件头之后、互不重叠：加载时会原地改写文件头、网格表和材质表里的引用，
+    //同一个位置被当成两个引用改写两次就会变成野指针
+    uint64_t meshesEnd = header->meshes.offset + (uint64_t)header->meshCount * sizeof(SceneFileMesh);
+    uint64_t materialsEnd = header->materials.offset + (uint64_t)header->materialCount * sizeof(SceneFileMaterial);
+    uint64_t instancesEnd = header->instances.offset + (uint64_t)header->instanceCount * sizeof(SceneFileInstance);
+    uint64_t tablesEnd = header->lights.offset + (uint64_t)header->lightCount * sizeof(SceneFileLight);
+    if (header->meshes.offset < sizeof(SceneFileHeader) || header->materials.offset < meshesEnd
+        || header->instances.offset < materialsEnd || header->lights.offset < instancesEnd)
+        return false;
+
+    const SceneFileMesh* meshes = (const SceneFileMesh*)(bytes + header->meshes.offset);
+    for (uint32_t i = 0; i < header->meshCount; i++)
+    {
+        //顶点数据和字符串都在表的后面，不会和要改写的引用重叠
+        if (meshes[i].name.offset < tablesEnd || meshes[i].vertices.offset < tablesEnd)
+            return false;
+        if (!sceneStringInFile(meshes[i].name.offset, bytes, size) || meshes[i].vertices.offset % SCENE_DATA_ALIGNMENT != 0
+            || !sceneRangeInFile(meshes[i].vertices.offset, meshes[i].vertexCount, SCENE_VERTEX_STRIDE * sizeof(float), size))
+            return false;
+    }
+    const SceneFileMaterial* materials = (const SceneFileMaterial*)(bytes + header->materials.offset);
+    for (uint32_t i = 0; i < header->materialCount; i++)
+    {
+        if (materials[i].name.offset < tablesEnd || materials[i].diffusePath.offset < tablesEnd || materials[i].specularPath.offset < tablesEnd)
+            return false;
+        if (!sceneStringInFile(materials[i].name.offset, bytes, size) || !sceneStringInFile(materials[i].diffusePath.offset, bytes, size)
+            || !sceneStringInFile(materials[i].specularPath.offset, bytes, size))
+            return false;
+    }
+    const SceneFileInstance* instances = (const SceneFileInstance*)(bytes + header->instances.offset);
+    for (uint32_t i = 0; i < header->instanceCount; i++)
+    {
+        if (instances[i].mesh >= header->meshCount || instances[i].material >= header->materialCount)
+            return false;
+    }
+    const SceneFileLight* lights = (const SceneFileLight*)(bytes + header->lights.offset);
+    for (uint32_t i = 0; i < header->lightCount; i++)
+    {
+        if (lights[i].lampMesh != SCENE_NO_LAMP && lights[i].lampMesh >= header->meshCount)
+            return false;
+    }
+    return true;
+}
+
+#endif /* SceneFormat_h */
@@ -0,0 +1,207 @@
+#include "SceneStore.hpp"
+
+using namespace std;
+using namespace glm;
+
+SceneStore::SceneStore()
+: changeCount(0)
+{
+}
+
+SceneStore::Slot* SceneStore::slot(EntityHandle entity)
+{
+    if (entity.index >= slots.size() || slots[entity.index].generation != entity.generation)
+        return nullptr;
+    return &slots[entity.index];
+}
+
+bool SceneStore::alive(EntityHandle entity) const
+{
+    return entity.index < slots.size() && slots[entity.index].generation == entity.generation;
+}
+
+EntityHandle SceneStore::createEntity()
+{
+    EntityHandle entity;
+    if (!freeSlots.empty())
+    {
+        entity.index = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        entity.index = (uint32_t)slots.size();
+        Slot empty = { 0, -1, -1 };
+        slots.push_back(empty);
+    }
+    entity.generation = slots[entity.index].generation;
+    return entity;
+}
+
+void SceneStore::destroyEntity(EntityHandle entity)
+{
+    Slot* s = slot(entity);
+    if (!s)
+        return;
+    removeRenderable(entity);
+    removePointLight(entity);
+    s->generation++;
+    freeSlots.push_back(entity.index);
+    changeCount++;
+}
+
+void SceneStore::clear()
+{
+    //槽位保留下来并让代数加一，之前发出去的句柄全部失效
+    freeSlots.clear();
+    for (uint32_t i = 0; i < (uint32_t)slots.size(); i++)
+    {
+        slots[i].generation++;
+        slots[i].renderable = -1;
+        slots[i].light = -1;
+        freeSlots.push_back(i);
+    }
+    renderTransforms.clear();
+    renderMeshes.clear();
+    renderMaterials.clear();
+    renderOwners.clear();
+    lightPositions.clear();
+    lightAmbient.clear();
+    lightDiffuse.clear();
+    lightSpecular.clear();
+    lightConstant.clear();
+    lightLinear.clear();
+    lightQuadratic.clear();
+    lightOwners.clear();
+    changeCount++;
+}
+
+void SceneStore::setRenderable(EntityHandle entity, SceneMesh mesh, int material, const vec3& position, const vec3& axis, float angle, const vec3& scale)
+{
+    Slot* s = slot(entity);
+    if (!s)
+        return;
+    if (s->renderable < 0)
+    {
+        s->renderable = (int)renderTransforms.add(position, axis, angle, scale);
+        renderMeshes.push_back(mesh);
+        renderMaterials.push_back(material);
+        renderOwners.push_back(entity.index);
+    }
+    else
+    {
+        renderTransforms.setPosition(s->renderable, position);
+        renderTransforms.setRotation(s->renderable, axis, angle);
+        renderTransforms.setScale(s->renderable, scale);
+        renderMeshes[s->renderable] = mesh;
+        renderMaterials[s->renderable] = material;
+    }
+    changeCount++;
+}
+
+void SceneStore::setRenderablePosition(EntityHandle entity, const vec3& position)
+{
+    Slot* s = slot(entity);
+    if (!s || s->renderable < 0)
+        return;
+    renderTransforms.setPosition(s->renderable, position);
+    changeCount++;
+}
+
+void SceneStore::removeRenderable(EntityHandle entity)
+{
+    Slot* s = slot(entity);
+    if (!s || s->renderable < 0)
+        return;
+    size_t index = s->renderable, last = renderMeshes.size() - 1;
+    renderTransforms.removeSwap(index);
+    renderMeshes[index] = renderMeshes[last];
+    renderMaterials[index] = renderMaterials[last];
+    renderOwners[index] = renderOwners[last];
+    slots[renderOwners[index]].renderable = (int)index;
+    renderMeshes.pop_back();
+    renderMaterials.pop_back();
+    renderOwners.pop_back();
+    s->renderable = -1;
+    changeCount++;
+}
+
+void SceneStore::setPointLight(EntityHandle entity, const PointLight& light)
+{
+    Slot* s = slot(entity);
+    if (!s)
+        return;
+    if (s->light < 0)
+    {
+        s->light = (int)lightPositions.size();
+        lightPositions.push_back(light.position);
+        lightAmbient.push_back(light.ambient);
+        lightDiffuse.push_back(light.diffuse);
+        lightSpecular.push_back(light.specular);
+        lightConstant.push_back(light.constant);
+        lightLinear.push_back(light.linear);
+        lightQuadratic.push_back(light.quadratic);
+        lightOwners.push_back(entity.index);
+    }
+    else
+    {
+        size_t index = s->light;
+        lightPositions[index] = light.position;
+        lightAmbient[index] = light.ambient;
+        lightDiffuse[index] = light.diffuse;
+        lightSpecular[index] = light.specular;
+        lightConstant[index] = light.constant;
+        lightLinear[index] = light.linear;
+        lightQuadratic[index] = light.quadratic;
+    }
+    changeCount++;
+}
+
+void SceneStore::setPointLightPosition(EntityHandle entity, const vec3& position)
+{
+    Slot* s = slot(entity);
+    if (!s || s->light < 0)
+        return;
+    lightPositions[s->light] = position;
+    changeCount++;
+}
+
+void SceneStore::removePointLight(EntityHandle entity)
+{
+    Slot* s = slot(entity);
+    if (!s || s->light < 0)
+        return;
+    size_t index = s->light, last = lightPositions.size() - 1;
+    lightPositions[index] = lightPositions[last];
+    lightAmbient[index] = lightAmbient[last];
+    lightDiffuse[index] = lightDiffuse[last];
+    lightSpecular[index] = lightSpecular[last];
+    lightConstant[index] = lightConstant[last];
+    lightLinear[index] = lightLinear[last];
+    lightQuadratic[index] = lightQuadratic[last];
+    lightOwners[index] = lightOwners[last];
+    slots[lightOwners[index]].light = (int)index;
+    lightPositions.pop_back();
+    lightAmbient.pop_back();
+    lightDiffuse.pop_back();
+    lightSpecular.pop_back();
+    lightConstant.pop_back();
+    lightLinear.pop_back();
+    lightQuadratic.pop_back();
+    lightOwners.pop_back();
+    s->light = -1;
+    changeCount++;
+}
+
+PointLight SceneStore::pointLight(size_t index) const
+{
+    PointLight light;
+    light.position = lightPositions[index];
+    light.ambient = lightAmbient[index];
+    light.diffuse = lightDiffuse[index];
+    light.specular = lightSpecular[index];
+    light.constant = lightConstant[index];
+    light.linear = lightLinear[index];
+    light.quadratic = lightQuadratic[index];
+    return light;
+}
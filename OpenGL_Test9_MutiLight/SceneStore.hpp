@@ -0,0 +1,99 @@
+#ifndef SceneStore_hpp
+#define SceneStore_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "SceneData.hpp"
+#include "TransformBatch.hpp"
+
+using namespace std;
+using namespace glm;
+
+//实体句柄：槽位下标 + 代数。实体删除后槽位会被复用，代数加一，旧句柄随之失效
+struct EntityHandle {
+    uint32_t index;
+    uint32_t generation;
+};
+
+//场景里用到的网格，目前都是 cubeVertices 这一个立方体，只是着色方式不同
+enum SceneMesh {
+    MESH_CONTAINER = 0,     //光照着色器 + 材质贴图
+    MESH_LAMP = 1           //灯的着色器，纯白
+};
+
+//面向数据的场景存储：实体只是一个槽位，组件分类存在各自连续的数组里(SoA)
+//  可渲染组件：变换(TransformBatch) + 网格 + 材质编号
+//  点光源组件：位置、颜色、衰减，各存一个数组
+//每类组件的数组始终是紧凑的：删除时把最后一个元素挪到空位上，系统直接顺序遍历 [0, count) 即可，
+//槽位里记着组件在数组中的位置，数组元素也记着所属的槽位，挪动后两边一起更新，句柄保持不变
+//材质编号由渲染器解释(LightingScene 把它映射到 MaterialHandle)，存储本身不依赖 GL
+class SceneStore {
+public:
+    SceneStore();
+
+    EntityHandle createEntity();
+    // removes the entity and all its components; stale handles are ignored
+    void destroyEntity(EntityHandle entity);
+    bool alive(EntityHandle entity) const;
+    size_t entityCount() const { return slots.size() - freeSlots.size(); }
+    // destroys every entity; handles created before are no longer alive
+    void clear();
+
+    // adds the renderable component, or replaces it if the entity already has one
+    void setRenderable(EntityHandle entity, SceneMesh mesh, int material, const vec3& position, const vec3& axis, float angle, const vec3& scale);
+    void setRenderablePosition(EntityHandle entity, const vec3& position);
+    void removeRenderable(EntityHandle entity);
+
+    // adds the point light component, or replaces it if the entity already has one
+    void setPointLight(EntityHandle entity, const PointLight& light);
+    void setPointLightPosition(EntityHandle entity, const vec3& position);
+    void removePointLight(EntityHandle entity);
+
+    //紧凑数组，下标范围 [0, renderableCount())，顺序在删除后会变
+    size_t renderableCount() const { return renderMeshes.size(); }
+    const TransformBatch& renderableTransforms() const { return renderTransforms; }
+    const vector<int>& renderableMeshes() const { return renderMeshes; }
+    const vector<int>& renderableMaterials() const { return renderMaterials; }
+
+    //紧凑数组，下标范围 [0, pointLightCount())
+    size_t pointLightCount() const { return lightPositions.size(); }
+    const vector<vec3>& pointLightPositions() const { return lightPositions; }
+    PointLight pointLight(size_t index) const;
+
+    // increases with every change; renderers keep the value they last uploaded and rebuild their buffers when it differs
+    uint64_t version() const { return changeCount; }
+
+private:
+    struct Slot {
+        uint32_t generation;
+        int renderable;         //在可渲染组件数组中的下标，-1 表示没有
+        int light;              //在点光源组件数组中的下标，-1 表示没有
+    };
+
+    Slot* slot(EntityHandle entity);
+
+    vector<Slot> slots;
+    vector<uint32_t> freeSlots;
+    uint64_t changeCount;
+
+    TransformBatch renderTransforms;
+    vector<int> renderMeshes;
+    vector<int> renderMaterials;
+    vector<uint32_t> renderOwners;      //每个可渲染组件所属的槽位
+
+    vector<vec3> lightPositions;
+    vector<vec3> lightAmbient;
+    vector<vec3> lightDiffuse;
+    vector<vec3> lightSpecular;
+    vector<float> lightConstant;
+    vector<float> lightLinear;
+    vector<float> lightQuadratic;
+    vector<uint32_t> lightOwners;       //每个点光源组件所属的槽位
+
+    SceneStore(const SceneStore&);
+    SceneStore& operator=(const SceneStore&);
+};
+
+#endif /* SceneStore_hpp */
@@ -10,6 +10,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "RenderStats.h"
 
 using namespace std;
 using namespace glm;
@@ -18,7 +19,7 @@ class Shader{
 public:
     unsigned int ID;
     
-    Shader(const char* vertexPath, const char* fragmentPath){
+    Shader(const char* vertexPath, const char* fragmentPath): valid(true) {
         string vertexCode;
         string fragmentCode;
         ifstream vShaderFile;
@@ -44,6 +45,7 @@ public:
         catch (ifstream::failure& e)
         {
             cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << endl;
+            valid = false;
         }
         const char* vShaderCode = vertexCode.c_str();
         const char * fShaderCode = fragmentCode.c_str();
@@ -53,22 +55,24 @@ public:
         vertex = glCreateShader(GL_VERTEX_SHADER);
         glShaderSource(vertex, 1, &vShaderCode, NULL);
         glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
+        valid = checkCompileErrors(vertex, "VERTEX") && valid;
         // fragment Shader
         fragment = glCreateShader(GL_FRAGMENT_SHADER);
         glShaderSource(fragment, 1, &fShaderCode, NULL);
         glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
+        valid = checkCompileErrors(fragment, "FRAGMENT") && valid;
         // shader Program
         ID = glCreateProgram();
         glAttachShader(ID, vertex);
         glAttachShader(ID, fragment);
         glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
+        valid = checkCompileErrors(ID, "PROGRAM") && valid;
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
     }
+    // false when a source file could not be read or the program failed to compile or link (the log is printed already)
+    bool isValid() const { return valid; }
     // activate the shader
     // ------------------------------------------------------------------------
     void use()
@@ -80,38 +84,54 @@ public:
     void setBool(const string &name, bool value) const
     {
         glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        renderStats().uniformCalls++;
     }
     // ------------------------------------------------------------------------
     void setInt(const string &name, int value) const
     {
         glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        renderStats().uniformCalls++;
     }
     // ------------------------------------------------------------------------
     void setFloat(const string &name, float value) const
     {
         glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        renderStats().uniformCalls++;
     }
     
     void setVec3(const string &name, float x, float y, float z) const
     {
         glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        renderStats().uniformCalls++;
     }
     
     void setVec3(const string &name, vec3 v3) const
     {
         glUniform3f(glGetUniformLocation(ID, name.c_str()), v3.x, v3.y, v3.z);
+        renderStats().uniformCalls++;
     }
     
     void setMat4(const string &name, mat4 m) const
     {
         GLfloat *value = value_ptr(m);
         glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, value);
+        renderStats().uniformCalls++;
+    }
+
+    // points the uniform block name at a buffer binding point; programs that do not use the block are left alone
+    void setUniformBlockBinding(const string &name, unsigned int binding) const
+    {
+        unsigned int index = glGetUniformBlockIndex(ID, name.c_str());
+        if (index != GL_INVALID_INDEX)
+            glUniformBlockBinding(ID, index, binding);
     }
 
 private:
+    bool valid;
+
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
-    void checkCompileErrors(unsigned int shader, string type)
+    bool checkCompileErrors(unsigned int shader, string type)
     {
         int success;
         char infoLog[1024];
@@ -133,6 +153,7 @@ private:
                 cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << endl;
             }
         }
+        return success != 0;
     }
 };
 
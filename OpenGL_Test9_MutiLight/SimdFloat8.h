@@ -0,0 +1,308 @@
+#ifndef SimdFloat8_h
+#define SimdFloat8_h
+
+#include <cmath>
+
+//8 路单精度浮点向量，CPU 上的着色和批量变换代码按 8 个一组写成和 GLSL 差不多的样子
+//编译时打开了 AVX2 + FMA(-mavx2 -mfma)就用 __m256，其余的 x86_64 用两个 SSE2 的 __m128 拼成 8 路，arm64 等退回到逐个分量的循环
+//软件光栅化的着色把 AVX2 的一份单独编译，运行时检测 CPU 后选择(见 SoftwareShading.hpp)
+//三种实现的 log2/exp2(pow) 用同一组多项式近似，差别只在 AVX2 的 fmadd 是融合乘加、少一次舍入，结果可能差最后一位
+//比较运算返回掩码，配合 select 使用；掩码的具体表示只在 select/any 内部用到
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define SIMD_FLOAT8_AVX2 1
+#define SIMD_FLOAT8_SSE2 0
+#define SIMD_FLOAT8_NAMESPACE simdFloat8AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SIMD_FLOAT8_AVX2 0
+#define SIMD_FLOAT8_SSE2 1
+#define SIMD_FLOAT8_NAMESPACE simdFloat8SSE2
+#else
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#define SIMD_FLOAT8_AVX2 0
+#define SIMD_FLOAT8_SSE2 0
+#define SIMD_FLOAT8_NAMESPACE simdFloat8Scalar
+#endif
+
+//每种实现放在自己的命名空间里：同一个程序里可以有按不同指令集编译的翻译单元(见 SoftwareShadingAVX2.cpp)，
+//同名的 inline 函数不区分开的话，链接器只会留下其中一份，没有 AVX2 的机器上也可能调用到 AVX2 的版本
+namespace SIMD_FLOAT8_NAMESPACE {
+
+// "AVX2", "SSE2" or "scalar", whichever implementation this translation unit was compiled with
+inline const char* simdFloat8Path()
+{
+    return SIMD_FLOAT8_AVX2 ? "AVX2" : SIMD_FLOAT8_SSE2 ? "SSE2" : "scalar";
+}
+
+#if SIMD_FLOAT8_AVX2
+
+struct Float8 {
+    __m256 v;
+
+    Float8() {}
+    Float8(float s) : v(_mm256_set1_ps(s)) {}
+    explicit Float8(__m256 x) : v(x) {}
+
+    // p needs no particular alignment
+    static Float8 load(const float* p) { return Float8(_mm256_loadu_ps(p)); }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+};
+
+inline Float8 operator+(Float8 a, Float8 b) { return Float8(_mm256_add_ps(a.v, b.v)); }
+inline Float8 operator-(Float8 a, Float8 b) { return Float8(_mm256_sub_ps(a.v, b.v)); }
+inline Float8 operator*(Float8 a, Float8 b) { return Float8(_mm256_mul_ps(a.v, b.v)); }
+inline Float8 operator/(Float8 a, Float8 b) { return Float8(_mm256_div_ps(a.v, b.v)); }
+inline Float8 operator-(Float8 a) { return Float8(_mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f))); }
+inline Float8 operator<(Float8 a, Float8 b) { return Float8(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)); }
+inline Float8 operator>(Float8 a, Float8 b) { return Float8(_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)); }
+inline Float8 operator<=(Float8 a, Float8 b) { return Float8(_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)); }
+inline Float8 operator>=(Float8 a, Float8 b) { return Float8(_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)); }
+inline Float8 operator&(Float8 a, Float8 b) { return Float8(_mm256_and_ps(a.v, b.v)); }
+inline Float8 operator|(Float8 a, Float8 b) { return Float8(_mm256_or_ps(a.v, b.v)); }
+
+inline Float8 min(Float8 a, Float8 b) { return Float8(_mm256_min_ps(a.v, b.v)); }
+inline Float8 max(Float8 a, Float8 b) { return Float8(_mm256_max_ps(a.v, b.v)); }
+inline Float8 sqrt(Float8 a) { return Float8(_mm256_sqrt_ps(a.v)); }
+inline Float8 floor(Float8 a) { return Float8(_mm256_floor_ps(a.v)); }
+// a * b + c
+inline Float8 fmadd(Float8 a, Float8 b, Float8 c) { return Float8(_mm256_fmadd_ps(a.v, b.v, c.v)); }
+// mask ? a : b per lane
+inline Float8 select(Float8 mask, Float8 a, Float8 b) { return Float8(_mm256_blendv_ps(b.v, a.v, mask.v)); }
+inline bool any(Float8 mask) { return _mm256_movemask_ps(mask.v) != 0; }
+
+// log2 for x > 0: exponent from the bits, mantissa folded into [sqrt(0.5), sqrt(2)) and expanded with the atanh series
+inline Float8 log2(Float8 x)
+{
+    __m256i bits = _mm256_castps_si256(x.v);
+    __m256i exponent = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127));
+    __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f800000)));
+    __m256 big = _mm256_cmp_ps(m, _mm256_set1_ps(1.41421356f), _CMP_GT_OQ);
+    m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), big);
+    exponent = _mm256_sub_epi32(exponent, _mm256_castps_si256(big));    // big lanes are all ones, i.e. -1
+    Float8 e(_mm256_cvtepi32_ps(exponent));
+    Float8 mantissa(m);
+    Float8 t = (mantissa - 1.0f) / (mantissa + 1.0f);
+    Float8 t2 = t * t;
+    Float8 p = fmadd(t2, 0.32059890f, 0.41219858f);     // 2/(k ln2) for k = 9, 7
+    p = fmadd(p, t2, 0.57707802f);                      // k = 5
+    p = fmadd(p, t2, 0.96179669f);                      // k = 3
+    p = fmadd(p, t2, 2.88539008f);                      // k = 1
+    return fmadd(p, t, e);
+}
+
+// 2^x: split into round(x) and a remainder in [-0.5, 0.5], Taylor series of e^(f ln2) on the remainder
+inline Float8 exp2(Float8 x)
+{
+    Float8 clamped = min(max(x, -126.0f), 127.0f);
+    __m256 rounded = _mm256_round_ps(clamped.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    Float8 f = (clamped - Float8(rounded)) * 0.69314718f;
+    Float8 p = fmadd(f, 1.0f / 720.0f, 1.0f / 120.0f);
+    p = fmadd(p, f, 1.0f / 24.0f);
+    p = fmadd(p, f, 1.0f / 6.0f);
+    p = fmadd(p, f, 0.5f);
+    p = fmadd(p, f, 1.0f);
+    p = fmadd(p, f, 1.0f);
+    __m256i scale = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(rounded), _mm256_set1_epi32(127)), 23);
+    Float8 result = p * Float8(_mm256_castsi256_ps(scale));
+    return select(x < -126.0f, 0.0f, result);
+}
+
+#elif SIMD_FLOAT8_SSE2
+
+struct Float8 {
+    __m128 lo, hi;
+
+    Float8() {}
+    Float8(float s) : lo(_mm_set1_ps(s)), hi(_mm_set1_ps(s)) {}
+    Float8(__m128 l, __m128 h) : lo(l), hi(h) {}
+
+    static Float8 load(const float* p) { return Float8(_mm_loadu_ps(p), _mm_loadu_ps(p + 4)); }
+    void store(float* p) const { _mm_storeu_ps(p, lo); _mm_storeu_ps(p + 4, hi); }
+};
+
+#define SIMD_FLOAT8_HALVES(op, a, b) Float8(op((a).lo, (b).lo), op((a).hi, (b).hi))
+
+inline Float8 operator+(Float8 a, Float8 b) { return SIMD_FLOAT8_HALVES(_mm_add_ps, a, b); }
+inline Float8 operator-(Float8 a, Float8 b) { return SIMD_FLOAT8_HALVES(_mm_sub_ps, a, b); }
+inline Float8 operator*(Float8 a, Float8 b) { return SIMD_FLOAT8_HALVES(_mm_mul_ps, a, b); }
+inline Float8 operator/(Float8 a, Float8 b) { return SIMD_FLOAT8_HALVES(_mm_div_ps, a, b); }
+inline Float8 operator-(Float8 a) { return SIMD_FLOAT8_HALVES(_mm_xor_ps, a, Float8(-0.0f)); }
+inline Float8 operator<(Float8 a, Float8 b) { return SIMD_FLOAT8_HALVES(_mm_cmplt_ps, a, b); }
+inline Float8 operator>(Float8 a, Float8 b) { return SIMD_FLOAT8_HALVES(_mm_cmpgt_ps, a, b); }
+inline Float8 operator<=(Float8 a, Float8 b) { return SIMD_FLOAT8_HALVES(_mm_cmple_ps, a, b); }
+inline Float8 operator>=(Float8 a, Float8 b) { return SIMD_FLOAT8_HALVES(_mm_cmpge_ps, a, b); }
+inline Float8 operator&(Float8 a, Float8 b) { return SIMD_FLOAT8_HALVES(_mm_and_ps, a, b); }
+inline Float8 operator|(Float8 a, Float8 b) { return SIMD_FLOAT8_HALVES(_mm_or_ps, a, b); }
+
+inline Float8 min(Float8 a, Float8 b) { return SIMD_FLOAT8_HALVES(_mm_min_ps, a, b); }
+inline Float8 max(Float8 a, Float8 b) { return SIMD_FLOAT8_HALVES(_mm_max_ps, a, b); }
+inline Float8 sqrt(Float8 a) { return Float8(_mm_sqrt_ps(a.lo), _mm_sqrt_ps(a.hi)); }
+inline Float8 fmadd(Float8 a, Float8 b, Float8 c) { return a * b + c; }
+// SSE2 has no blendv, so the mask selects with and/andnot
+inline Float8 select(Float8 mask, Float8 a, Float8 b)
+{
+    return Float8(_mm_or_ps(_mm_and_ps(mask.lo, a.lo), _mm_andnot_ps(mask.lo, b.lo)),
+                  _mm_or_ps(_mm_and_ps(mask.hi, a.hi), _mm_andnot_ps(mask.hi, b.hi)));
+}
+inline bool any(Float8 mask) { return (_mm_movemask_ps(mask.lo) | _mm_movemask_ps(mask.hi)) != 0; }
+// cvtps rounds to nearest, so round-trip and step back where that went up
+inline Float8 floor(Float8 a)
+{
+    Float8 rounded(_mm_cvtepi32_ps(_mm_cvtps_epi32(a.lo)), _mm_cvtepi32_ps(_mm_cvtps_epi32(a.hi)));
+    return rounded - (select(rounded > a, 1.0f, 0.0f));
+}
+
+//与 AVX2 版本相同的近似，只是每次处理半边
+inline __m128 simdFloat4Log2(__m128 x)
+{
+    __m128i bits = _mm_castps_si128(x);
+    __m128i exponent = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+    __m128 big = _mm_cmpgt_ps(m, _mm_set1_ps(1.41421356f));
+    m = _mm_or_ps(_mm_and_ps(big, _mm_mul_ps(m, _mm_set1_ps(0.5f))), _mm_andnot_ps(big, m));
+    exponent = _mm_sub_epi32(exponent, _mm_castps_si128(big));
+    __m128 t = _mm_div_ps(_mm_sub_ps(m, _mm_set1_ps(1.0f)), _mm_add_ps(m, _mm_set1_ps(1.0f)));
+    __m128 t2 = _mm_mul_ps(t, t);
+    __m128 p = _mm_add_ps(_mm_mul_ps(t2, _mm_set1_ps(0.32059890f)), _mm_set1_ps(0.41219858f));
+    p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(0.57707802f));
+    p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(0.96179669f));
+    p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(2.88539008f));
+    return _mm_add_ps(_mm_mul_ps(p, t), _mm_cvtepi32_ps(exponent));
+}
+
+inline __m128 simdFloat4Exp2(__m128 x)
+{
+    __m128 clamped = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-126.0f)), _mm_set1_ps(127.0f));
+    __m128i rounded = _mm_cvtps_epi32(clamped);
+    __m128 f = _mm_mul_ps(_mm_sub_ps(clamped, _mm_cvtepi32_ps(rounded)), _mm_set1_ps(0.69314718f));
+    __m128 p = _mm_add_ps(_mm_mul_ps(f, _mm_set1_ps(1.0f / 720.0f)), _mm_set1_ps(1.0f / 120.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f / 24.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f / 6.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(0.5f));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f));
+    __m128i scale = _mm_slli_epi32(_mm_add_epi32(rounded, _mm_set1_epi32(127)), 23);
+    __m128 result = _mm_mul_ps(p, _mm_castsi128_ps(scale));
+    return _mm_andnot_ps(_mm_cmplt_ps(x, _mm_set1_ps(-126.0f)), result);
+}
+
+inline Float8 log2(Float8 x) { return Float8(simdFloat4Log2(x.lo), simdFloat4Log2(x.hi)); }
+inline Float8 exp2(Float8 x) { return Float8(simdFloat4Exp2(x.lo), simdFloat4Exp2(x.hi)); }
+
+#undef SIMD_FLOAT8_HALVES
+
+#else
+
+//与 AVX2/SSE2 版本相同的近似，逐个分量计算
+inline float simdFloatLog2(float x)
+{
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    int exponent = (int)(bits >> 23) - 127;
+    bits = (bits & 0x007fffffu) | 0x3f800000u;
+    float m;
+    memcpy(&m, &bits, sizeof(m));
+    if (m > 1.41421356f)
+    {
+        m *= 0.5f;
+        exponent++;
+    }
+    float t = (m - 1.0f) / (m + 1.0f);
+    float t2 = t * t;
+    float p = t2 * 0.32059890f + 0.41219858f;
+    p = p * t2 + 0.57707802f;
+    p = p * t2 + 0.96179669f;
+    p = p * t2 + 2.88539008f;
+    return p * t + (float)exponent;
+}
+
+inline float simdFloatExp2(float x)
+{
+    float clamped = std::min(std::max(x, -126.0f), 127.0f);
+    float rounded = std::nearbyint(clamped);
+    float f = (clamped - rounded) * 0.69314718f;
+    float p = f * (1.0f / 720.0f) + 1.0f / 120.0f;
+    p = p * f + 1.0f / 24.0f;
+    p = p * f + 1.0f / 6.0f;
+    p = p * f + 0.5f;
+    p = p * f + 1.0f;
+    p = p * f + 1.0f;
+    uint32_t bits = (uint32_t)((int)rounded + 127) << 23;
+    float scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return x < -126.0f ? 0.0f : p * scale;
+}
+
+struct Float8 {
+    float v[8];
+
+    Float8() {}
+    Float8(float s) { for (int i = 0; i < 8; i++) v[i] = s; }
+
+    static Float8 load(const float* p) { Float8 r; for (int i = 0; i < 8; i++) r.v[i] = p[i]; return r; }
+    void store(float* p) const { for (int i = 0; i < 8; i++) p[i] = v[i]; }
+};
+
+#define SIMD_FLOAT8_LANEWISE(expression) Float8 r; for (int i = 0; i < 8; i++) r.v[i] = (expression); return r
+#define SIMD_FLOAT8_MASK(condition) ((condition) ? 1.0f : 0.0f)
+
+inline Float8 operator+(Float8 a, Float8 b) { SIMD_FLOAT8_LANEWISE(a.v[i] + b.v[i]); }
+inline Float8 operator-(Float8 a, Float8 b) { SIMD_FLOAT8_LANEWISE(a.v[i] - b.v[i]); }
+inline Float8 operator*(Float8 a, Float8 b) { SIMD_FLOAT8_LANEWISE(a.v[i] * b.v[i]); }
+inline Float8 operator/(Float8 a, Float8 b) { SIMD_FLOAT8_LANEWISE(a.v[i] / b.v[i]); }
+inline Float8 operator-(Float8 a) { SIMD_FLOAT8_LANEWISE(-a.v[i]); }
+inline Float8 operator<(Float8 a, Float8 b) { SIMD_FLOAT8_LANEWISE(SIMD_FLOAT8_MASK(a.v[i] < b.v[i])); }
+inline Float8 operator>(Float8 a, Float8 b) { SIMD_FLOAT8_LANEWISE(SIMD_FLOAT8_MASK(a.v[i] > b.v[i])); }
+inline Float8 operator<=(Float8 a, Float8 b) { SIMD_FLOAT8_LANEWISE(SIMD_FLOAT8_MASK(a.v[i] <= b.v[i])); }
+inline Float8 operator>=(Float8 a, Float8 b) { SIMD_FLOAT8_LANEWISE(SIMD_FLOAT8_MASK(a.v[i] >= b.v[i])); }
+inline Float8 operator&(Float8 a, Float8 b) { SIMD_FLOAT8_LANEWISE(SIMD_FLOAT8_MASK(a.v[i] != 0.0f && b.v[i] != 0.0f)); }
+inline Float8 operator|(Float8 a, Float8 b) { SIMD_FLOAT8_LANEWISE(SIMD_FLOAT8_MASK(a.v[i] != 0.0f || b.v[i] != 0.0f)); }
+
+inline Float8 min(Float8 a, Float8 b) { SIMD_FLOAT8_LANEWISE(a.v[i] < b.v[i] ? a.v[i] : b.v[i]); }
+inline Float8 max(Float8 a, Float8 b) { SIMD_FLOAT8_LANEWISE(a.v[i] > b.v[i] ? a.v[i] : b.v[i]); }
+inline Float8 sqrt(Float8 a) { SIMD_FLOAT8_LANEWISE(std::sqrt(a.v[i])); }
+inline Float8 floor(Float8 a) { SIMD_FLOAT8_LANEWISE(std::floor(a.v[i])); }
+inline Float8 fmadd(Float8 a, Float8 b, Float8 c) { SIMD_FLOAT8_LANEWISE(a.v[i] * b.v[i] + c.v[i]); }
+inline Float8 select(Float8 mask, Float8 a, Float8 b) { SIMD_FLOAT8_LANEWISE(mask.v[i] != 0.0f ? a.v[i] : b.v[i]); }
+inline bool any(Float8 mask) { for (int i = 0; i < 8; i++) if (mask.v[i] != 0.0f) return true; return false; }
+inline Float8 log2(Float8 x) { SIMD_FLOAT8_LANEWISE(simdFloatLog2(x.v[i])); }
+inline Float8 exp2(Float8 x) { SIMD_FLOAT8_LANEWISE(simdFloatExp2(x.v[i])); }
+
+#undef SIMD_FLOAT8_LANEWISE
+#undef SIMD_FLOAT8_MASK
+
+#endif
+
+inline Float8 clamp(Float8 x, Float8 lo, Float8 hi) { return min(max(x, lo), hi); }
+// pow for x >= 0 like GLSL, with pow(0, y) = 0 for y > 0
+inline Float8 pow(Float8 x, Float8 y) { return select(x > 0.0f, exp2(y * log2(max(x, 1e-30f))), 0.0f); }
+
+//3 分量向量，每个分量是 8 路，对应 GLSL 的 vec3
+struct Vec3x8 {
+    Float8 x, y, z;
+
+    Vec3x8() {}
+    Vec3x8(Float8 s) : x(s), y(s), z(s) {}
+    Vec3x8(Float8 x_, Float8 y_, Float8 z_) : x(x_), y(y_), z(z_) {}
+};
+
+inline Vec3x8 operator+(const Vec3x8& a, const Vec3x8& b) { return Vec3x8(a.x + b.x, a.y + b.y, a.z + b.z); }
+inline Vec3x8 operator-(const Vec3x8& a, const Vec3x8& b) { return Vec3x8(a.x - b.x, a.y - b.y, a.z - b.z); }
+inline Vec3x8 operator*(const Vec3x8& a, const Vec3x8& b) { return Vec3x8(a.x * b.x, a.y * b.y, a.z * b.z); }
+inline Vec3x8 operator*(const Vec3x8& a, Float8 s) { return Vec3x8(a.x * s, a.y * s, a.z * s); }
+inline Vec3x8 operator-(const Vec3x8& a) { return Vec3x8(-a.x, -a.y, -a.z); }
+inline Float8 dot(const Vec3x8& a, const Vec3x8& b) { return fmadd(a.x, b.x, fmadd(a.y, b.y, a.z * b.z)); }
+inline Float8 length(const Vec3x8& a) { return sqrt(dot(a, a)); }
+inline Vec3x8 normalize(const Vec3x8& a) { return a * (Float8(1.0f) / length(a)); }
+// I - 2 * dot(N, I) * N, N normalized
+inline Vec3x8 reflect(const Vec3x8& i, const Vec3x8& n) { return i - n * (dot(n, i) * 2.0f); }
+
+} // namespace SIMD_FLOAT8_NAMESPACE
+
+using namespace SIMD_FLOAT8_NAMESPACE;
+
+#endif /* SimdFloat8_h */
@@ -0,0 +1,433 @@
+#include "SoftwareRasterizer.hpp"
+#include "SceneData.hpp"
+#include "SceneStore.hpp"
+#include "Material.hpp"
+#include "SoftwareShading.hpp"
+#include "TraceRecorder.hpp"
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace std;
+using namespace glm;
+
+const int SoftwareRasterizer::TILE_SIZE;
+
+const int SUBPIXEL_BITS = 8;
+const int64_t SUBPIXEL_ONE = 1 << SUBPIXEL_BITS;
+//保护带：x、y 超出视口 4 倍范围的部分才真正裁掉，其余交给光栅化时的包围盒，
+//同时保证定点坐标的边函数乘积不会溢出 int64
+const float GUARD_BAND = 4.0f;
+
+SoftwareRasterizer::SoftwareRasterizer()
+: imageWidth(0), imageHeight(0), tilesX(0), tilesY(0), shininess(32.0f), modelsVersion(0)
+{
+    lastStats = SoftwareRasterStats();
+}
+
+const char* SoftwareRasterizer::shadingPath()
+{
+    return softwareShadingPath().name;
+}
+
+//打包材质的 mipmap 转成线性空间的浮点 RGBA；没有烘焙好的 mipmap 时和 glGenerateMipmap 一样在线性空间里 2x2 平均
+static void buildMaterialLevels(const PackedMaterialImage& packed, vector<SoftwareRasterizer::MaterialLevel>& levels)
+{
+    float srgbTable[256];
+    for (int i = 0; i < 256; i++)
+        srgbTable[i] = srgbToLinear(i / 255.0f);
+
+    levels.clear();
+    vector<unsigned char> decoded;
+    int width = packed.width, height = packed.height;
+    for (int i = 0; i < packed.levelCount(); i++)
+    {
+        SoftwareRasterizer::MaterialLevel level;
+        level.width = width;
+        level.height = height;
+        level.texels.resize((size_t)width * height * 4);
+        const unsigned char* source = packed.level(i);
+        if (packed.format == CTEX_FORMAT_BC3)
+        {
+            decoded.resize((size_t)width * height * 4);
+            decompressBC3(source, width, height, decoded.data());
+            source = decoded.data();
+        }
+        for (size_t p = 0; p < (size_t)width * height; p++)
+        {
+            level.texels[p * 4]     = srgbTable[source[p * 4]];
+            level.texels[p * 4 + 1] = srgbTable[source[p * 4 + 1]];
+            level.texels[p * 4 + 2] = srgbTable[source[p * 4 + 2]];
+            level.texels[p * 4 + 3] = source[p * 4 + 3] / 255.0f;
+        }
+        levels.push_back(level);
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+
+    while (levels.back().width > 1 || levels.back().height > 1)
+    {
+        const SoftwareRasterizer::MaterialLevel& parent = levels.back();
+        SoftwareRasterizer::MaterialLevel level;
+        level.width = parent.width > 1 ? parent.width / 2 : 1;
+        level.height = parent.height > 1 ? parent.height / 2 : 1;
+        level.texels.resize((size_t)level.width * level.height * 4);
+        for (int y = 0; y < level.height; y++)
+        {
+            int y0 = std::min(y * 2, parent.height - 1), y1 = std::min(y * 2 + 1, parent.height - 1);
+            for (int x = 0; x < level.width; x++)
+            {
+                int x0 = std::min(x * 2, parent.width - 1), x1 = std::min(x * 2 + 1, parent.width - 1);
+                for (int c = 0; c < 4; c++)
+                {
+                    float sum = parent.texels[((size_t)y0 * parent.width + x0) * 4 + c] + parent.texels[((size_t)y0 * parent.width + x1) * 4 + c]
+                              + parent.texels[((size_t)y1 * parent.width + x0) * 4 + c] + parent.texels[((size_t)y1 * parent.width + x1) * 4 + c];
+                    level.texels[((size_t)y * level.width + x) * 4 + c] = sum * 0.25f;
+                }
+            }
+        }
+        levels.push_back(level);
+    }
+}
+
+bool SoftwareRasterizer::init(const string& textureDir, int width, int height, const SceneFile* sceneFile)
+{
+    if (width <= 0 || height <= 0)
+    {
+        cout << "ERROR::SOFTWARE_RASTERIZER::INVALID_SIZE: " << width << "x" << height << endl;
+        return false;
+    }
+    //和 LightingScene::init 相同：默认场景只有箱子一种；场景文件按材质表的顺序加载，场景里的材质编号就是表中的下标
+    vector<string> diffusePaths, specularPaths;
+    if (sceneFile)
+    {
+        for (uint32_t i = 0; i < sceneFile->materialCount(); i++)
+        {
+            diffusePaths.push_back(textureDir + sceneFile->materials()[i].diffusePath.pointer);
+            specularPaths.push_back(textureDir + sceneFile->materials()[i].specularPath.pointer);
+        }
+    }
+    else
+    {
+        diffusePaths.push_back(textureDir + "container2.png");     //CONTAINER_MATERIAL
+        specularPaths.push_back(textureDir + "container2_specular.png");
+    }
+    materials.assign(diffusePaths.size(), vector<MaterialLevel>());
+    for (size_t i = 0; i < diffusePaths.size(); i++)
+    {
+        //表里重复的一对贴图只解码一次
+        size_t same = 0;
+        while (same < i && (diffusePaths[same] != diffusePaths[i] || specularPaths[same] != specularPaths[i]))
+            same++;
+        if (same < i)
+        {
+            materials[i] = materials[same];
+            continue;
+        }
+        PackedMaterialImage packed;
+        if (!loadPackedMaterial(diffusePaths[i].c_str(), specularPaths[i].c_str(), packed))
+        {
+            cout << "ERROR::SOFTWARE_RASTERIZER::MATERIAL_LOAD_FAILED: " << diffusePaths[i] << ", " << specularPaths[i] << endl;
+            return false;
+        }
+        buildMaterialLevels(packed, materials[i]);
+    }
+
+    imageWidth = width;
+    imageHeight = height;
+    tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    bins.assign((size_t)tilesX * tilesY, vector<uint32_t>());
+    image.assign((size_t)width * height * 4, 0);
+    clearColor = sceneClearColor();
+    sceneStore.clear();
+    if (sceneFile)
+        sceneFile->populate(sceneStore);
+    else
+        populateDefaultScene(sceneStore);
+    return true;
+}
+
+// Sutherland-Hodgman against one clip-space plane dot(plane, position) >= 0
+static int clipPolygon(const SoftwareRasterizer::ClipVertex* input, int count, const vec4& plane, SoftwareRasterizer::ClipVertex* output)
+{
+    int written = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const SoftwareRasterizer::ClipVertex& a = input[i];
+        const SoftwareRasterizer::ClipVertex& b = input[(i + 1) % count];
+        float da = dot(plane, a.position);
+        float db = dot(plane, b.position);
+        if (da >= 0.0f)
+            output[written++] = a;
+        if ((da >= 0.0f) != (db >= 0.0f))
+        {
+            float t = da / (da - db);
+            SoftwareRasterizer::ClipVertex& v = output[written++];
+            v.position = a.position + (b.position - a.position) * t;
+            for (int k = 0; k < 8; k++)
+                v.attributes[k] = a.attributes[k] + (b.attributes[k] - a.attributes[k]) * t;
+        }
+    }
+    return written;
+}
+
+void SoftwareRasterizer::drawCube(const mat4& model, const mat4& viewProjection, bool lamp, int material)
+{
+    //与顶点着色器相同：世界坐标、法线矩阵变换后的法向量、原样传递的纹理坐标
+    mat3 normalMatrix = mat3(transpose(inverse(model)));
+    static const vec4 planes[6] = {
+        vec4(0.0f, 0.0f, -1.0f, 1.0f),          // near: z <= w (reversed-Z, see render())
+        vec4(0.0f, 0.0f, 1.0f, 0.0f),           // far: z >= 0, never clips with the infinite far plane
+        vec4(1.0f, 0.0f, 0.0f, GUARD_BAND),
+        vec4(-1.0f, 0.0f, 0.0f, GUARD_BAND),
+        vec4(0.0f, 1.0f, 0.0f, GUARD_BAND),
+        vec4(0.0f, -1.0f, 0.0f, GUARD_BAND)
+    };
+    for (int t = 0; t < CUBE_VERTEX_COUNT / 3; t++)
+    {
+        //每个平面最多让多边形多出一个顶点
+        ClipVertex polygon[9], clipped[9];
+        for (int i = 0; i < 3; i++)
+        {
+            const float* v = cubeVertices + (t * 3 + i) * CUBE_VERTEX_STRIDE;
+            vec4 world = model * vec4(v[0], v[1], v[2], 1.0f);
+            vec3 normal = normalMatrix * vec3(v[3], v[4], v[5]);
+            ClipVertex& vertex = polygon[i];
+            vertex.position = viewProjection * world;
+            vertex.attributes[0] = world.x;
+            vertex.attributes[1] = world.y;
+            vertex.attributes[2] = world.z;
+            vertex.attributes[3] = normal.x;
+            vertex.attributes[4] = normal.y;
+            vertex.attributes[5] = normal.z;
+            vertex.attributes[6] = v[6];
+            vertex.attributes[7] = v[7];
+        }
+        int count = 3;
+        for (int p = 0; p < 6 && count >= 3; p++)
+        {
+            //三个顶点都在平面内侧时(绝大多数情况)不用拷贝
+            bool inside = true;
+            for (int i = 0; i < count && inside; i++)
+                inside = dot(planes[p], polygon[i].position) >= 0.0f;
+            if (inside)
+                continue;
+            count = clipPolygon(polygon, count, planes[p], clipped);
+            copy(clipped, clipped + count, polygon);
+        }
+        for (int i = 1; i + 1 < count; i++)
+            setupTriangle(polygon[0], polygon[i], polygon[i + 1], lamp, material);
+    }
+}
+
+static SoftwareRasterizer::Plane makePlane(const float* x, const float* y, const float* f)
+{
+    float x10 = x[1] - x[0], y10 = y[1] - y[0];
+    float x20 = x[2] - x[0], y20 = y[2] - y[0];
+    float determinant = x10 * y20 - x20 * y10;
+    SoftwareRasterizer::Plane plane;
+    plane.value = f[0];
+    plane.dx = ((f[1] - f[0]) * y20 - (f[2] - f[0]) * y10) / determinant;
+    plane.dy = ((f[2] - f[0]) * x10 - (f[1] - f[0]) * x20) / determinant;
+    return plane;
+}
+
+void SoftwareRasterizer::setupTriangle(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c, bool lamp, int material)
+{
+    const ClipVertex* vertices[3] = { &a, &b, &c };
+    Triangle triangle;
+    float inverseW[3], depth[3];
+    for (int i = 0; i < 3; i++)
+    {
+        const vec4& position = vertices[i]->position;
+        inverseW[i] = 1.0f / position.w;
+        float sx = (position.x * inverseW[i] * 0.5f + 0.5f) * imageWidth;
+        float sy = (0.5f - position.y * inverseW[i] * 0.5f) * imageHeight;    //图像从上往下存
+        triangle.x[i] = (int64_t)llroundf(sx * SUBPIXEL_ONE);
+        triangle.y[i] = (int64_t)llroundf(sy * SUBPIXEL_ONE);
+        depth[i] = position.z * inverseW[i];                                   //反向 Z 的深度范围已经是 [0, 1]
+    }
+    int64_t area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0]) - (triangle.y[1] - triangle.y[0]) * (triangle.x[2] - triangle.x[0]);
+    if (area == 0)
+        return;
+    //不做背面剔除(GL 那边也没开)，统一成正的绕向，内部点的三个边函数都是正的
+    if (area < 0)
+    {
+        swap(vertices[1], vertices[2]);
+        swap(triangle.x[1], triangle.x[2]);
+        swap(triangle.y[1], triangle.y[2]);
+        swap(inverseW[1], inverseW[2]);
+        swap(depth[1], depth[2]);
+    }
+
+    float x[3], y[3];
+    for (int i = 0; i < 3; i++)
+    {
+        x[i] = (float)triangle.x[i] / SUBPIXEL_ONE;
+        y[i] = (float)triangle.y[i] / SUBPIXEL_ONE;
+    }
+    triangle.minX = std::max(0, (int)floorf(std::min(x[0], std::min(x[1], x[2]))));
+    triangle.minY = std::max(0, (int)floorf(std::min(y[0], std::min(y[1], y[2]))));
+    triangle.maxX = std::min(imageWidth - 1, (int)ceilf(std::max(x[0], std::max(x[1], x[2]))));
+    triangle.maxY = std::min(imageHeight - 1, (int)ceilf(std::max(y[0], std::max(y[1], y[2]))));
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+        return;
+
+    triangle.originX = x[0];
+    triangle.originY = y[0];
+    triangle.depth = makePlane(x, y, depth);
+    triangle.inverseW = makePlane(x, y, inverseW);
+    for (int k = 0; k < 8; k++)
+    {
+        float values[3];
+        for (int i = 0; i < 3; i++)
+            values[i] = vertices[i]->attributes[k] * inverseW[i];
+        triangle.attributes[k] = makePlane(x, y, values);
+    }
+    triangle.lamp = lamp ? 1 : 0;
+    triangle.material = material;
+
+    uint32_t index = (uint32_t)triangles.size();
+    triangles.push_back(triangle);
+    for (int ty = triangle.minY / TILE_SIZE; ty <= triangle.maxY / TILE_SIZE; ty++)
+        for (int tx = triangle.minX / TILE_SIZE; tx <= triangle.maxX / TILE_SIZE; tx++)
+            bins[(size_t)ty * tilesX + tx].push_back(index);
+}
+
+void SoftwareRasterizer::render(Camera& camera)
+{
+    TraceScope trace("software frame");
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    //深度缓冲本来就是 float，总是用反向 Z 和无穷远的远平面，和支持 glClipControl 时的 LightingScene 一样
+    camera.SetReversedZ(true);
+    camera.SetProjection((float)imageWidth / (float)imageHeight, camera.NearPlane, INFINITE_FAR_PLANE);
+    const mat4& viewProjection = camera.GetViewProjectionMatrix();
+    SceneLighting lighting = sceneLighting(sceneStore, camera);
+    shininess = lighting.shininess;
+
+    triangles.clear();
+    for (size_t i = 0; i < bins.size(); i++)
+        bins[i].clear();
+    {
+        TraceScope setup("software setup");
+        //模型矩阵只在场景变化时重新计算
+        if (models.size() != sceneStore.renderableCount() || modelsVersion != sceneStore.version())
+        {
+            models.resize(sceneStore.renderableCount());
+            if (!models.empty())
+                sceneStore.renderableTransforms().computeMatrices(&models[0], sizeof(mat4), nullptr, 0);
+            modelsVersion = sceneStore.version();
+        }
+        //和 GL 一样先画箱子再画灯泡，深度相同时先画的留下
+        //没有加载过的材质编号退回第一个材质，一个材质都没有时不采样贴图(和 LightingScene 不绑定贴图对应)
+        const vector<int>& meshes = sceneStore.renderableMeshes();
+        const vector<int>& materialIds = sceneStore.renderableMaterials();
+        for (size_t i = 0; i < models.size(); i++)
+        {
+            if (meshes[i] == MESH_LAMP)
+                continue;
+            int material = -1;
+            if (materialIds[i] >= 0 && materialIds[i] < (int)materials.size())
+                material = materialIds[i];
+            else if (!materials.empty())
+                material = CONTAINER_MATERIAL;
+            drawCube(models[i], viewProjection, false, material);
+        }
+        for (size_t i = 0; i < models.size(); i++)
+            if (meshes[i] == MESH_LAMP)
+                drawCube(models[i], viewProjection, true, -1);
+    }
+    chrono::steady_clock::time_point binned = chrono::steady_clock::now();
+
+    unsigned long long fragments = 0;
+    renderTiles(lighting, camera.Position, &fragments);
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+
+    lastStats.setupMilliseconds = chrono::duration<double, milli>(binned - start).count();
+    lastStats.rasterMilliseconds = chrono::duration<double, milli>(end - binned).count();
+    lastStats.triangles = (unsigned int)triangles.size();
+    lastStats.fragments = fragments;
+    lastStats.threads = jobSystem().workerCount() + 1;
+}
+
+void SoftwareRasterizer::renderTiles(const SceneLighting& lighting, const vec3& viewPos, unsigned long long* fragments)
+{
+    //每个块是一个任务，空闲的任务线程会把剩下的块偷走；调用线程在 parallelFor 里等待时也干活
+    atomic<unsigned long long> shaded(0);
+    jobSystem().parallelFor((size_t)tilesX * tilesY, 1, [&](size_t begin, size_t end) {
+        //块内的深度和可见性缓冲放在栈上，一共 32 KB
+        float depth[TILE_SIZE * TILE_SIZE];
+        uint32_t visible[TILE_SIZE * TILE_SIZE];
+        unsigned long long count = 0;
+        for (size_t tile = begin; tile < end; tile++)
+            renderTile((int)tile, lighting, viewPos, depth, visible, &count);
+        shaded.fetch_add(count, memory_order_relaxed);
+    });
+    *fragments += shaded.load();
+}
+
+void SoftwareRasterizer::renderTile(int tile, const SceneLighting& lighting, const vec3& viewPos, float* depth, uint32_t* visible, unsigned long long* fragments)
+{
+    int tileX = (tile % tilesX) * TILE_SIZE, tileY = (tile / tilesX) * TILE_SIZE;
+    int tileWidth = std::min(TILE_SIZE, imageWidth - tileX), tileHeight = std::min(TILE_SIZE, imageHeight - tileY);
+    fill(depth, depth + TILE_SIZE * TILE_SIZE, 0.0f);
+    fill(visible, visible + TILE_SIZE * TILE_SIZE, NO_TRIANGLE);
+
+    //第一遍：只做覆盖和深度测试(反向 Z，相当于 GL_GREATER)，记下每个像素可见的三角形
+    const vector<uint32_t>& bin = bins[tile];
+    for (size_t b = 0; b < bin.size(); b++)
+    {
+        const Triangle& triangle = triangles[bin[b]];
+        int x0 = std::max(triangle.minX, tileX), x1 = std::min(triangle.maxX, tileX + tileWidth - 1);
+        int y0 = std::max(triangle.minY, tileY), y1 = std::min(triangle.maxY, tileY + tileHeight - 1);
+        if (x0 > x1 || y0 > y1)
+            continue;
+
+        //边函数在像素中心取值；左上规则：正好落在边上的像素只归上边或左边是这条边的三角形
+        int64_t rowEdge[3], stepX[3], stepY[3];
+        int64_t sampleX = x0 * SUBPIXEL_ONE + SUBPIXEL_ONE / 2, sampleY = y0 * SUBPIXEL_ONE + SUBPIXEL_ONE / 2;
+        for (int e = 0; e < 3; e++)
+        {
+            int a = (e + 1) % 3, c = (e + 2) % 3;
+            int64_t dx = triangle.x[c] - triangle.x[a], dy = triangle.y[c] - triangle.y[a];
+            bool topLeft = dy < 0 || (dy == 0 && dx > 0);
+            rowEdge[e] = dx * (sampleY - triangle.y[a]) - dy * (sampleX - triangle.x[a]) + (topLeft ? 1 : 0);
+            stepX[e] = -dy * SUBPIXEL_ONE;
+            stepY[e] = dx * SUBPIXEL_ONE;
+        }
+        float rowDepth = triangle.depth.value + triangle.depth.dx * (x0 + 0.5f - triangle.originX) + triangle.depth.dy * (y0 + 0.5f - triangle.originY);
+        for (int y = y0; y <= y1; y++)
+        {
+            int64_t e0 = rowEdge[0], e1 = rowEdge[1], e2 = rowEdge[2];
+            float z = rowDepth;
+            float* depthRow = depth + (y - tileY) * TILE_SIZE - tileX;
+            uint32_t* visibleRow = visible + (y - tileY) * TILE_SIZE - tileX;
+            for (int x = x0; x <= x1; x++)
+            {
+                if (e0 > 0 && e1 > 0 && e2 > 0 && z > depthRow[x])
+                {
+                    depthRow[x] = z;
+                    visibleRow[x] = bin[b];
+                }
+                e0 += stepX[0];
+                e1 += stepX[1];
+                e2 += stepX[2];
+                z += triangle.depth.dx;
+            }
+            rowEdge[0] += stepY[0];
+            rowEdge[1] += stepY[1];
+            rowEdge[2] += stepY[2];
+            rowDepth += triangle.depth.dy;
+        }
+    }
+
+    //第二遍：对可见像素着色，按 CPU 支持的指令集选择实现(见 SoftwareShading.hpp)
+    SoftwareShadingTile shading = { triangles.data(), &materials, &lighting, viewPos, clearColor, shininess, visible,
+                                    tileX, tileY, tileWidth, tileHeight, image.data(), imageWidth };
+    *fragments += softwareShadingPath().shadeTile(shading);
+}
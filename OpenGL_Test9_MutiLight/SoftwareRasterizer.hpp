@@ -0,0 +1,104 @@
+#ifndef SoftwareRasterizer_hpp
+#define SoftwareRasterizer_hpp
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "Camera.hpp"
+#include "SceneData.hpp"
+#include "SceneStore.hpp"
+#include "SceneFile.hpp"
+
+using namespace std;
+using namespace glm;
+
+//CPU 软件光栅化：不需要 GL 上下文，画的是和 LightingScene 同一个场景(SceneData/SceneStore)，输出可以直接和 GL 的截图比较
+//材质和 LightingScene 一样：默认场景只有 container2，场景文件按材质表加载，场景里的材质编号就是表中的下标
+//  1. 顶点变换、在裁剪空间里裁剪(近/远平面 + 保护带，反向 Z)、建立三角形的屏幕空间平面方程，按 64x64 的块分桶
+//  2. 按块在 jobSystem() 上并行：先只做深度测试，记下每个像素最终可见的三角形(可见性缓冲)，
+//     再对可见像素按 8 个一组着色，光照计算和片段着色器的 CalcDirLight/CalcPointLight/CalcSpotLight 一致
+//顶点坐标吸附到 1/256 像素的定点数上，边函数用整数计算，共享边按左上规则只归一个三角形，不会有缝或重复
+//贴图用三线性过滤，mipmap 级别由每个像素的纹理坐标导数决定，与 GL_LINEAR_MIPMAP_LINEAR 的做法相同
+
+struct SoftwareRasterStats {
+    double setupMilliseconds;       //变换、裁剪、三角形建立和分桶(单线程)
+    double rasterMilliseconds;      //各个块的光栅化和着色(jobSystem 上并行)
+    unsigned int triangles;         //裁剪后进入分桶的三角形数
+    unsigned long long fragments;   //着色的像素数，每个像素最多着色一次
+    int threads;                    //参与光栅化的线程数：任务线程 + 调用线程
+};
+
+class SoftwareRasterizer {
+public:
+    SoftwareRasterizer();
+
+    // loads the materials from textureDir: container2.png + container2_specular.png (or their cooked .ctex) for the default scene,
+    // or the material table of sceneFile, which also replaces the default scene; false if any material fails to load
+    bool init(const string& textureDir, int width, int height, const SceneFile* sceneFile = nullptr);
+    // renders one frame of the scene into the internal image
+    void render(Camera& camera);
+    // the entities drawn by render(); filled with the default scene by init(), may be changed between frames
+    SceneStore& scene() { return sceneStore; }
+
+    // RGBA8, sRGB encoded, rows from top to bottom (same layout as OffscreenTarget::readPixels)
+    const vector<unsigned char>& pixels() const { return image; }
+    int width() const { return imageWidth; }
+    int height() const { return imageHeight; }
+    const SoftwareRasterStats& stats() const { return lastStats; }
+    // "AVX2", "SSE2" or "scalar": the shading implementation picked for this CPU (see SoftwareShading.hpp)
+    static const char* shadingPath();
+
+    static const int TILE_SIZE = 64;
+
+    //裁剪空间顶点：位置 + 需要插值的属性(世界坐标 xyz、法向量 xyz、纹理坐标 uv)
+    struct ClipVertex {
+        vec4 position;
+        float attributes[8];
+    };
+
+    //屏幕空间平面方程 f(x, y) = value + dx * (x - originX) + dy * (y - originY)
+    struct Plane {
+        float value, dx, dy;
+    };
+
+    struct Triangle {
+        int64_t x[3], y[3];         //定点坐标，1/256 像素
+        int minX, minY, maxX, maxY; //覆盖的像素范围，已经限制在图像内
+        float originX, originY;     //平面方程的原点(第一个顶点，像素单位)
+        Plane depth;                //窗口空间深度(反向 Z，近处大)，屏幕空间线性
+        Plane inverseW;             //1/w
+        Plane attributes[8];        //属性/w，透视校正插值时再除以 1/w
+        int lamp;                   //1 = 灯泡(纯白)，0 = 箱子
+        int material;               //箱子的材质(materials 的下标)，-1 = 没有贴图
+    };
+
+    struct MaterialLevel {
+        int width, height;
+        vector<float> texels;       //RGBA，rgb 是线性空间的漫反射颜色，a 是镜面反射强度
+    };
+
+private:
+    SoftwareRasterizer(const SoftwareRasterizer&);
+    SoftwareRasterizer& operator=(const SoftwareRasterizer&);
+
+    void drawCube(const mat4& model, const mat4& viewProjection, bool lamp, int material);
+    void setupTriangle(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c, bool lamp, int material);
+    void renderTiles(const SceneLighting& lighting, const vec3& viewPos, unsigned long long* fragments);
+    void renderTile(int tile, const SceneLighting& lighting, const vec3& viewPos, float* depth, uint32_t* visible, unsigned long long* fragments);
+
+    int imageWidth, imageHeight;
+    int tilesX, tilesY;
+    vector<unsigned char> image;
+    vector<vector<MaterialLevel> > materials;   //每个材质的 mipmap 链，下标是场景里的材质编号
+    vector<Triangle> triangles;
+    vector<vector<uint32_t> > bins;     //每个块按提交顺序记录覆盖它的三角形
+    vec3 clearColor;                    //线性空间
+    float shininess;
+    SoftwareRasterStats lastStats;
+    SceneStore sceneStore;
+    vector<mat4> models;                //每个可渲染组件的模型矩阵，与 SceneStore 的紧凑数组一一对应
+    uint64_t modelsVersion;
+};
+
+#endif /* SoftwareRasterizer_hpp */
@@ -0,0 +1,23 @@
+#include "SoftwareShading.hpp"
+#include "SoftwareShadingKernel.h"
+
+//默认编译参数的那一份；整个程序本来就是按 -mavx2 -mfma 编译的话，这一份已经是 AVX2
+static SoftwareShadingPath selectShadingPath()
+{
+    SoftwareShadingPath path = { simdFloat8Path(), shadeTile };
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    SoftwareShadeTileFunction avx2 = softwareShadeTileAVX2();
+    if (avx2 && !SIMD_FLOAT8_AVX2 && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+        path.name = "AVX2";
+        path.shadeTile = avx2;
+    }
+#endif
+    return path;
+}
+
+const SoftwareShadingPath& softwareShadingPath()
+{
+    static const SoftwareShadingPath path = selectShadingPath();
+    return path;
+}
@@ -0,0 +1,47 @@
+#ifndef SoftwareShading_hpp
+#define SoftwareShading_hpp
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "SceneData.hpp"
+#include "SoftwareRasterizer.hpp"
+
+using namespace std;
+using namespace glm;
+
+//软件光栅化的着色(第二遍)按指令集编译了两份，运行时按 CPU 选一份：
+//  SoftwareShading.cpp      默认编译参数，x86_64 上是 SSE2，arm64 等是逐分量的循环
+//  SoftwareShadingAVX2.cpp  Makefile 在 x86_64 上给它单独加 -mavx2 -mfma，CPU 支持 AVX2 + FMA 时使用
+//两者共用 SoftwareShadingKernel.h 里的代码，不需要为了 AVX2 用特殊参数编译整个程序
+
+const uint32_t NO_TRIANGLE = 0xffffffffu;      //可见性缓冲里没有三角形覆盖的像素
+
+//一个块的着色输入：第一遍得到的可见性缓冲，加上光栅化器这一帧的只读状态
+struct SoftwareShadingTile {
+    const SoftwareRasterizer::Triangle* triangles;
+    const vector<vector<SoftwareRasterizer::MaterialLevel> >* materials;
+    const SceneLighting* lighting;
+    vec3 viewPos;
+    vec3 clearColor;            //线性空间
+    float shininess;
+    const uint32_t* visible;    //TILE_SIZE * TILE_SIZE，行距 TILE_SIZE
+    int tileX, tileY, tileWidth, tileHeight;
+    unsigned char* image;       //整幅图像，RGBA8
+    int imageWidth;
+};
+
+// shades every visible pixel of the tile into the image, returns the number of pixels shaded
+typedef unsigned long long (*SoftwareShadeTileFunction)(const SoftwareShadingTile& tile);
+
+struct SoftwareShadingPath {
+    const char* name;           // "AVX2", "SSE2" or "scalar"
+    SoftwareShadeTileFunction shadeTile;
+};
+
+// the implementation for this CPU, chosen on first use
+const SoftwareShadingPath& softwareShadingPath();
+// the AVX2 build of the kernel, or null when SoftwareShadingAVX2.cpp was compiled without -mavx2 -mfma
+SoftwareShadeTileFunction softwareShadeTileAVX2();
+
+#endif /* SoftwareShading_hpp */
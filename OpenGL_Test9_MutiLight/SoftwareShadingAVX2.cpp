@@ -0,0 +1,23 @@
+//着色内核的 AVX2 版本：Makefile 在 x86_64 上只给这个文件加 -mavx2 -mfma，是否使用由 softwareShadingPath() 在运行时检测 CPU 决定
+//这里实例化的 vector 等模板函数可能带着 AVX2 指令被输出，所以它在 APP_SOURCES 里排在最后，链接器优先保留其它文件里的同名副本
+//没有带这两个参数编译时(非 x86_64，或者 Xcode 工程里没有单独设置)只提供一个空入口，运行时退回默认的一份
+
+#include "SoftwareShading.hpp"
+
+#if defined(__AVX2__) && defined(__FMA__)
+
+#include "SoftwareShadingKernel.h"
+
+SoftwareShadeTileFunction softwareShadeTileAVX2()
+{
+    return shadeTile;
+}
+
+#else
+
+SoftwareShadeTileFunction softwareShadeTileAVX2()
+{
+    return nullptr;
+}
+
+#endif
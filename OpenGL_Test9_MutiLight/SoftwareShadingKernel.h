@@ -0,0 +1,238 @@
+#ifndef SoftwareShadingKernel_h
+#define SoftwareShadingKernel_h
+
+//软件光栅化第二遍(着色)的实现，不单独编译：SoftwareShading.cpp 和 SoftwareShadingAVX2.cpp 各包含一次，
+//按各自的编译参数得到 SimdFloat8.h 的不同实现；这里的函数都是 static 的，两份之间互不可见
+
+#include "SoftwareShading.hpp"
+#include "SimdFloat8.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace glm;
+
+//GL_REPEAT + GL_LINEAR，纹理坐标 0 对应贴图数据的第一行(与 glTexImage 上传时一样)
+static void sampleBilinear(const SoftwareRasterizer::MaterialLevel& level, float u, float v, float* texel)
+{
+    float x = u * level.width - 0.5f, y = v * level.height - 0.5f;
+    float fx = floorf(x), fy = floorf(y);
+    float tx = x - fx, ty = y - fy;
+    int x0 = (int)fx % level.width, y0 = (int)fy % level.height;
+    if (x0 < 0) x0 += level.width;
+    if (y0 < 0) y0 += level.height;
+    int x1 = x0 + 1 == level.width ? 0 : x0 + 1;
+    int y1 = y0 + 1 == level.height ? 0 : y0 + 1;
+    const float* t00 = &level.texels[((size_t)y0 * level.width + x0) * 4];
+    const float* t10 = &level.texels[((size_t)y0 * level.width + x1) * 4];
+    const float* t01 = &level.texels[((size_t)y1 * level.width + x0) * 4];
+    const float* t11 = &level.texels[((size_t)y1 * level.width + x1) * 4];
+    for (int c = 0; c < 4; c++)
+    {
+        float top = t00[c] + (t10[c] - t00[c]) * tx;
+        float bottom = t01[c] + (t11[c] - t01[c]) * tx;
+        texel[c] = top + (bottom - top) * ty;
+    }
+}
+
+// GL_LINEAR_MIPMAP_LINEAR with the level of detail from the screen-space derivatives of the texture coordinates
+static void sampleTrilinear(const vector<SoftwareRasterizer::MaterialLevel>& levels, float u, float v, float dudx, float dvdx, float dudy, float dvdy, float* texel)
+{
+    float width = (float)levels[0].width, height = (float)levels[0].height;
+    float rhoX = (dudx * width) * (dudx * width) + (dvdx * height) * (dvdx * height);
+    float rhoY = (dudy * width) * (dudy * width) + (dvdy * height) * (dvdy * height);
+    float lod = 0.5f * log2f(std::max(rhoX, rhoY));      //log2(sqrt(rho))
+    if (!(lod > 0.0f))
+    {
+        sampleBilinear(levels[0], u, v, texel);
+        return;
+    }
+    lod = std::min(lod, (float)(levels.size() - 1));
+    int base = (int)lod;
+    float t = lod - base;
+    sampleBilinear(levels[base], u, v, texel);
+    if (t <= 0.0f || base + 1 >= (int)levels.size())
+        return;
+    float upper[4];
+    sampleBilinear(levels[base + 1], u, v, upper);
+    for (int c = 0; c < 4; c++)
+        texel[c] += (upper[c] - texel[c]) * t;
+}
+
+static Vec3x8 splat(const vec3& v)
+{
+    return Vec3x8(Float8(v.x), Float8(v.y), Float8(v.z));
+}
+
+//以下三个函数与光照片段着色器里的同名函数逐行对应，只是一次算 8 个片段
+static Vec3x8 CalcDirLight(const DirLight& light, const Vec3x8& normal, const Vec3x8& viewDir,
+                           const Vec3x8& diffuseColor, Float8 specularColor, Float8 shininess)
+{
+    Vec3x8 lightDir = normalize(-splat(light.direction));
+    // 漫反射着色
+    Float8 diff = max(dot(normal, lightDir), 0.0f);
+    // 镜面光着色
+    Vec3x8 reflectDir = reflect(-lightDir, normal);
+    Float8 spec = pow(max(dot(viewDir, reflectDir), 0.0f), shininess);
+    // 合并结果
+    Vec3x8 ambient  = splat(light.ambient) * diffuseColor;
+    Vec3x8 diffuse  = splat(light.diffuse) * diffuseColor * diff;
+    Vec3x8 specular = splat(light.specular) * (spec * specularColor);
+    return ambient + diffuse + specular;
+}
+
+static Vec3x8 CalcPointLight(const PointLight& light, const Vec3x8& normal, const Vec3x8& fragPos, const Vec3x8& viewDir,
+                             const Vec3x8& diffuseColor, Float8 specularColor, Float8 shininess)
+{
+    Vec3x8 toLight = splat(light.position) - fragPos;
+    Float8 distance = length(toLight);
+    Vec3x8 lightDir = toLight * (Float8(1.0f) / distance);
+    // 漫反射着色
+    Float8 diff = max(dot(normal, lightDir), 0.0f);
+    // 镜面光着色
+    Vec3x8 reflectDir = reflect(-lightDir, normal);
+    Float8 spec = pow(max(dot(viewDir, reflectDir), 0.0f), shininess);
+    // 衰减
+    Float8 attenuation = Float8(1.0f) / (Float8(light.constant) + Float8(light.linear) * distance + Float8(light.quadratic) * (distance * distance));
+    // 合并结果
+    Vec3x8 ambient  = splat(light.ambient) * diffuseColor;
+    Vec3x8 diffuse  = splat(light.diffuse) * diffuseColor * diff;
+    Vec3x8 specular = splat(light.specular) * (spec * specularColor);
+    return (ambient + diffuse + specular) * attenuation;
+}
+
+static Vec3x8 CalcSpotLight(const SpotLight& light, const Vec3x8& normal, const Vec3x8& fragPos, const Vec3x8& viewDir,
+                            const Vec3x8& diffuseColor, Float8 specularColor, Float8 shininess)
+{
+    Vec3x8 toLight = splat(light.position) - fragPos;
+    Float8 distance = length(toLight);
+    Vec3x8 lightDir = toLight * (Float8(1.0f) / distance);
+    // diffuse shading
+    Float8 diff = max(dot(normal, lightDir), 0.0f);
+    // specular shading
+    Vec3x8 reflectDir = reflect(-lightDir, normal);
+    Float8 spec = pow(max(dot(viewDir, reflectDir), 0.0f), shininess);
+    // attenuation
+    Float8 attenuation = Float8(1.0f) / (Float8(light.constant) + Float8(light.linear) * distance + Float8(light.quadratic) * (distance * distance));
+    // spotlight intensity
+    Float8 theta = dot(lightDir, normalize(-splat(light.direction)));
+    Float8 epsilon = light.cutOff - light.outerCutOff;
+    Float8 intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0f, 1.0f);
+    // combine results
+    Vec3x8 ambient = splat(light.ambient) * diffuseColor;
+    Vec3x8 diffuse = splat(light.diffuse) * diffuseColor * diff;
+    Vec3x8 specular = splat(light.specular) * (spec * specularColor);
+    return (ambient + diffuse + specular) * (attenuation * intensity);
+}
+
+//与 GL_FRAMEBUFFER_SRGB 写入时的编码相同
+static Float8 linearToSrgb(Float8 c)
+{
+    c = clamp(c, 0.0f, 1.0f);
+    return select(c <= 0.0031308f, c * 12.92f, Float8(1.055f) * pow(c, 1.0f / 2.4f) - 0.055f);
+}
+//第二遍：每个可见像素只着色一次，8 个一组；逐像素的插值和贴图采样是标量的，光照是 8 路的
+static unsigned long long shadeTile(const SoftwareShadingTile& tile)
+{
+    const SceneLighting& lighting = *tile.lighting;
+    const SoftwareRasterizer::Triangle* triangles = tile.triangles;
+    const vector<vector<SoftwareRasterizer::MaterialLevel> >& materials = *tile.materials;
+    const vec3& viewPos = tile.viewPos;
+    int tileX = tile.tileX, tileY = tile.tileY, tileWidth = tile.tileWidth, tileHeight = tile.tileHeight;
+    Vec3x8 viewPosition = splat(viewPos);
+    Float8 shine(tile.shininess);
+    Vec3x8 clear = splat(tile.clearColor);
+    alignas(32) float lanes[10][8];
+    alignas(32) float masks[2][8];
+    alignas(32) float encoded[3][8];
+    unsigned long long shaded = 0;
+    for (int y = tileY; y < tileY + tileHeight; y++)
+    {
+        const uint32_t* visibleRow = tile.visible + (y - tileY) * SoftwareRasterizer::TILE_SIZE;
+        unsigned char* out = tile.image + ((size_t)y * tile.imageWidth + tileX) * 4;
+        for (int x = 0; x < tileWidth; x += 8)
+        {
+            int count = std::min(8, tileWidth - x);
+            bool anyContainer = false;
+            for (int lane = 0; lane < 8; lane++)
+            {
+                uint32_t id = lane < count ? visibleRow[x + lane] : NO_TRIANGLE;
+                masks[0][lane] = 0.0f;      //箱子
+                masks[1][lane] = 0.0f;      //灯泡
+                if (id == NO_TRIANGLE || triangles[id].lamp)
+                {
+                    //空的通道填上不会产生 NaN 的值，结果最后会被 select 丢掉
+                    for (int k = 0; k < 10; k++)
+                        lanes[k][lane] = 0.0f;
+                    lanes[3][lane] = 1.0f;
+                    lanes[0][lane] = viewPos.x + 1.0f;
+                    if (id != NO_TRIANGLE)
+                    {
+                        masks[1][lane] = 1.0f;
+                        shaded++;
+                    }
+                    continue;
+                }
+                const SoftwareRasterizer::Triangle& triangle = triangles[id];
+                float cx = x + tileX + lane + 0.5f - triangle.originX, cy = y + 0.5f - triangle.originY;
+                float inverseW = triangle.inverseW.value + triangle.inverseW.dx * cx + triangle.inverseW.dy * cy;
+                float w = 1.0f / inverseW;
+                float attributes[8];
+                for (int k = 0; k < 8; k++)
+                    attributes[k] = (triangle.attributes[k].value + triangle.attributes[k].dx * cx + triangle.attributes[k].dy * cy) * w;
+                //u = U / W 的导数：(dU - u * dW) / W
+                const SoftwareRasterizer::Plane& pu = triangle.attributes[6];
+                const SoftwareRasterizer::Plane& pv = triangle.attributes[7];
+                float texel[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                if (triangle.material >= 0)
+                    sampleTrilinear(materials[triangle.material], attributes[6], attributes[7],
+                                    (pu.dx - attributes[6] * triangle.inverseW.dx) * w, (pv.dx - attributes[7] * triangle.inverseW.dx) * w,
+                                    (pu.dy - attributes[6] * triangle.inverseW.dy) * w, (pv.dy - attributes[7] * triangle.inverseW.dy) * w, texel);
+                for (int k = 0; k < 6; k++)
+                    lanes[k][lane] = attributes[k];
+                for (int c = 0; c < 4; c++)
+                    lanes[6 + c][lane] = texel[c];
+                masks[0][lane] = 1.0f;
+                anyContainer = true;
+                shaded++;
+            }
+
+            Vec3x8 color = clear;
+            Float8 lampMask = Float8::load(masks[1]) > 0.0f;
+            if (anyContainer)
+            {
+                Vec3x8 fragPos(Float8::load(lanes[0]), Float8::load(lanes[1]), Float8::load(lanes[2]));
+                Vec3x8 normal(Float8::load(lanes[3]), Float8::load(lanes[4]), Float8::load(lanes[5]));
+                Vec3x8 diffuseColor(Float8::load(lanes[6]), Float8::load(lanes[7]), Float8::load(lanes[8]));
+                Float8 specularColor = Float8::load(lanes[9]);
+
+                Vec3x8 norm = normalize(normal);
+                Vec3x8 viewDir = normalize(viewPosition - fragPos);
+                Vec3x8 result = CalcDirLight(lighting.dirLight, norm, viewDir, diffuseColor, specularColor, shine);
+                for (size_t i = 0; i < lighting.pointLights.size(); i++)
+                    result = result + CalcPointLight(lighting.pointLights[i], norm, fragPos, viewDir, diffuseColor, specularColor, shine);
+                result = result + CalcSpotLight(lighting.spotLight, norm, fragPos, viewDir, diffuseColor, specularColor, shine);
+
+                Float8 containerMask = Float8::load(masks[0]) > 0.0f;
+                color = Vec3x8(select(containerMask, result.x, color.x), select(containerMask, result.y, color.y), select(containerMask, result.z, color.z));
+            }
+            //灯的片段着色器输出常量白色
+            color = Vec3x8(select(lampMask, 1.0f, color.x), select(lampMask, 1.0f, color.y), select(lampMask, 1.0f, color.z));
+
+            (linearToSrgb(color.x) * 255.0f + 0.5f).store(encoded[0]);
+            (linearToSrgb(color.y) * 255.0f + 0.5f).store(encoded[1]);
+            (linearToSrgb(color.z) * 255.0f + 0.5f).store(encoded[2]);
+            for (int lane = 0; lane < count; lane++)
+            {
+                unsigned char* pixel = out + (x + lane) * 4;
+                pixel[0] = (unsigned char)encoded[0][lane];
+                pixel[1] = (unsigned char)encoded[1][lane];
+                pixel[2] = (unsigned char)encoded[2][lane];
+                pixel[3] = 255;
+            }
+        }
+    }
+    return shaded;
+}
+
+#endif /* SoftwareShadingKernel_h */
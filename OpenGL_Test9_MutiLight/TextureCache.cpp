@@ -0,0 +1,117 @@
+#include "TextureCache.hpp"
+#include <iostream>
+
+using namespace std;
+
+TextureCache::TextureCache(size_t budgetBytes)
+: budgetBytes(budgetBytes)
+{
+    counters.evictions = 0;
+    counters.residentBytes = counters.residentCount = 0;
+}
+
+TextureCache::~TextureCache()
+{
+    clear();
+}
+
+void TextureCache::release(const string& key)
+{
+    Entry* entry = find(key);
+    if (!entry || entry->refCount == 0)
+    {
+        cout << "ERROR::TEXTURE_CACHE::RELEASE_WITHOUT_ADOPT: " << key << endl;
+        return;
+    }
+    entry->refCount--;
+    touch(*entry);
+    //刚变成未引用的贴图可能就是超出预算的那一张
+    if (entry->refCount == 0 && counters.residentBytes > budgetBytes)
+        trim();
+}
+
+bool TextureCache::adopt(const string& key, unsigned int textureID, size_t bytes)
+{
+    unordered_map<string, Entry>::iterator existing = entries.find(key);
+    if (existing != entries.end())
+    {
+        //还有人在用的贴图不能替换，删掉它会让持有者拿着一个失效的纹理名
+        if (existing->second.refCount > 0)
+        {
+            cout << "ERROR::TEXTURE_CACHE::KEY_IN_USE: " << key << endl;
+            return false;
+        }
+        evict(key);
+    }
+    lruOrder.push_front(key);
+    Entry entry = { textureID, bytes, 1, lruOrder.begin() };
+    entries[key] = entry;
+    counters.residentBytes += bytes;
+    counters.residentCount++;
+    if (counters.residentBytes > budgetBytes)
+        trim();
+    return true;
+}
+
+void TextureCache::setBudget(size_t budget)
+{
+    budgetBytes = budget;
+    trim();
+}
+
+size_t TextureCache::budget() const
+{
+    return budgetBytes;
+}
+
+void TextureCache::trim()
+{
+    // walk from the least recently used end; referenced textures are skipped, not evicted
+    list<string>::iterator it = lruOrder.end();
+    while (counters.residentBytes > budgetBytes && it != lruOrder.begin())
+    {
+        --it;
+        Entry& entry = entries[*it];
+        if (entry.refCount > 0)
+            continue;
+        string key = *it;
+        ++it;   // evict() erases the node we are standing on
+        evict(key);
+        counters.evictions++;
+    }
+}
+
+void TextureCache::clear()
+{
+    for (unordered_map<string, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+        glDeleteTextures(1, &it->second.textureID);
+    entries.clear();
+    lruOrder.clear();
+    counters.residentBytes = counters.residentCount = 0;
+}
+
+const TextureCache::Stats& TextureCache::stats() const
+{
+    return counters;
+}
+
+TextureCache::Entry* TextureCache::find(const string& key)
+{
+    unordered_map<string, Entry>::iterator it = entries.find(key);
+    return it != entries.end() ? &it->second : nullptr;
+}
+
+void TextureCache::touch(Entry& entry)
+{
+    lruOrder.splice(lruOrder.begin(), lruOrder, entry.lru);
+}
+
+void TextureCache::evict(const string& key)
+{
+    unordered_map<string, Entry>::iterator it = entries.find(key);
+    glDeleteTextures(1, &it->second.textureID);
+    counters.residentBytes -= it->second.bytes;
+    counters.residentCount--;
+    lruOrder.erase(it->second.lru);
+    entries.erase(it);
+}
@@ -0,0 +1,62 @@
+#ifndef TextureCache_hpp
+#define TextureCache_hpp
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+//贴图缓存：管理交给它的 GL 纹理（目前是 MaterialRegistry 的材质数组）并按显存预算淘汰
+//  adopt 时登记一个引用，release 归还；引用计数归零的贴图仍然留在显存里，直到超出预算
+//  常驻显存超过预算时，按最近最少使用(LRU)的顺序淘汰没有被引用的贴图
+//  正在被引用的贴图永远不会被淘汰，所以预算可能被暂时突破
+class TextureCache {
+public:
+    struct Stats {
+        size_t evictions;
+        size_t residentBytes;   //当前估算的显存占用
+        size_t residentCount;
+    };
+
+    TextureCache(size_t budgetBytes);
+    ~TextureCache();
+
+    // hands a texture created elsewhere (e.g. a material array) to the cache with one reference held by the caller
+    // an unreferenced texture already under key is evicted first; false (and the caller keeps the texture) if it is still referenced
+    bool adopt(const string& key, unsigned int textureID, size_t bytes);
+    // drops the caller's reference; the texture stays resident until the budget needs the space
+    void release(const string& key);
+
+    void setBudget(size_t budgetBytes);
+    size_t budget() const;
+    // evicts unreferenced textures until the resident size fits the budget
+    void trim();
+    // deletes every texture regardless of references; must run while the GL context is still alive
+    void clear();
+    const Stats& stats() const;
+
+private:
+    struct Entry {
+        unsigned int textureID;
+        size_t bytes;
+        int refCount;
+        list<string>::iterator lru;     //在 lruOrder 中的位置
+    };
+
+    Entry* find(const string& key);
+    void touch(Entry& entry);
+    void evict(const string& key);
+
+    size_t budgetBytes;
+    Stats counters;
+    unordered_map<string, Entry> entries;      //以 adopt 的键为键
+    list<string> lruOrder;              //最前面是最近使用的
+
+    TextureCache(const TextureCache&);
+    TextureCache& operator=(const TextureCache&);
+};
+
+#endif /* TextureCache_hpp */
@@ -0,0 +1,273 @@
+#include "TextureLoader.hpp"
+#include "CookedTexture.h"
+#include "ImageIO.hpp"
+#include "BlockCompression.hpp"
+#include "ImageArena.hpp"
+#include "GLExtensions.hpp"
+#include <unistd.h>
+#include <cstring>
+#include <vector>
+#include <iostream>
+
+//stb 解码时的所有内存分配都走当前线程的 arena，上传完一张贴图后整体重置
+#define STBI_MALLOC(sz)                     imageArenaAlloc(sz)
+#define STBI_REALLOC_SIZED(p,oldsz,newsz)   imageArenaRealloc(p,oldsz,newsz)
+#define STBI_FREE(p)                        imageArenaFree(p)
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+using namespace std;
+
+string cookedTexturePath(const char* path)
+{
+    string cooked(path);
+    size_t dot = cooked.find_last_of('.');
+    size_t slash = cooked.find_last_of('/');
+    if (dot != string::npos && (slash == string::npos || dot > slash))
+        cooked.erase(dot);
+    return cooked + ".ctex";
+}
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+int textureRoleChannels(TextureRole role)
+{
+    return role == TEXTURE_ROLE_SPECULAR ? 1 : 4;
+}
+
+GLenum textureRoleInternalFormat(TextureRole role, int channels)
+{
+    if (channels == 1)
+        return GL_R8;
+    if (role == TEXTURE_ROLE_DIFFUSE)
+        return channels == 3 ? GL_SRGB8 : GL_SRGB8_ALPHA8;
+    return channels == 3 ? GL_RGB8 : GL_RGBA8;
+}
+
+int fullMipLevelCount(int width, int height)
+{
+    int levels = 1;
+    for (int size = width > height ? width : height; size > 1; size /= 2)
+        levels++;
+    return levels;
+}
+
+size_t estimateTextureBytes(GLenum internalFormat, int width, int height, int levels)
+{
+    size_t total = 0;
+    for (int i = 0; i < levels; i++)
+    {
+        switch (internalFormat) {
+            case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+            case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+            case GL_COMPRESSED_RED_RGTC1:
+                total += bcImageSize(width, height);
+                break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+            case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+                total += bcImageSize(width, height, BC3_BLOCK_BYTES);
+                break;
+            case GL_RED:
+            case GL_R8:
+                total += (size_t)width * height;
+                break;
+            default:
+                total += (size_t)width * height * 4;
+                break;
+        }
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return total;
+}
+
+static unsigned int uploadImage(unsigned char* data, int width, int height, int nrComponents, TextureRole role, char const * path, TextureInfo* info);
+
+//BC4(RGTC) 从 GL 3.0 起是核心功能，BC1/BC3(S3TC) 需要扩展，sRGB 的 S3TC 还需要 EXT_texture_sRGB
+GLenum cookedCompressedInternalFormat(uint32_t format, bool srgb)
+{
+    if (format == CTEX_FORMAT_BC4)
+        return GL_COMPRESSED_RED_RGTC1;
+    if (!hasGLExtension("GL_EXT_texture_compression_s3tc") || (srgb && !hasGLExtension("GL_EXT_texture_sRGB")))
+        return 0;
+    if (format == CTEX_FORMAT_BC1)
+        return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    if (format == CTEX_FORMAT_BC3)
+        return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    return 0;
+}
+
+// utility function for loading a 2D texture from file
+// ---------------------------------------------------
+unsigned int loadTexture(char const * path, TextureInfo* info, TextureRole role)
+{
+    //优先使用离线烘焙好的贴图，省去 png 解码和运行时生成 mipmap
+    string cooked = cookedTexturePath(path);
+    if (access(cooked.c_str(), R_OK) == 0)
+    {
+        unsigned int cookedID = loadCookedTexture(cooked.c_str(), nullptr, info, role);
+        if (cookedID != 0)
+            return cookedID;
+    }
+
+    shared_ptr<MappedFile> file = mapImageFile(path);
+    if (!file->isOpen())
+        return uploadImage(NULL, 0, 0, 0, role, path, info);
+    return loadTextureFromMemory(file->data(), file->size(), path, info, role);
+}
+
+unsigned int loadTextureFromMemory(const unsigned char* bytes, size_t size, char const * name, TextureInfo* info, TextureRole role)
+{
+    //直接让 stb 输出用途需要的通道数，省掉上传时的格式转换
+    int width, height, nrComponents;
+    int channels = textureRoleChannels(role);
+    unsigned char *data = stbi_load_from_memory(bytes, (int)size, &width, &height, &nrComponents, channels);
+    return uploadImage(data, width, height, channels, role, name, info);
+}
+
+//把 stb_image 解码出的像素上传成带 mipmap 的 2D 纹理并释放像素，data 为空表示解码失败
+static unsigned int uploadImage(unsigned char* data, int width, int height, int nrComponents, TextureRole role, char const * path, TextureInfo* info)
+{
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    
+    if (data)
+    {
+        GLenum format = nrComponents == 1 ? GL_RED : GL_RGBA;
+        GLenum internalFormat = textureRoleInternalFormat(role, nrComponents);
+
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        // R8 rows are only 4-byte aligned when the width is a multiple of 4
+        if (nrComponents == 1 && width % 4 != 0)
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        stbi_image_free(data);
+        resetImageArena();
+        if (info)
+        {
+            info->width = width;
+            info->height = height;
+            info->levels = fullMipLevelCount(width, height);
+            info->bytes = estimateTextureBytes(internalFormat, width, height, info->levels);
+        }
+    }
+    else
+    {
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+        stbi_image_free(data);
+        resetImageArena();
+        if (info)
+        {
+            info->width = info->height = info->levels = 0;
+            info->bytes = 0;
+        }
+    }
+
+    return textureID;
+}
+
+unsigned int loadCookedTexture(char const * path, unsigned int* flags, TextureInfo* info, TextureRole role)
+{
+    shared_ptr<MappedFile> file = mapImageFile(path);
+    if (!file->isOpen())
+    {
+        cout << "ERROR::TEXTURE::INVALID_COOKED_TEXTURE: " << path << endl;
+        return 0;
+    }
+    return loadCookedTextureFromMemory(file->data(), file->size(), path, flags, info, role);
+}
+
+unsigned int loadCookedTextureFromMemory(const unsigned char* bytes, size_t size, char const * name, unsigned int* flags, TextureInfo* info, TextureRole)
+{
+    if (!validateCookedTexture(bytes, size))
+    {
+        cout << "ERROR::TEXTURE::INVALID_COOKED_TEXTURE: " << name << endl;
+        return 0;
+    }
+    const CookedTextureHeader* header = (const CookedTextureHeader*)bytes;
+    const CookedTextureLevel* levels = (const CookedTextureLevel*)(header + 1);
+    if (flags)
+        *flags = header->flags;
+
+    GLenum format;
+    if (cookedTextureChannels(header->format) == 1)
+        format = GL_RED;
+    else if (cookedTextureChannels(header->format) == 3)
+        format = GL_RGB;
+    else
+        format = GL_RGBA;
+
+    //颜色空间以文件里的 CTEX_FLAG_SRGB 为准：烘焙时按 sRGB 还是线性滤波的 mipmap，就要按同样的方式采样
+    bool srgb = (header->flags & CTEX_FLAG_SRGB) != 0 && cookedTextureChannels(header->format) != 1;
+    GLenum internalFormat;
+    if (cookedTextureChannels(header->format) == 1)
+        internalFormat = GL_R8;
+    else if (cookedTextureChannels(header->format) == 3)
+        internalFormat = srgb ? GL_SRGB8 : GL_RGB8;
+    else
+        internalFormat = srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+
+    //驱动不支持压缩格式时在 CPU 上解压后按未压缩格式上传
+    bool compressed = cookedTextureIsCompressed(header->format);
+    GLenum compressedFormat = compressed ? cookedCompressedInternalFormat(header->format, srgb) : 0;
+    bool uploadCompressed = compressedFormat != 0;
+
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    // levels are tightly packed, so RGB/R8 rows are not 4-byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    vector<unsigned char> decoded;
+    for (uint32_t i = 0; i < header->levelCount; i++)
+    {
+        const unsigned char* pixels = bytes + levels[i].offset;
+        if (uploadCompressed)
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, i, compressedFormat, levels[i].width, levels[i].height, 0, (GLsizei)levels[i].size, pixels);
+            continue;
+        }
+        if (compressed)
+        {
+            decoded.resize((size_t)levels[i].width * levels[i].height * cookedTextureChannels(header->format));
+            decompressCookedLevel(header->format, pixels, levels[i].width, levels[i].height, decoded.data());
+            pixels = decoded.data();
+        }
+        glTexImage2D(GL_TEXTURE_2D, i, internalFormat, levels[i].width, levels[i].height, 0, format, GL_UNSIGNED_BYTE, pixels);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, header->levelCount - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, header->levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    if (info)
+    {
+        info->width = (int)header->width;
+        info->height = (int)header->height;
+        info->levels = (int)header->levelCount;
+        info->bytes = estimateTextureBytes(uploadCompressed ? compressedFormat : internalFormat, info->width, info->height, info->levels);
+    }
+    return textureID;
+}
@@ -0,0 +1,49 @@
+#ifndef TextureLoader_hpp
+#define TextureLoader_hpp
+
+#include <glad/glad.h>
+#include <string>
+
+using namespace std;
+
+//上传后的贴图信息，用于估算显存占用
+struct TextureInfo {
+    int width;
+    int height;
+    int levels;         //mipmap 级数
+    size_t bytes;       //估算的显存字节数（包括所有 mipmap）
+};
+
+//贴图的用途，决定解码成几个通道以及用什么内部格式存储
+//  只解码需要的通道数，RGBA8 和 R8 的每一行都不需要驱动再重新打包成 4 字节对齐
+enum TextureRole {
+    TEXTURE_ROLE_DIFFUSE,       //颜色贴图：解码成 RGBA，按 sRGB 存储，采样时由硬件转换到线性空间
+    TEXTURE_ROLE_SPECULAR,      //强度贴图：只解码一个通道，线性存储
+    TEXTURE_ROLE_DATA           //法线等非颜色数据：解码成 RGBA，线性存储
+};
+
+int textureRoleChannels(TextureRole role);
+// internal format for an image of the given channel count (1, 3 or 4) used as role
+GLenum textureRoleInternalFormat(TextureRole role, int channels);
+
+// estimated VRAM for one layer of a texture; RGB8 is counted as 4 bytes since drivers pad it to RGBA
+size_t estimateTextureBytes(GLenum internalFormat, int width, int height, int levels);
+int fullMipLevelCount(int width, int height);
+// GL internal format for sampling a block-compressed CookedTextureFormat directly, or 0 when the driver lacks it
+GLenum cookedCompressedInternalFormat(uint32_t format, bool srgb);
+
+//烘焙贴图的路径：把原图扩展名换成 .ctex，例如 container2.png -> container2.ctex
+string cookedTexturePath(const char* path);
+
+// loads a 2D texture; prefers the pre-mipped .ctex next to the source image when one exists
+// info (optional) receives the size of what was uploaded
+unsigned int loadTexture(char const * path, TextureInfo* info = nullptr, TextureRole role = TEXTURE_ROLE_DIFFUSE);
+// uploads every mip level of a .ctex file straight from the mapped file, returns 0 on failure
+// flags (optional) receives the CookedTextureFlags stored in the file; the file's CTEX_FLAG_SRGB, not role, picks sRGB or linear storage
+unsigned int loadCookedTexture(char const * path, unsigned int* flags = nullptr, TextureInfo* info = nullptr, TextureRole role = TEXTURE_ROLE_DIFFUSE);
+
+// same as above for files the caller has already read or mapped; name is only used in error messages
+unsigned int loadTextureFromMemory(const unsigned char* bytes, size_t size, char const * name, TextureInfo* info = nullptr, TextureRole role = TEXTURE_ROLE_DIFFUSE);
+unsigned int loadCookedTextureFromMemory(const unsigned char* bytes, size_t size, char const * name, unsigned int* flags = nullptr, TextureInfo* info = nullptr, TextureRole role = TEXTURE_ROLE_DIFFUSE);
+
+#endif /* TextureLoader_hpp */
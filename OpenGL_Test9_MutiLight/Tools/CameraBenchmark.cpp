@@ -0,0 +1,185 @@
+//摄像机朝向更新基准测试：模拟一串高频鼠标事件(每帧若干个)，比较三种更新方式的开销
+//  euler        原来的做法：每个事件都用 cos/sin/radians 从偏航角和俯仰角重算 Front，再做三次 normalize
+//  quat/event   四元数增量旋转，但每个事件都立即更新向量
+//  quat/frame   四元数增量旋转，事件只累加，每帧 UpdateOrientation 一次(窗口模式的做法)
+//另外逐帧比较 euler 和 quat/frame 的 Front，最大夹角超过 0.01 度视为四元数路径出错，返回 1
+//
+//用法: CameraBenchmark [--frames N] [--events N] [--iterations N] [--seed N]
+//  --frames      模拟的帧数，默认 10000
+//  --events      每帧的鼠标事件数，默认 8(高回报率鼠标在 60Hz 下每帧可能有十几个)
+//  --iterations  每种方式重复的次数，默认 20，取最快的一次
+//  --seed        随机鼠标偏移用的种子，默认 1
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <glm/glm.hpp>
+
+#include "../Camera.hpp"
+
+using namespace std;
+using namespace glm;
+
+//原来 Camera::ProcessMouseMovement + updateCameraVectors 的做法，作为参照
+struct EulerCamera {
+    vec3 Front, Right, Up, WorldUp;
+    float Yaw, Pitch, MouseSensitivity;
+
+    EulerCamera() : WorldUp(0.0f, 1.0f, 0.0f), Yaw(YAW), Pitch(PITCH), MouseSensitivity(SENSITIVITY) { updateCameraVectors(); }
+
+    void ProcessMouseMovement(float xoffset, float yoffset)
+    {
+        Yaw += xoffset * MouseSensitivity;
+        Pitch += yoffset * MouseSensitivity;
+        Pitch = glm::min(89.0f, Pitch);
+        Pitch = glm::max(-89.0f, Pitch);
+        updateCameraVectors();
+    }
+
+    void updateCameraVectors()
+    {
+        vec3 front;
+        front.x = cos(radians(Yaw)) * cos(radians(Pitch));
+        front.y = sin(radians(Pitch));
+        front.z = sin(radians(Yaw)) * cos(radians(Pitch));
+        Front = normalize(front);
+        Right = normalize(cross(Front, WorldUp));
+        Up = normalize(cross(Right, Front));
+    }
+};
+
+struct MouseEvent {
+    float x, y;
+};
+
+//结果累加进这里，防止编译器把整个循环优化掉
+static volatile float sink;
+
+static double runEuler(const vector<MouseEvent>& events, int eventsPerFrame)
+{
+    EulerCamera camera;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    float total = 0.0f;
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        camera.ProcessMouseMovement(events[i].x, events[i].y);
+        if ((i + 1) % eventsPerFrame == 0)
+            total += camera.Front.x + camera.Right.z + camera.Up.y;
+    }
+    sink = total;
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static double runQuaternion(const vector<MouseEvent>& events, int eventsPerFrame, bool coalesce)
+{
+    Camera camera;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    float total = 0.0f;
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        camera.ProcessMouseMovement(events[i].x, events[i].y);
+        if (!coalesce)
+            camera.UpdateOrientation();
+        if ((i + 1) % eventsPerFrame == 0)
+        {
+            camera.UpdateOrientation();
+            total += camera.Front.x + camera.Right.z + camera.Up.y;
+        }
+    }
+    sink = total;
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+//逐帧比较两条路径的 Front，返回最大夹角(度)
+static float maxAngleError(const vector<MouseEvent>& events, int eventsPerFrame)
+{
+    EulerCamera euler;
+    Camera camera;
+    float error = 0.0f;
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        euler.ProcessMouseMovement(events[i].x, events[i].y);
+        camera.ProcessMouseMovement(events[i].x, events[i].y);
+        if ((i + 1) % eventsPerFrame != 0)
+            continue;
+        camera.UpdateOrientation();
+        //夹角很小时 acos 在 1 附近精度很差，用叉积长度和点积算
+        float angle = atan2f(length(cross(euler.Front, camera.Front)), dot(euler.Front, camera.Front));
+        error = glm::max(error, degrees(angle));
+    }
+    return error;
+}
+
+static void printUsage()
+{
+    cout << "usage: CameraBenchmark [--frames N] [--events N] [--iterations N] [--seed N]" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    int frames = 10000;
+    int eventsPerFrame = 8;
+    int iterations = 20;
+    unsigned int seed = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc)
+            frames = atoi(argv[++i]);
+        else if (arg == "--events" && i + 1 < argc)
+            eventsPerFrame = atoi(argv[++i]);
+        else if (arg == "--iterations" && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = (unsigned int)atoi(argv[++i]);
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+    if (frames < 1 || eventsPerFrame < 1 || iterations < 1)
+    {
+        printUsage();
+        return 1;
+    }
+
+    //每个事件几个像素，偶尔一次大幅甩动
+    mt19937 random(seed);
+    normal_distribution<float> offset(0.0f, 4.0f);
+    uniform_int_distribution<int> flick(0, 199);
+    vector<MouseEvent> events((size_t)frames * eventsPerFrame);
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        float scale = flick(random) == 0 ? 40.0f : 1.0f;
+        events[i].x = offset(random) * scale;
+        events[i].y = offset(random) * scale;
+    }
+
+    const char* labels[3] = { "euler", "quat/event", "quat/frame" };
+    double best[3] = { 1e30, 1e30, 1e30 };
+    for (int i = 0; i < iterations; i++)
+    {
+        best[0] = std::min(best[0], runEuler(events, eventsPerFrame));
+        best[1] = std::min(best[1], runQuaternion(events, eventsPerFrame, false));
+        best[2] = std::min(best[2], runQuaternion(events, eventsPerFrame, true));
+    }
+    cout << frames << " frames x " << eventsPerFrame << " mouse events, best of " << iterations << endl;
+    for (int i = 0; i < 3; i++)
+        printf("%-11s %8.3f ms  %7.2f ns/event  %7.2f ns/frame  %5.2fx\n", labels[i], best[i] * 1000.0, best[i] * 1e9 / events.size(),
+               best[i] * 1e9 / frames, best[0] / best[i]);
+
+    float error = maxAngleError(events, eventsPerFrame);
+    printf("max front error vs euler: %g degrees\n", error);
+    if (error > 0.01f)
+    {
+        cout << "ERROR::CAMERA_BENCHMARK::MISMATCH: quaternion orientation drifted from the Euler angles" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,156 @@
+//贴图解码基准测试：反复用 stb_image 从内存解码一组图片，统计每张图和总体的解码速度
+//文件先整体读进内存，计时只包括 stbi_load_from_memory，不包括磁盘 I/O
+//
+//用法: DecodeBenchmark [--iterations N] [--channels 0-4] [--scalar | --compare] <image> [image ...]
+//  --iterations  每张图解码的次数，默认 20，取最快的一次和平均值
+//  --channels    传给 stb 的 req_comp，默认 0（按文件里的通道数）；运行时漫反射贴图用 4，镜面反射贴图用 1
+//  --scalar      关闭 PNG 反滤波的 SIMD 路径
+//  --compare     标量和 SIMD 各跑一遍，打印两者的速度和加速比
+//速度按解码输出的字节数计算(MB/s)，同时给出输入文件的吞吐量
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../stb_image.h"
+
+using namespace std;
+
+struct BenchmarkFile {
+    string path;
+    vector<unsigned char> bytes;
+};
+
+struct BenchmarkResult {
+    double bestSeconds;
+    double totalSeconds;
+    size_t outputBytes;     //一次解码输出的字节数
+};
+
+static bool readFile(const string& path, vector<unsigned char>& bytes)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    bytes.resize(size > 0 ? (size_t)size : 0);
+    size_t read = bytes.empty() ? 0 : fread(bytes.data(), 1, bytes.size(), file);
+    fclose(file);
+    return read == bytes.size();
+}
+
+static bool decodeFile(const BenchmarkFile& file, int channels, int iterations, BenchmarkResult& result)
+{
+    result.bestSeconds = 1e30;
+    result.totalSeconds = 0.0;
+    result.outputBytes = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        int width, height, nrComponents;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        unsigned char* data = stbi_load_from_memory(file.bytes.data(), (int)file.bytes.size(), &width, &height, &nrComponents, channels);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (!data)
+        {
+            cout << "ERROR::DECODE_BENCHMARK::DECODE_FAILED: " << file.path << " (" << stbi_failure_reason() << ")" << endl;
+            return false;
+        }
+        stbi_image_free(data);
+        result.outputBytes = (size_t)width * height * (channels ? channels : nrComponents);
+        result.totalSeconds += seconds;
+        if (seconds < result.bestSeconds)
+            result.bestSeconds = seconds;
+    }
+    return true;
+}
+
+static double megabytesPerSecond(size_t bytes, double seconds)
+{
+    return seconds > 0.0 ? bytes / (1024.0 * 1024.0) / seconds : 0.0;
+}
+
+//跑一遍所有文件，返回所有文件最快一次解码的 MB/s 总和；失败返回负数
+static double runPass(const vector<BenchmarkFile>& files, int channels, int iterations, bool scalar, const char* label)
+{
+    stbi_png_disable_simd(scalar ? 1 : 0);
+    size_t totalOutput = 0, totalInput = 0;
+    double totalBest = 0.0;
+    cout << "-- " << label << endl;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        BenchmarkResult result;
+        if (!decodeFile(files[i], channels, iterations, result))
+            return -1.0;
+        totalOutput += result.outputBytes;
+        totalInput += files[i].bytes.size();
+        totalBest += result.bestSeconds;
+        printf("%-40s %8.3f ms best %8.3f ms mean %8.1f MB/s\n", files[i].path.c_str(), result.bestSeconds * 1000.0,
+               result.totalSeconds / iterations * 1000.0, megabytesPerSecond(result.outputBytes, result.bestSeconds));
+    }
+    double speed = megabytesPerSecond(totalOutput, totalBest);
+    printf("total: %.1f MB/s decoded, %.1f MB/s compressed input\n", speed, megabytesPerSecond(totalInput, totalBest));
+    return speed;
+}
+
+static void printUsage()
+{
+    cout << "usage: DecodeBenchmark [--iterations N] [--channels 0-4] [--scalar | --compare] <image> [image ...]" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = 20;
+    int channels = 0;
+    bool scalar = false;
+    bool compare = false;
+    vector<BenchmarkFile> files;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else if (arg == "--channels" && i + 1 < argc)
+            channels = atoi(argv[++i]);
+        else if (arg == "--scalar")
+            scalar = true;
+        else if (arg == "--compare")
+            compare = true;
+        else if (arg.size() > 1 && arg[0] == '-')
+        {
+            printUsage();
+            return 1;
+        }
+        else
+        {
+            BenchmarkFile file;
+            file.path = arg;
+            if (!readFile(arg, file.bytes))
+            {
+                cout << "ERROR::DECODE_BENCHMARK::FILE_NOT_READ: " << arg << endl;
+                return 1;
+            }
+            files.push_back(file);
+        }
+    }
+    if (files.empty() || iterations < 1 || channels < 0 || channels > 4)
+    {
+        printUsage();
+        return 1;
+    }
+
+    if (!compare)
+        return runPass(files, channels, iterations, scalar, scalar ? "scalar unfilter" : "default") < 0.0 ? 1 : 0;
+
+    double scalarSpeed = runPass(files, channels, iterations, true, "scalar unfilter");
+    double simdSpeed = runPass(files, channels, iterations, false, "SIMD unfilter");
+    if (scalarSpeed < 0.0 || simdSpeed < 0.0)
+        return 1;
+    printf("speedup: %.2fx\n", simdSpeed / scalarSpeed);
+    return 0;
+}
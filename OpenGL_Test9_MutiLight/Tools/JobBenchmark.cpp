@@ -0,0 +1,210 @@
+//任务系统压力测试：一帧的 CPU 工作(所有物体的模型/法线矩阵 + 包围球 + 视锥剔除)交给 JobSystem，
+//线程数从 1 开始每次翻倍到 --max-threads，看耗时是否随线程数近似线性下降
+//每一轮都和单线程的结果比较：矩阵逐字节相同、可见物体的数量和顺序相同，否则返回 1
+//
+//用法: JobBenchmark [--count N] [--iterations N] [--grain N] [--max-threads N] [--seed N]
+//  --count        物体数量，默认 1000000
+//  --iterations   每个线程数重复的帧数，默认 20，取最快的一次和平均值
+//  --grain        parallelFor 拆到多小为止(物体数)，默认 2048
+//  --max-threads  最多用多少个线程(含调用线程)，默认硬件线程数
+//  --seed         随机摆放用的种子，默认 1
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../JobSystem.hpp"
+#include "../TransformBatch.hpp"
+#include "../FrustumCulling.h"
+
+using namespace std;
+using namespace glm;
+
+//与 LightingScene 的实例结构一样，模型矩阵后面紧跟法线矩阵
+struct Instance {
+    mat4 model;
+    mat3 normalMatrix;
+    float layer;
+};
+
+struct FrameOutput {
+    vector<Instance> instances;
+    vector<vec4> bounds;
+    vector<unsigned char> visible;
+    vector<size_t> chunkOffsets;
+    vector<Instance> visibleInstances;
+};
+
+struct BenchmarkResult {
+    double bestSeconds;
+    double totalSeconds;
+};
+
+static const size_t CULL_CHUNK = 2048;
+
+//和 LightingScene::updateSceneCache + buildPacket 一样的拆法：矩阵按 8 个一组，剔除分块计数、前缀和、再拷贝
+static void runFrame(JobSystem& jobs, const TransformBatch& batch, const vec4 planes[6], size_t grain, FrameOutput& output)
+{
+    size_t count = batch.size();
+    Instance* instances = &output.instances[0];
+    jobs.parallelFor((count + 7) / 8, std::max<size_t>(1, grain / 8), [&](size_t begin, size_t end) {
+        batch.computeMatrices(begin * 8, end * 8, &instances[0].model, sizeof(Instance), &instances[0].normalMatrix, sizeof(Instance));
+    });
+    jobs.parallelFor(count, grain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            output.bounds[i] = boundingSphere(instances[i].model);
+    });
+
+    size_t chunks = (count + CULL_CHUNK - 1) / CULL_CHUNK;
+    output.chunkOffsets.resize(chunks + 1);
+    jobs.parallelFor(chunks, 1, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; chunk++)
+        {
+            size_t visible = 0;
+            for (size_t i = chunk * CULL_CHUNK; i < std::min(count, (chunk + 1) * CULL_CHUNK); i++)
+            {
+                output.visible[i] = sphereVisible(planes, output.bounds[i]);
+                visible += output.visible[i];
+            }
+            output.chunkOffsets[chunk + 1] = visible;
+        }
+    });
+    output.chunkOffsets[0] = 0;
+    for (size_t chunk = 0; chunk < chunks; chunk++)
+        output.chunkOffsets[chunk + 1] += output.chunkOffsets[chunk];
+    output.visibleInstances.resize(output.chunkOffsets[chunks]);
+    jobs.parallelFor(chunks, 1, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; chunk++)
+        {
+            size_t out = output.chunkOffsets[chunk];
+            for (size_t i = chunk * CULL_CHUNK; i < std::min(count, (chunk + 1) * CULL_CHUNK); i++)
+                if (output.visible[i])
+                    output.visibleInstances[out++] = instances[i];
+        }
+    });
+}
+
+static bool sameOutput(const FrameOutput& a, const FrameOutput& b)
+{
+    return a.visibleInstances.size() == b.visibleInstances.size()
+        && memcmp(a.instances.data(), b.instances.data(), a.instances.size() * sizeof(Instance)) == 0
+        && memcmp(a.visibleInstances.data(), b.visibleInstances.data(), a.visibleInstances.size() * sizeof(Instance)) == 0;
+}
+
+static void printUsage()
+{
+    cout << "usage: JobBenchmark [--count N] [--iterations N] [--grain N] [--max-threads N] [--seed N]" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    int count = 1000000;
+    int iterations = 20;
+    int grain = 2048;
+    int maxThreads = (int)thread::hardware_concurrency();
+    unsigned int seed = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--count" && i + 1 < argc)
+            count = atoi(argv[++i]);
+        else if (arg == "--iterations" && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else if (arg == "--grain" && i + 1 < argc)
+            grain = atoi(argv[++i]);
+        else if (arg == "--max-threads" && i + 1 < argc)
+            maxThreads = atoi(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = (unsigned int)atoi(argv[++i]);
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+    if (maxThreads < 1)
+        maxThreads = 1;
+    if (count < 1 || iterations < 1 || grain < 1)
+    {
+        printUsage();
+        return 1;
+    }
+
+    //随机摆放：位置在 ±100 的立方体里，任意旋转轴和角度，非均匀缩放 0.2~3
+    mt19937 random(seed);
+    uniform_real_distribution<float> position(-100.0f, 100.0f);
+    uniform_real_distribution<float> axis(-1.0f, 1.0f);
+    uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    uniform_real_distribution<float> scaling(0.2f, 3.0f);
+    TransformBatch batch;
+    for (int i = 0; i < count; i++)
+    {
+        vec3 rotationAxis;
+        do
+            rotationAxis = vec3(axis(random), axis(random), axis(random));
+        while (dot(rotationAxis, rotationAxis) < 0.01f);
+        batch.add(vec3(position(random), position(random), position(random)), normalize(rotationAxis), angle(random),
+                  vec3(scaling(random), scaling(random), scaling(random)));
+    }
+
+    //摄像机在原点朝 -z 看，视野 45 度，远平面 100，大约六分之一的物体可见
+    mat4 projection = perspective(radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    mat4 view = lookAt(vec3(0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f));
+    vec4 planes[6];
+    frustumPlanes(projection * view, planes);
+
+    FrameOutput reference, output;
+    for (FrameOutput* frame : { &reference, &output })
+    {
+        frame->instances.resize(count);
+        frame->bounds.resize(count);
+        frame->visible.resize(count);
+    }
+    {
+        JobSystem serial;
+        runFrame(serial, batch, planes, grain, reference);
+    }
+    cout << count << " objects, " << reference.visibleInstances.size() << " visible, grain " << grain << ", "
+         << iterations << " iterations, up to " << maxThreads << " thread(s)" << endl;
+
+    double baseline = 0.0;
+    for (int threads = 1; ; threads = std::min(threads * 2, maxThreads))
+    {
+        JobSystem jobs;
+        jobs.start(threads - 1);
+        runFrame(jobs, batch, planes, grain, output);       //预热：让工作线程都跑起来
+        BenchmarkResult result = { 1e30, 0.0 };
+        for (int i = 0; i < iterations; i++)
+        {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            runFrame(jobs, batch, planes, grain, output);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            result.totalSeconds += seconds;
+            result.bestSeconds = std::min(result.bestSeconds, seconds);
+        }
+        jobs.stop();
+        if (threads == 1)
+            baseline = result.bestSeconds;
+        double speedup = baseline / result.bestSeconds;
+        printf("%3d thread(s) %8.3f ms best %8.3f ms mean  speedup %5.2fx  efficiency %5.1f%%\n", threads, result.bestSeconds * 1000.0,
+               result.totalSeconds / iterations * 1000.0, speedup, speedup / threads * 100.0);
+        if (!sameOutput(reference, output))
+        {
+            cout << "ERROR::JOB_BENCHMARK::MISMATCH: " << threads << " thread(s) produced a different frame than the serial run" << endl;
+            return 1;
+        }
+        if (threads == maxThreads)
+            break;
+    }
+    return 0;
+}
@@ -0,0 +1,373 @@
+//场景转换工具：把文本场景(.scene)转换成二进制场景(.scnb，格式见 SceneFormat.h)
+//运行时只需 mmap + 改写几个指针，不再解析文本；写完之后用运行时的加载代码读一遍，确认文件可以直接使用
+//
+//用法: SceneConverter <input.scene> [output.scnb]
+//输出文件名默认把输入的扩展名换成 .scnb
+//
+//文本格式：每行一条指令，# 之后是注释，名字不能含空白
+//  mesh NAME cube                  内置的单位立方体(SceneData 的 cubeVertices)
+//  mesh NAME                       自定义网格，后面跟若干行 "v px py pz nx ny nz u v"，以 "end" 结束，顶点数是 3 的倍数
+//  material NAME DIFFUSE SPECULAR  漫反射和镜面反射贴图，路径相对运行时的 --texture-dir
+//  instance MESH MATERIAL px py pz ax ay az DEGREES [sx sy sz]
+//                                  被照亮的物体：先缩放，再绕 (ax, ay, az) 转 DEGREES 度，再平移到 (px, py, pz)
+//  light px py pz [ambient r g b] [diffuse r g b] [specular r g b] [attenuation c l q] [lamp MESH SCALE]
+//                                  点光源，没给的参数与默认场景的灯相同；lamp 在光源位置画一个纯白的灯泡
+//  scatter COUNT MESH MATERIAL SEED
+//                                  在场景后方随机摆放 COUNT 个物体，用来生成大场景
+
+#include "../SceneFormat.h"
+#include "../SceneFile.hpp"
+#include "../SceneData.hpp"
+#include "../SceneStore.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <iostream>
+
+using namespace std;
+using namespace glm;
+
+struct TextMesh {
+    string name;
+    vector<float> vertices;
+};
+
+struct TextMaterial {
+    string name;
+    string diffusePath;
+    string specularPath;
+};
+
+struct TextScene {
+    vector<TextMesh> meshes;
+    vector<TextMaterial> materials;
+    vector<SceneFileInstance> instances;
+    vector<SceneFileLight> lights;
+    unordered_map<string, uint32_t> meshIndices;
+    unordered_map<string, uint32_t> materialIndices;
+};
+
+static bool parseError(const string& path, int line, const string& message)
+{
+    cout << "ERROR::SCENE_CONVERTER::PARSE: " << path << ":" << line << ": " << message << endl;
+    return false;
+}
+
+static bool readFloats(istringstream& tokens, float* values, int count)
+{
+    for (int i = 0; i < count; i++)
+        if (!(tokens >> values[i]))
+            return false;
+    return true;
+}
+
+static void setVec3(float* out, const vec3& v)
+{
+    out[0] = v.x;
+    out[1] = v.y;
+    out[2] = v.z;
+}
+
+static bool lookup(const unordered_map<string, uint32_t>& indices, const string& name, uint32_t& index)
+{
+    unordered_map<string, uint32_t>::const_iterator it = indices.find(name);
+    if (it == indices.end())
+        return false;
+    index = it->second;
+    return true;
+}
+
+static bool parseScene(const string& path, TextScene& scene)
+{
+    ifstream input(path.c_str());
+    if (!input)
+    {
+        cout << "ERROR::SCENE_CONVERTER::FILE_NOT_READ: " << path << endl;
+        return false;
+    }
+    string text;
+    int lineNumber = 0;
+    TextMesh* openMesh = nullptr;       //正在读顶点的自定义网格
+    while (getline(input, text))
+    {
+        lineNumber++;
+        size_t comment = text.find('#');
+        if (comment != string::npos)
+            text.erase(comment);
+        istringstream tokens(text);
+        string command;
+        if (!(tokens >> command))
+            continue;
+
+        if (openMesh)
+        {
+            if (command == "end")
+            {
+                if (openMesh->vertices.empty() || openMesh->vertices.size() % (3 * SCENE_VERTEX_STRIDE) != 0)
+                    return parseError(path, lineNumber, "mesh " + openMesh->name + " needs a multiple of 3 vertices");
+                openMesh = nullptr;
+            }
+            else if (command == "v")
+            {
+                float vertex[SCENE_VERTEX_STRIDE];
+                if (!readFloats(tokens, vertex, SCENE_VERTEX_STRIDE))
+                    return parseError(path, lineNumber, "expected v px py pz nx ny nz u v");
+                openMesh->vertices.insert(openMesh->vertices.end(), vertex, vertex + SCENE_VERTEX_STRIDE);
+            }
+            else
+                return parseError(path, lineNumber, "expected v or end inside mesh " + openMesh->name);
+            continue;
+        }
+
+        if (command == "mesh")
+        {
+            TextMesh mesh;
+            string source;
+            if (!(tokens >> mesh.name))
+                return parseError(path, lineNumber, "expected mesh NAME [cube]");
+            if (scene.meshIndices.count(mesh.name))
+                return parseError(path, lineNumber, "mesh " + mesh.name + " is defined twice");
+            bool builtin = (bool)(tokens >> source);
+            if (builtin && source != "cube")
+                return parseError(path, lineNumber, "unknown built-in mesh " + source);
+            if (builtin)
+                mesh.vertices.assign(cubeVertices, cubeVertices + CUBE_VERTEX_COUNT * CUBE_VERTEX_STRIDE);
+            scene.meshIndices[mesh.name] = (uint32_t)scene.meshes.size();
+            scene.meshes.push_back(mesh);
+            if (!builtin)
+                openMesh = &scene.meshes.back();
+        }
+        else if (command == "material")
+        {
+            TextMaterial material;
+            if (!(tokens >> material.name >> material.diffusePath >> material.specularPath))
+                return parseError(path, lineNumber, "expected material NAME DIFFUSE SPECULAR");
+            if (scene.materialIndices.count(material.name))
+                return parseError(path, lineNumber, "material " + material.name + " is defined twice");
+            scene.materialIndices[material.name] = (uint32_t)scene.materials.size();
+            scene.materials.push_back(material);
+        }
+        else if (command == "instance")
+        {
+            SceneFileInstance instance;
+            string mesh, material;
+            float degrees;
+            if (!(tokens >> mesh >> material) || !readFloats(tokens, instance.position, 3) || !readFloats(tokens, instance.axis, 3)
+                || !(tokens >> degrees))
+                return parseError(path, lineNumber, "expected instance MESH MATERIAL px py pz ax ay az DEGREES [sx sy sz]");
+            if (!lookup(scene.meshIndices, mesh, instance.mesh))
+                return parseError(path, lineNumber, "unknown mesh " + mesh);
+            if (!lookup(scene.materialIndices, material, instance.material))
+                return parseError(path, lineNumber, "unknown material " + material);
+            instance.angle = radians(degrees);
+            if (!readFloats(tokens, instance.scale, 3))
+                instance.scale[0] = instance.scale[1] = instance.scale[2] = 1.0f;
+            scene.instances.push_back(instance);
+        }
+        else if (command == "light")
+        {
+            SceneFileLight light;
+            if (!readFloats(tokens, light.position, 3))
+                return parseError(path, lineNumber, "expected light px py pz [options]");
+            PointLight defaults = defaultPointLight(make_vec3(light.position));
+            setVec3(light.ambient, defaults.ambient);
+            setVec3(light.diffuse, defaults.diffuse);
+            setVec3(light.specular, defaults.specular);
+            light.constant = defaults.constant;
+            light.linear = defaults.linear;
+            light.quadratic = defaults.quadratic;
+            light.lampMesh = SCENE_NO_LAMP;
+            light.lampScale = 0.0f;
+            string option;
+            while (tokens >> option)
+            {
+                bool ok;
+                if (option == "ambient")
+                    ok = readFloats(tokens, light.ambient, 3);
+                else if (option == "diffuse")
+                    ok = readFloats(tokens, light.diffuse, 3);
+                else if (option == "specular")
+                    ok = readFloats(tokens, light.specular, 3);
+                else if (option == "attenuation")
+                    ok = (bool)(tokens >> light.constant >> light.linear >> light.quadratic);
+                else if (option == "lamp")
+                {
+                    string mesh;
+                    ok = (bool)(tokens >> mesh >> light.lampScale);
+                    if (ok && !lookup(scene.meshIndices, mesh, light.lampMesh))
+                        return parseError(path, lineNumber, "unknown mesh " + mesh);
+                }
+                else
+                    return parseError(path, lineNumber, "unknown light option " + option);
+                if (!ok)
+                    return parseError(path, lineNumber, "missing values after " + option);
+            }
+            scene.lights.push_back(light);
+        }
+        else if (command == "scatter")
+        {
+            int count;
+            unsigned int seed;
+            string mesh, material;
+            SceneFileInstance instance;
+            if (!(tokens >> count >> mesh >> material >> seed) || count < 0)
+                return parseError(path, lineNumber, "expected scatter COUNT MESH MATERIAL SEED");
+            if (!lookup(scene.meshIndices, mesh, instance.mesh))
+                return parseError(path, lineNumber, "unknown mesh " + mesh);
+            if (!lookup(scene.materialIndices, material, instance.material))
+                return parseError(path, lineNumber, "unknown material " + material);
+            //与 scatterContainers 相同的分布：数量越多范围越大，密度大致不变
+            mt19937 random(seed);
+            float extent = 10.0f + 2.0f * cbrtf((float)count);
+            uniform_real_distribution<float> side(-extent, extent);
+            uniform_real_distribution<float> depth(-3.0f - 2.0f * extent, -3.0f);
+            uniform_real_distribution<float> axis(-1.0f, 1.0f);
+            uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+            for (int i = 0; i < count; i++)
+            {
+                instance.position[0] = side(random);
+                instance.position[1] = side(random);
+                instance.position[2] = depth(random);
+                for (int c = 0; c < 3; c++)
+                    instance.axis[c] = axis(random);
+                instance.angle = angle(random);
+                instance.scale[0] = instance.scale[1] = instance.scale[2] = 1.0f;
+                scene.instances.push_back(instance);
+            }
+        }
+        else
+            return parseError(path, lineNumber, "unknown command " + command);
+    }
+    if (openMesh)
+        return parseError(path, lineNumber, "mesh " + openMesh->name + " is missing end");
+    return true;
+}
+
+static size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static uint64_t appendString(vector<unsigned char>& bytes, const string& text)
+{
+    uint64_t offset = bytes.size();
+    bytes.insert(bytes.end(), text.begin(), text.end());
+    bytes.push_back(0);
+    return offset;
+}
+
+static bool writeScene(const TextScene& scene, const string& path)
+{
+    //各张表紧跟在文件头后面，然后是顶点数据，最后是字符串表
+    size_t meshOffset = alignUp(sizeof(SceneFileHeader), 8);
+    size_t materialOffset = alignUp(meshOffset + scene.meshes.size() * sizeof(SceneFileMesh), 8);
+    size_t instanceOffset = alignUp(materialOffset + scene.materials.size() * sizeof(SceneFileMaterial), 8);
+    size_t lightOffset = alignUp(instanceOffset + scene.instances.size() * sizeof(SceneFileInstance), 8);
+    size_t end = lightOffset + scene.lights.size() * sizeof(SceneFileLight);
+    vector<size_t> vertexOffsets;
+    for (size_t i = 0; i < scene.meshes.size(); i++)
+    {
+        end = alignUp(end, SCENE_DATA_ALIGNMENT);
+        vertexOffsets.push_back(end);
+        end += scene.meshes[i].vertices.size() * sizeof(float);
+    }
+    vector<unsigned char> bytes(end, 0);
+
+    vector<SceneFileMesh> meshes(scene.meshes.size());
+    for (size_t i = 0; i < scene.meshes.size(); i++)
+    {
+        memcpy(&bytes[vertexOffsets[i]], scene.meshes[i].vertices.data(), scene.meshes[i].vertices.size() * sizeof(float));
+        meshes[i].name.offset = appendString(bytes, scene.meshes[i].name);
+        meshes[i].vertices.offset = vertexOffsets[i];
+        meshes[i].vertexCount = (uint32_t)(scene.meshes[i].vertices.size() / SCENE_VERTEX_STRIDE);
+        meshes[i].reserved = 0;
+    }
+    vector<SceneFileMaterial> materials(scene.materials.size());
+    for (size_t i = 0; i < scene.materials.size(); i++)
+    {
+        materials[i].name.offset = appendString(bytes, scene.materials[i].name);
+        materials[i].diffusePath.offset = appendString(bytes, scene.materials[i].diffusePath);
+        materials[i].specularPath.offset = appendString(bytes, scene.materials[i].specularPath);
+    }
+
+    SceneFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "SCNB", 4);
+    header.version = SCENE_FILE_VERSION;
+    header.fileSize = bytes.size();
+    header.meshCount = (uint32_t)scene.meshes.size();
+    header.materialCount = (uint32_t)scene.materials.size();
+    header.instanceCount = (uint32_t)scene.instances.size();
+    header.lightCount = (uint32_t)scene.lights.size();
+    header.meshes.offset = meshOffset;
+    header.materials.offset = materialOffset;
+    header.instances.offset = instanceOffset;
+    header.lights.offset = lightOffset;
+    memcpy(&bytes[0], &header, sizeof(header));
+    if (!meshes.empty())
+        memcpy(&bytes[meshOffset], meshes.data(), meshes.size() * sizeof(SceneFileMesh));
+    if (!materials.empty())
+        memcpy(&bytes[materialOffset], materials.data(), materials.size() * sizeof(SceneFileMaterial));
+    if (!scene.instances.empty())
+        memcpy(&bytes[instanceOffset], scene.instances.data(), scene.instances.size() * sizeof(SceneFileInstance));
+    if (!scene.lights.empty())
+        memcpy(&bytes[lightOffset], scene.lights.data(), scene.lights.size() * sizeof(SceneFileLight));
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        cout << "ERROR::SCENE_CONVERTER::FILE_NOT_WRITTEN: " << path << endl;
+        return false;
+    }
+    size_t written = fwrite(bytes.data(), 1, bytes.size(), file);
+    bool ok = fclose(file) == 0 && written == bytes.size();
+    if (!ok)
+        cout << "ERROR::SCENE_CONVERTER::FILE_NOT_WRITTEN: " << path << endl;
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3 || argv[1][0] == '-')
+    {
+        cout << "usage: SceneConverter <input.scene> [output.scnb]" << endl;
+        return 1;
+    }
+    string inputPath = argv[1];
+    string outputPath;
+    if (argc == 3)
+        outputPath = argv[2];
+    else
+    {
+        size_t dot = inputPath.find_last_of('.');
+        size_t slash = inputPath.find_last_of('/');
+        outputPath = (dot != string::npos && (slash == string::npos || dot > slash) ? inputPath.substr(0, dot) : inputPath) + ".scnb";
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    TextScene scene;
+    if (!parseScene(inputPath, scene))
+        return 1;
+    double parseMilliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    if (!writeScene(scene, outputPath))
+        return 1;
+
+    //用运行时的代码加载一遍：检查、改写指针、填进 SceneStore
+    SceneFile loaded;
+    if (!loaded.load(outputPath))
+        return 1;
+    SceneStore store;
+    loaded.populate(store);
+    printf("%s: %zu meshes, %zu materials, %zu instances, %zu lights, parsed in %.3f ms\n", inputPath.c_str(), scene.meshes.size(),
+           scene.materials.size(), scene.instances.size(), scene.lights.size(), parseMilliseconds);
+    printf("%s: %zu KB, mapped in %.3f ms, %zu entities\n", outputPath.c_str(), loaded.fileSize() / 1024, loaded.loadMilliseconds(),
+           store.entityCount());
+    return 0;
+}
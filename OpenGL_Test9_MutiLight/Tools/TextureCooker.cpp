@@ -0,0 +1,392 @@
+//离线贴图烘焙工具：把 png/jpg 等源图转换成 .ctex 文件
+//所有 mipmap 级别在这里预先算好并紧密排列，运行时只需 mmap + glTexImage2D，不再解码也不再 glGenerateMipmap
+//
+//用法: TextureCooker [--srgb | --linear] [--filter box|kaiser] [--compress] [--pack <specular image>] <input image> [output.ctex]
+//  --srgb      颜色通道按 sRGB 处理，先转换到线性空间再滤波（漫反射贴图）
+//  --linear    数据本身就是线性的（镜面反射贴图等），默认值
+//  --filter    下采样滤波器，box 为 2x2 平均，kaiser 为 Kaiser 窗 sinc，更锐利
+//  --compress  RGB 图压缩成 BC1，RGBA 图（包括 --pack 的材质贴图）压缩成 BC3，单通道图压缩成 BC4，并打印每一级的 PSNR
+//  --pack      把镜面反射贴图的强度放进输入漫反射贴图的 alpha 通道，输出一张 RGBA 材质贴图
+//              运行时的材质数组按 sRGB 存储，所以要和 --srgb 一起用，否则运行时忽略这个文件、退回原图
+
+#include "../CookedTexture.h"
+#include "../BlockCompression.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../stb_image.h"
+
+using namespace std;
+
+enum MipFilter {
+    FILTER_BOX,
+    FILTER_KAISER
+};
+
+struct FloatImage {
+    int width;
+    int height;
+    int channels;
+    vector<float> texels;
+};
+
+static float srgbToLinear(float c)
+{
+    return c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static float linearToSrgb(float c)
+{
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+}
+
+//alpha 通道永远是线性的，只有颜色通道需要做 gamma 转换
+static bool isColorChannel(int channel, int channels, bool srgb)
+{
+    if (!srgb)
+        return false;
+    return channels < 3 || channel < 3;
+}
+
+static FloatImage toFloat(const unsigned char* data, int width, int height, int channels, bool srgb)
+{
+    float lut[256];
+    for (int i = 0; i < 256; i++)
+        lut[i] = srgbToLinear(i / 255.0f);
+
+    FloatImage image = { width, height, channels, vector<float>((size_t)width * height * channels) };
+    for (size_t i = 0; i < image.texels.size(); i++)
+    {
+        int c = (int)(i % channels);
+        image.texels[i] = isColorChannel(c, channels, srgb) ? lut[data[i]] : data[i] / 255.0f;
+    }
+    return image;
+}
+
+static void toBytes(const FloatImage& image, bool srgb, vector<unsigned char>& out)
+{
+    out.resize(image.texels.size());
+    for (size_t i = 0; i < image.texels.size(); i++)
+    {
+        int c = (int)(i % image.channels);
+        float v = image.texels[i];
+        v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+        if (isColorChannel(c, image.channels, srgb))
+            v = linearToSrgb(v);
+        out[i] = (unsigned char)(v * 255.0f + 0.5f);
+    }
+}
+
+static FloatImage downsampleBox(const FloatImage& src)
+{
+    int w = max(1, src.width / 2);
+    int h = max(1, src.height / 2);
+    FloatImage dst = { w, h, src.channels, vector<float>((size_t)w * h * src.channels) };
+    for (int y = 0; y < h; y++)
+    {
+        int y0 = min(2 * y, src.height - 1);
+        int y1 = min(2 * y + 1, src.height - 1);
+        for (int x = 0; x < w; x++)
+        {
+            int x0 = min(2 * x, src.width - 1);
+            int x1 = min(2 * x + 1, src.width - 1);
+            for (int c = 0; c < src.channels; c++)
+            {
+                float sum = src.texels[((size_t)y0 * src.width + x0) * src.channels + c]
+                          + src.texels[((size_t)y0 * src.width + x1) * src.channels + c]
+                          + src.texels[((size_t)y1 * src.width + x0) * src.channels + c]
+                          + src.texels[((size_t)y1 * src.width + x1) * src.channels + c];
+                dst.texels[((size_t)y * w + x) * src.channels + c] = sum * 0.25f;
+            }
+        }
+    }
+    return dst;
+}
+
+//第一类零阶修正贝塞尔函数，用级数展开计算
+static double besselI0(double x)
+{
+    double sum = 1.0, term = 1.0, q = x * x * 0.25;
+    for (int k = 1; k < 32; k++)
+    {
+        term *= q / (k * k);
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+// Kaiser-windowed sinc, x measured in destination texels
+static float kaiserWeight(float x, float radius, float alpha)
+{
+    if (fabsf(x) >= radius)
+        return 0.0f;
+    float sinc = x == 0.0f ? 1.0f : sinf((float)M_PI * x) / ((float)M_PI * x);
+    float t = x / radius;
+    float window = (float)(besselI0(alpha * sqrt(1.0 - t * t)) / besselI0(alpha));
+    return sinc * window;
+}
+
+//可分离的 Kaiser 滤波：先水平方向减半，再垂直方向减半
+static FloatImage downsampleKaiser1D(const FloatImage& src, bool horizontal)
+{
+    const float radius = 3.0f;
+    const float alpha = 4.0f;
+    int w = horizontal ? max(1, src.width / 2) : src.width;
+    int h = horizontal ? src.height : max(1, src.height / 2);
+    int srcLen = horizontal ? src.width : src.height;
+    int dstLen = horizontal ? w : h;
+    FloatImage dst = { w, h, src.channels, vector<float>((size_t)w * h * src.channels) };
+
+    if (srcLen == 1)
+    {
+        dst.texels = src.texels;
+        return dst;
+    }
+
+    // every destination position uses the same tap pattern, so precompute the weights once per position
+    int taps = (int)(radius * 4.0f) + 2;
+    vector<int> tapIndex((size_t)dstLen * taps);
+    vector<float> tapWeight((size_t)dstLen * taps);
+    for (int d = 0; d < dstLen; d++)
+    {
+        float center = (d + 0.5f) * 2.0f;
+        int first = (int)floorf(center - radius * 2.0f);
+        float total = 0.0f;
+        for (int t = 0; t < taps; t++)
+        {
+            int s = first + t;
+            float weight = kaiserWeight((s + 0.5f - center) * 0.5f, radius, alpha);
+            tapIndex[(size_t)d * taps + t] = min(max(s, 0), srcLen - 1);
+            tapWeight[(size_t)d * taps + t] = weight;
+            total += weight;
+        }
+        for (int t = 0; t < taps; t++)
+            tapWeight[(size_t)d * taps + t] /= total;
+    }
+
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            int d = horizontal ? x : y;
+            for (int c = 0; c < src.channels; c++)
+            {
+                float sum = 0.0f;
+                for (int t = 0; t < taps; t++)
+                {
+                    int s = tapIndex[(size_t)d * taps + t];
+                    size_t index = horizontal ? ((size_t)y * src.width + s) : ((size_t)s * src.width + x);
+                    sum += src.texels[index * src.channels + c] * tapWeight[(size_t)d * taps + t];
+                }
+                dst.texels[((size_t)y * w + x) * src.channels + c] = sum;
+            }
+        }
+    }
+    return dst;
+}
+
+static FloatImage downsample(const FloatImage& src, MipFilter filter)
+{
+    if (filter == FILTER_KAISER)
+        return downsampleKaiser1D(downsampleKaiser1D(src, true), false);
+    return downsampleBox(src);
+}
+
+static void printUsage()
+{
+    cout << "usage: TextureCooker [--srgb | --linear] [--filter box|kaiser] [--compress] [--pack <specular image>] <input image> [output.ctex]" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    bool srgb = false;
+    bool compress = false;
+    MipFilter filter = FILTER_BOX;
+    const char* input = NULL;
+    const char* packSpecular = NULL;
+    const char* output = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--srgb")
+            srgb = true;
+        else if (arg == "--linear")
+            srgb = false;
+        else if (arg == "--compress")
+            compress = true;
+        else if (arg == "--pack" && i + 1 < argc)
+            packSpecular = argv[++i];
+        else if (arg == "--filter" && i + 1 < argc)
+        {
+            string name = argv[++i];
+            if (name == "box")
+                filter = FILTER_BOX;
+            else if (name == "kaiser")
+                filter = FILTER_KAISER;
+            else
+            {
+                printUsage();
+                return 1;
+            }
+        }
+        else if (!input)
+            input = argv[i];
+        else if (!output)
+            output = argv[i];
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+    if (!input)
+    {
+        printUsage();
+        return 1;
+    }
+
+    string outputPath;
+    if (output)
+        outputPath = output;
+    else
+    {
+        outputPath = input;
+        size_t dot = outputPath.find_last_of('.');
+        size_t slash = outputPath.find_last_of('/');
+        if (dot != string::npos && (slash == string::npos || dot > slash))
+            outputPath.erase(dot);
+        outputPath += ".ctex";
+    }
+
+    int width, height, nrComponents;
+    if (!stbi_info(input, &width, &height, &nrComponents))
+    {
+        cout << "ERROR::COOKER::FAILED_TO_LOAD: " << input << " (" << stbi_failure_reason() << ")" << endl;
+        return 1;
+    }
+    //双通道(灰度+alpha)在 GL 里没有对应的常用格式，扩展成 RGBA
+    int channels = nrComponents == 2 ? 4 : nrComponents;
+    if (packSpecular)
+        channels = 3;
+    unsigned char* data = stbi_load(input, &width, &height, &nrComponents, channels);
+    if (!data)
+    {
+        cout << "ERROR::COOKER::FAILED_TO_LOAD: " << input << " (" << stbi_failure_reason() << ")" << endl;
+        return 1;
+    }
+    vector<unsigned char> packed;
+    if (packSpecular)
+    {
+        int specWidth, specHeight, specComponents;
+        unsigned char* specular = stbi_load(packSpecular, &specWidth, &specHeight, &specComponents, 1);
+        if (!specular)
+        {
+            cout << "ERROR::COOKER::FAILED_TO_LOAD: " << packSpecular << " (" << stbi_failure_reason() << ")" << endl;
+            return 1;
+        }
+        if (specWidth != width || specHeight != height)
+        {
+            cout << "ERROR::COOKER::PACK_SIZE_MISMATCH: " << width << "x" << height << " vs " << specWidth << "x" << specHeight << endl;
+            return 1;
+        }
+        packed.resize((size_t)width * height * 4);
+        packDiffuseSpecular(data, specular, (size_t)width * height, packed.data());
+        stbi_image_free(specular);
+        channels = 4;
+    }
+
+    uint32_t format = channels == 1 ? CTEX_FORMAT_R8 : (channels == 3 ? CTEX_FORMAT_RGB8 : CTEX_FORMAT_RGBA8);
+
+    // build the whole chain in linear float, quantizing each level separately so errors do not accumulate
+    vector<vector<unsigned char> > levelData;
+    vector<CookedTextureLevel> levels;
+    FloatImage level = toFloat(packSpecular ? packed.data() : data, width, height, channels, srgb);
+    stbi_image_free(data);
+    while (true)
+    {
+        levelData.push_back(vector<unsigned char>());
+        toBytes(level, srgb, levelData.back());
+        CookedTextureLevel entry = { (uint32_t)level.width, (uint32_t)level.height, 0, levelData.back().size() };
+        levels.push_back(entry);
+        if (level.width == 1 && level.height == 1)
+            break;
+        level = downsample(level, filter);
+    }
+
+    if (compress)
+    {
+        format = channels == 1 ? CTEX_FORMAT_BC4 : (channels == 3 ? CTEX_FORMAT_BC1 : CTEX_FORMAT_BC3);
+        const char* formatName = channels == 1 ? " BC4" : (channels == 3 ? " BC1" : " BC3");
+        for (size_t i = 0; i < levels.size(); i++)
+        {
+            uint32_t w = levels[i].width, h = levels[i].height;
+            vector<unsigned char> blocks(cookedTextureLevelSize(format, w, h));
+            vector<unsigned char> decoded(levelData[i].size());
+            if (channels == 3)
+                compressBC1(levelData[i].data(), w, h, blocks.data());
+            else if (channels == 4)
+                compressBC3(levelData[i].data(), w, h, blocks.data());
+            else
+                compressBC4(levelData[i].data(), w, h, blocks.data());
+            decompressCookedLevel(format, blocks.data(), w, h, decoded.data());
+            cout << "  level " << i << " " << w << "x" << h << formatName
+                 << " PSNR " << computePSNR(levelData[i].data(), decoded.data(), decoded.size()) << " dB" << endl;
+            levelData[i].swap(blocks);
+            levels[i].size = levelData[i].size();
+        }
+    }
+
+    CookedTextureHeader header;
+    memcpy(header.magic, "CTEX", 4);
+    header.version = CTEX_VERSION;
+    header.width = (uint32_t)width;
+    header.height = (uint32_t)height;
+    header.format = format;
+    header.flags = (srgb ? CTEX_FLAG_SRGB : 0) | (packSpecular ? CTEX_FLAG_PACKED_SPECULAR : 0);
+    header.levelCount = (uint32_t)levels.size();
+    header.reserved = 0;
+
+    uint64_t offset = sizeof(header) + levels.size() * sizeof(CookedTextureLevel);
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        offset = (offset + CTEX_DATA_ALIGNMENT - 1) & ~(uint64_t)(CTEX_DATA_ALIGNMENT - 1);
+        levels[i].offset = offset;
+        offset += levels[i].size;
+    }
+
+    FILE* file = fopen(outputPath.c_str(), "wb");
+    if (!file)
+    {
+        cout << "ERROR::COOKER::FAILED_TO_OPEN_OUTPUT: " << outputPath << endl;
+        return 1;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(levels.data(), sizeof(CookedTextureLevel), levels.size(), file);
+    uint64_t written = sizeof(header) + levels.size() * sizeof(CookedTextureLevel);
+    static const unsigned char padding[CTEX_DATA_ALIGNMENT] = { 0 };
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        fwrite(padding, 1, (size_t)(levels[i].offset - written), file);
+        fwrite(levelData[i].data(), 1, levelData[i].size(), file);
+        written = levels[i].offset + levels[i].size;
+    }
+    bool ok = ferror(file) == 0;
+    ok = fclose(file) == 0 && ok;
+    if (!ok)
+    {
+        cout << "ERROR::COOKER::WRITE_FAILED: " << outputPath << endl;
+        return 1;
+    }
+
+    cout << input << " -> " << outputPath << ": " << width << "x" << height << ", " << channels << " channels"
+         << (compress ? (channels == 1 ? " (BC4), " : (channels == 3 ? " (BC1), " : " (BC3), ")) : ", ")
+         << levels.size() << " levels, " << written << " bytes" << endl;
+    return 0;
+}
@@ -0,0 +1,179 @@
+//变换批处理基准测试：为一批随机摆放的物体计算模型矩阵和法线矩阵，比较逐个物体用 GLM 计算和 TransformBatch 的 SIMD 批量计算
+//GLM 路径就是原来的做法：translate * rotate * scale，再 transpose(inverse(mat3(model)))
+//两条路径都写进同样交错排列的实例数组(模型矩阵 + 法线矩阵)，计时包括写出结果
+//
+//用法: TransformBenchmark [--count N] [--iterations N] [--seed N]
+//  --count       物体数量，默认 100000
+//  --iterations  每条路径重复的次数，默认 50，取最快的一次和平均值
+//  --seed        随机摆放用的种子，默认 1
+//结束时检查两条路径结果的最大误差，超过 1e-4 视为批量路径出错，返回 1
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../TransformBatch.hpp"
+#include "../SimdFloat8.h"
+
+using namespace std;
+using namespace glm;
+
+//与 LightingScene 的实例结构一样，模型矩阵后面紧跟法线矩阵
+struct Instance {
+    mat4 model;
+    mat3 normalMatrix;
+    float layer;
+};
+
+struct Placement {
+    vec3 position;
+    vec3 axis;
+    float angle;
+    vec3 scale;
+};
+
+struct BenchmarkResult {
+    double bestSeconds;
+    double totalSeconds;
+};
+
+static void computeGLM(const vector<Placement>& placements, vector<Instance>& instances)
+{
+    for (size_t i = 0; i < placements.size(); i++)
+    {
+        const Placement& p = placements[i];
+        mat4 model = mat4(1.0f);
+        model = translate(model, p.position);
+        model = rotate(model, p.angle, p.axis);
+        model = scale(model, p.scale);
+        instances[i].model = model;
+        instances[i].normalMatrix = transpose(inverse(mat3(model)));
+    }
+}
+
+static void computeBatch(const TransformBatch& batch, vector<Instance>& instances)
+{
+    batch.computeMatrices(&instances[0].model, sizeof(Instance), &instances[0].normalMatrix, sizeof(Instance));
+}
+
+template <typename Function>
+static BenchmarkResult measure(int iterations, Function function)
+{
+    BenchmarkResult result = { 1e30, 0.0 };
+    for (int i = 0; i < iterations; i++)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        function();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        result.totalSeconds += seconds;
+        if (seconds < result.bestSeconds)
+            result.bestSeconds = seconds;
+    }
+    return result;
+}
+
+static void printResult(const char* label, const BenchmarkResult& result, int count, int iterations)
+{
+    printf("%-12s %8.3f ms best %8.3f ms mean %8.1f M objects/s\n", label, result.bestSeconds * 1000.0,
+           result.totalSeconds / iterations * 1000.0, count / result.bestSeconds / 1e6);
+}
+
+//两条路径的模型矩阵和法线矩阵逐元素比较，返回最大的相对误差
+static float maxError(const vector<Instance>& a, const vector<Instance>& b)
+{
+    float error = 0.0f;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 4; row++)
+            {
+                float expected = a[i].model[column][row];
+                float d = fabsf(expected - b[i].model[column][row]) / std::max(1.0f, fabsf(expected));
+                error = std::max(error, d);
+            }
+        for (int column = 0; column < 3; column++)
+            for (int row = 0; row < 3; row++)
+            {
+                float expected = a[i].normalMatrix[column][row];
+                float d = fabsf(expected - b[i].normalMatrix[column][row]) / std::max(1.0f, fabsf(expected));
+                error = std::max(error, d);
+            }
+    }
+    return error;
+}
+
+static void printUsage()
+{
+    cout << "usage: TransformBenchmark [--count N] [--iterations N] [--seed N]" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    int count = 100000;
+    int iterations = 50;
+    unsigned int seed = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--count" && i + 1 < argc)
+            count = atoi(argv[++i]);
+        else if (arg == "--iterations" && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = (unsigned int)atoi(argv[++i]);
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+    if (count < 1 || iterations < 1)
+    {
+        printUsage();
+        return 1;
+    }
+
+    //随机摆放：位置在 ±50 的立方体里，任意旋转轴和角度，非均匀缩放 0.2~3
+    mt19937 random(seed);
+    uniform_real_distribution<float> position(-50.0f, 50.0f);
+    uniform_real_distribution<float> axis(-1.0f, 1.0f);
+    uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    uniform_real_distribution<float> scaling(0.2f, 3.0f);
+    vector<Placement> placements(count);
+    TransformBatch batch;
+    for (int i = 0; i < count; i++)
+    {
+        Placement& p = placements[i];
+        p.position = vec3(position(random), position(random), position(random));
+        do
+            p.axis = vec3(axis(random), axis(random), axis(random));
+        while (dot(p.axis, p.axis) < 0.01f);
+        p.angle = angle(random);
+        p.scale = vec3(scaling(random), scaling(random), scaling(random));
+        batch.add(p.position, p.axis, p.angle, p.scale);
+    }
+
+    vector<Instance> glmInstances(count), batchInstances(count);
+    cout << count << " objects, " << iterations << " iterations, batch path: " << simdFloat8Path() << endl;
+    BenchmarkResult glmResult = measure(iterations, [&]() { computeGLM(placements, glmInstances); });
+    printResult("GLM", glmResult, count, iterations);
+    BenchmarkResult batchResult = measure(iterations, [&]() { computeBatch(batch, batchInstances); });
+    printResult("batch", batchResult, count, iterations);
+    printf("speedup: %.2fx\n", glmResult.bestSeconds / batchResult.bestSeconds);
+
+    float error = maxError(glmInstances, batchInstances);
+    printf("max relative error: %g\n", error);
+    if (error > 1e-4f)
+    {
+        cout << "ERROR::TRANSFORM_BENCHMARK::MISMATCH: batch matrices differ from GLM" << endl;
+        return 1;
+    }
+    return 0;
+}
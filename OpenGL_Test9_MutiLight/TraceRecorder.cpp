@@ -0,0 +1,187 @@
+#include "TraceRecorder.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <iostream>
+
+using namespace std;
+
+struct TraceRecord {
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+};
+
+//单生产者环形缓冲：written 只由所属线程递增，导出线程用 acquire 读取
+struct TraceBuffer {
+    string name;
+    int trackID;
+    vector<TraceRecord> records;
+    atomic<uint64_t> written;
+
+    TraceBuffer(const string& trackName, int id)
+    : name(trackName), trackID(id), records(TRACE_BUFFER_CAPACITY), written(0)
+    {
+    }
+
+    void push(const char* eventName, uint64_t begin, uint64_t end)
+    {
+        uint64_t index = written.load(memory_order_relaxed);
+        TraceRecord& record = records[index & (TRACE_BUFFER_CAPACITY - 1)];
+        record.name = eventName;
+        record.begin = begin;
+        record.end = end > begin ? end : begin;
+        written.store(index + 1, memory_order_release);
+    }
+};
+
+static atomic<bool> enabledFlag(false);
+
+//所有缓冲的登记表，只有线程第一次记录和导出时才加锁；缓冲在进程结束前一直保留，线程退出后仍能导出
+static mutex& registryMutex()
+{
+    static mutex registryLock;
+    return registryLock;
+}
+
+static vector<unique_ptr<TraceBuffer> >& registry()
+{
+    static vector<unique_ptr<TraceBuffer> > buffers;
+    return buffers;
+}
+
+// an empty name gets "thread N"
+static TraceBuffer* registerBuffer(const string& name)
+{
+    lock_guard<mutex> lock(registryMutex());
+    vector<unique_ptr<TraceBuffer> >& buffers = registry();
+    int trackID = (int)buffers.size() + 1;
+    string trackName = name.empty() ? "thread " + to_string(trackID) : name;
+    buffers.push_back(unique_ptr<TraceBuffer>(new TraceBuffer(trackName, trackID)));
+    return buffers.back().get();
+}
+
+static thread_local TraceBuffer* threadBuffer = nullptr;
+
+static TraceBuffer* currentThreadBuffer()
+{
+    if (!threadBuffer)
+        threadBuffer = registerBuffer("");
+    return threadBuffer;
+}
+
+static TraceBuffer* gpuBuffer()
+{
+    static TraceBuffer* buffer = registerBuffer("GPU");
+    return buffer;
+}
+
+void setTracingEnabled(bool enabled)
+{
+    //先初始化时钟起点和 GPU 轨道，让它们排在最前面
+    traceNow();
+    gpuBuffer();
+    enabledFlag.store(enabled, memory_order_relaxed);
+}
+
+bool tracingEnabled()
+{
+    return enabledFlag.load(memory_order_relaxed);
+}
+
+uint64_t traceNow()
+{
+    static const chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count();
+}
+
+void traceSetThreadName(const char* name)
+{
+    TraceBuffer* buffer = currentThreadBuffer();
+    lock_guard<mutex> lock(registryMutex());
+    buffer->name = name;
+}
+
+void traceEvent(const char* name, uint64_t beginNanoseconds, uint64_t endNanoseconds)
+{
+    if (tracingEnabled())
+        currentThreadBuffer()->push(name, beginNanoseconds, endNanoseconds);
+}
+
+void traceGpuEvent(const char* name, uint64_t beginNanoseconds, uint64_t endNanoseconds)
+{
+    if (tracingEnabled())
+        gpuBuffer()->push(name, beginNanoseconds, endNanoseconds);
+}
+
+static void writeJSONString(FILE* file, const string& value)
+{
+    fputc('"', file);
+    for (size_t i = 0; i < value.size(); i++)
+    {
+        char c = value[i];
+        if (c == '"' || c == '\\')
+            fputc('\\', file);
+        if ((unsigned char)c >= 0x20)
+            fputc(c, file);
+    }
+    fputc('"', file);
+}
+
+bool writeChromeTrace(const string& path)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+        cout << "ERROR::TRACE::FILE_NOT_WRITTEN: " << path << endl;
+        return false;
+    }
+    lock_guard<mutex> lock(registryMutex());
+    vector<unique_ptr<TraceBuffer> >& buffers = registry();
+    size_t eventCount = 0;
+    bool first = true;
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    vector<TraceRecord> snapshot;
+    for (size_t b = 0; b < buffers.size(); b++)
+    {
+        TraceBuffer& buffer = *buffers[b];
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", first ? "" : ",\n", buffer.trackID);
+        writeJSONString(file, buffer.name);
+        fprintf(file, "}}");
+        first = false;
+
+        //先拷贝再检查：拷贝期间被所属线程覆盖掉的最旧事件要丢掉
+        uint64_t end = buffer.written.load(memory_order_acquire);
+        uint64_t start = end > TRACE_BUFFER_CAPACITY ? end - TRACE_BUFFER_CAPACITY : 0;
+        snapshot.resize((size_t)(end - start));
+        for (uint64_t i = start; i < end; i++)
+            snapshot[(size_t)(i - start)] = buffer.records[i & (TRACE_BUFFER_CAPACITY - 1)];
+        uint64_t after = buffer.written.load(memory_order_acquire);
+        uint64_t firstValid = after > TRACE_BUFFER_CAPACITY ? after - TRACE_BUFFER_CAPACITY : 0;
+        size_t skip = firstValid > start ? (size_t)(firstValid - start) : 0;
+
+        for (size_t i = skip; i < snapshot.size(); i++)
+        {
+            const TraceRecord& record = snapshot[i];
+            //Chrome trace 的时间单位是微秒，保留三位小数就是纳秒精度
+            fprintf(file, ",\n{\"name\":");
+            writeJSONString(file, record.name);
+            fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%llu.%03llu,\"dur\":%llu.%03llu}", buffer.trackID,
+                    (unsigned long long)(record.begin / 1000), (unsigned long long)(record.begin % 1000),
+                    (unsigned long long)((record.end - record.begin) / 1000), (unsigned long long)((record.end - record.begin) % 1000));
+            eventCount++;
+        }
+    }
+    fprintf(file, "\n]}\n");
+    bool written = ferror(file) == 0;
+    if (fclose(file) != 0 || !written)
+    {
+        cout << "ERROR::TRACE::FILE_NOT_WRITTEN: " << path << endl;
+        return false;
+    }
+    cout << "Trace: " << eventCount << " events on " << buffers.size() << " tracks written to " << path << endl;
+    return true;
+}
@@ -0,0 +1,54 @@
+#ifndef TraceRecorder_hpp
+#define TraceRecorder_hpp
+
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+//帧时间线记录，导出成 Chrome Trace Event 格式的 JSON，可以在 chrome://tracing 或 ui.perfetto.dev 里打开
+//  每个线程第一次记录时得到一个自己的环形缓冲，之后写事件不加锁：只有本线程写，写完用 release 发布下标
+//  缓冲写满后覆盖最旧的事件，导出时只保留最近的 TRACE_BUFFER_CAPACITY 个
+//  时间戳是纳秒，起点是进程里第一次调用 traceNow() 的时刻
+//  GPU 事件来自 GpuProfiler 的时间戳查询，换算到 CPU 时钟后画在单独的 "GPU" 轨道上
+
+const uint32_t TRACE_BUFFER_CAPACITY = 1 << 15;     //每个线程的事件数，必须是 2 的幂
+
+void setTracingEnabled(bool enabled);
+bool tracingEnabled();
+
+// nanoseconds on the trace clock (steady_clock)
+uint64_t traceNow();
+// names the calling thread's track in the exported trace
+void traceSetThreadName(const char* name);
+// records a finished event on the calling thread's track; name must be a string literal (only the pointer is kept)
+void traceEvent(const char* name, uint64_t beginNanoseconds, uint64_t endNanoseconds);
+// records a GPU event already converted to the trace clock; only the GL thread may call this
+void traceGpuEvent(const char* name, uint64_t beginNanoseconds, uint64_t endNanoseconds);
+
+// writes every recorded event as Chrome Trace Event JSON; stop or pause tracing first for a consistent snapshot
+bool writeChromeTrace(const string& path);
+
+//作用域事件：构造时记下开始时间，析构时写入本线程的缓冲；没开启记录时只多一次布尔判断
+class TraceScope {
+public:
+    TraceScope(const char* eventName)
+    : name(tracingEnabled() ? eventName : nullptr), begin(name ? traceNow() : 0)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (name)
+            traceEvent(name, begin, traceNow());
+    }
+
+private:
+    const char* name;
+    uint64_t begin;
+
+    TraceScope(const TraceScope&);
+    TraceScope& operator=(const TraceScope&);
+};
+
+#endif /* TraceRecorder_hpp */
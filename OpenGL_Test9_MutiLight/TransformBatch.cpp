@@ -0,0 +1,158 @@
+#include "TransformBatch.hpp"
+#include "SimdFloat8.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+using namespace glm;
+
+TransformBatch::TransformBatch()
+: count(0)
+{
+}
+
+//补齐到 8 的倍数，新的位置先填成单位变换
+void TransformBatch::grow()
+{
+    size_t padded = (count + 8) & ~(size_t)7;
+    positionX.resize(padded, 0.0f);
+    positionY.resize(padded, 0.0f);
+    positionZ.resize(padded, 0.0f);
+    rotationX.resize(padded, 0.0f);
+    rotationY.resize(padded, 0.0f);
+    rotationZ.resize(padded, 0.0f);
+    rotationW.resize(padded, 1.0f);
+    scaleX.resize(padded, 1.0f);
+    scaleY.resize(padded, 1.0f);
+    scaleZ.resize(padded, 1.0f);
+}
+
+size_t TransformBatch::add(const vec3& position, const vec3& axis, float angle, const vec3& scale)
+{
+    if (count == positionX.size())
+        grow();
+    size_t index = count++;
+    setPosition(index, position);
+    setRotation(index, axis, angle);
+    setScale(index, scale);
+    return index;
+}
+
+void TransformBatch::setPosition(size_t index, const vec3& position)
+{
+    positionX[index] = position.x;
+    positionY[index] = position.y;
+    positionZ[index] = position.z;
+}
+
+void TransformBatch::setRotation(size_t index, const vec3& axis, float angle)
+{
+    //与 glm::rotate 一样先把轴归一化
+    float length = sqrtf(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+    float s = length > 0.0f ? sinf(angle * 0.5f) / length : 0.0f;
+    rotationX[index] = axis.x * s;
+    rotationY[index] = axis.y * s;
+    rotationZ[index] = axis.z * s;
+    rotationW[index] = length > 0.0f ? cosf(angle * 0.5f) : 1.0f;
+}
+
+void TransformBatch::setScale(size_t index, const vec3& scale)
+{
+    scaleX[index] = scale.x;
+    scaleY[index] = scale.y;
+    scaleZ[index] = scale.z;
+}
+
+void TransformBatch::removeSwap(size_t index)
+{
+    size_t last = --count;
+    vector<float>* arrays[] = { &positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ, &rotationW, &scaleX, &scaleY, &scaleZ };
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++)
+        (*arrays[i])[index] = (*arrays[i])[last];
+    //空出来的位置恢复成单位变换，和补齐的部分保持一致
+    setPosition(last, vec3(0.0f));
+    setRotation(last, vec3(0.0f), 0.0f);
+    setScale(last, vec3(1.0f));
+}
+
+void TransformBatch::clear()
+{
+    count = 0;
+    positionX.clear();
+    positionY.clear();
+    positionZ.clear();
+    rotationX.clear();
+    rotationY.clear();
+    rotationZ.clear();
+    rotationW.clear();
+    scaleX.clear();
+    scaleY.clear();
+    scaleZ.clear();
+}
+
+void TransformBatch::computeMatrices(void* models, size_t modelStride, void* normals, size_t normalStride) const
+{
+    computeMatrices(0, count, models, modelStride, normals, normalStride);
+}
+
+void TransformBatch::computeMatrices(size_t begin, size_t end, void* models, size_t modelStride, void* normals, size_t normalStride) const
+{
+    //每组 8 个物体：16 个模型矩阵元素 + 9 个法线矩阵元素，先按元素存成 8 路，再转置写到各自的位置
+    alignas(32) float lanes[25][8];
+    unsigned char* modelOut = (unsigned char*)models;
+    unsigned char* normalOut = (unsigned char*)normals;
+    end = std::min(end, count);
+    for (size_t first = begin; first < end; first += 8)
+    {
+        Float8 x = Float8::load(&rotationX[first]), y = Float8::load(&rotationY[first]);
+        Float8 z = Float8::load(&rotationZ[first]), w = Float8::load(&rotationW[first]);
+        Float8 sx = Float8::load(&scaleX[first]), sy = Float8::load(&scaleY[first]), sz = Float8::load(&scaleZ[first]);
+
+        //四元数转旋转矩阵，r[列][行]
+        Float8 xx = x * x, yy = y * y, zz = z * z;
+        Float8 xy = x * y, xz = x * z, yz = y * z;
+        Float8 wx = w * x, wy = w * y, wz = w * z;
+        Float8 r[3][3];
+        r[0][0] = Float8(1.0f) - (yy + zz) * 2.0f;
+        r[0][1] = (xy + wz) * 2.0f;
+        r[0][2] = (xz - wy) * 2.0f;
+        r[1][0] = (xy - wz) * 2.0f;
+        r[1][1] = Float8(1.0f) - (xx + zz) * 2.0f;
+        r[1][2] = (yz + wx) * 2.0f;
+        r[2][0] = (xz + wy) * 2.0f;
+        r[2][1] = (yz - wx) * 2.0f;
+        r[2][2] = Float8(1.0f) - (xx + yy) * 2.0f;
+
+        Float8 scale[3] = { sx, sy, sz };
+        for (int column = 0; column < 3; column++)
+        {
+            Float8 inverseScale = Float8(1.0f) / scale[column];
+            for (int row = 0; row < 3; row++)
+            {
+                (r[column][row] * scale[column]).store(lanes[column * 4 + row]);
+                (r[column][row] * inverseScale).store(lanes[16 + column * 3 + row]);
+            }
+            Float8(0.0f).store(lanes[column * 4 + 3]);
+        }
+        Float8::load(&positionX[first]).store(lanes[12]);
+        Float8::load(&positionY[first]).store(lanes[13]);
+        Float8::load(&positionZ[first]).store(lanes[14]);
+        Float8(1.0f).store(lanes[15]);
+
+        size_t valid = end - first < 8 ? end - first : 8;
+        for (size_t lane = 0; lane < valid; lane++)
+        {
+            float matrix[16];
+            for (int element = 0; element < 16; element++)
+                matrix[element] = lanes[element][lane];
+            memcpy(modelOut + (first + lane) * modelStride, matrix, sizeof(matrix));
+            if (!normalOut)
+                continue;
+            float normal[9];
+            for (int element = 0; element < 9; element++)
+                normal[element] = lanes[16 + element][lane];
+            memcpy(normalOut + (first + lane) * normalStride, normal, sizeof(normal));
+        }
+    }
+}
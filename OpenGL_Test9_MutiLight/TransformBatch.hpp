@@ -0,0 +1,47 @@
+#ifndef TransformBatch_hpp
+#define TransformBatch_hpp
+
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+
+using namespace std;
+using namespace glm;
+
+//批量计算物体的模型矩阵和法线矩阵
+//位置、旋转(单位四元数)、缩放按分量分别存成连续数组(SoA)，每次取 8 个物体装进 SIMD 寄存器一起算(见 SimdFloat8.h)，
+//结果直接按步长写进交错排列的实例缓冲，不经过逐个物体的 glm::translate/rotate/scale 和 inverse
+//  model  = translate(position) * rotate(angle, axis) * scale(s)
+//  normal = transpose(inverse(mat3(model))) = rotate * scale^-1，旋转矩阵是正交的，所以不需要求逆
+//数组长度总是补齐到 8 的倍数，补出来的物体是单位变换，算出来的结果不会写出去
+class TransformBatch {
+public:
+    TransformBatch();
+
+    // rotation is angle radians around axis, like glm::rotate; returns the index of the new transform
+    size_t add(const vec3& position, const vec3& axis, float angle, const vec3& scale);
+    void setPosition(size_t index, const vec3& position);
+    void setRotation(size_t index, const vec3& axis, float angle);
+    void setScale(size_t index, const vec3& scale);
+    // removes transform index by moving the last transform into its place; other indices stay valid
+    void removeSwap(size_t index);
+    size_t size() const { return count; }
+    void clear();
+
+    // writes transform i as a column-major mat4 at models + i * modelStride and, unless normals is nullptr,
+    // a column-major mat3 at normals + i * normalStride; strides are in bytes so both can point into one instance struct
+    void computeMatrices(void* models, size_t modelStride, void* normals, size_t normalStride) const;
+    // the same for transforms [begin, end) only, with models/normals still pointing at transform 0;
+    // begin must be a multiple of 8 so that disjoint ranges can be computed on different threads
+    void computeMatrices(size_t begin, size_t end, void* models, size_t modelStride, void* normals, size_t normalStride) const;
+
+private:
+    void grow();
+
+    size_t count;
+    vector<float> positionX, positionY, positionZ;
+    vector<float> rotationX, rotationY, rotationZ, rotationW;
+    vector<float> scaleX, scaleY, scaleZ;
+};
+
+#endif /* TransformBatch_hpp */
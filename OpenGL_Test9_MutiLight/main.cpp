@@ -1,14 +1,28 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-#include "Shader.h"
+#include "LightingScene.hpp"
+#include "HeadlessContext.hpp"
+#include "OffscreenTarget.hpp"
+#include "PngWriter.hpp"
+#include "CameraPath.hpp"
+#include "FrameBenchmark.hpp"
+#include "TraceRecorder.hpp"
+#include "GLInstrumentation.hpp"
+#include "GLExtensions.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "FramePipeline.hpp"
+#include "JobSystem.hpp"
+#include "GoldenImage.hpp"
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 //引入openGL数学库
 #include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
 #include "Camera.hpp"
 
 using namespace std;
@@ -19,7 +33,6 @@ void processInput(GLFWwindow* window);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
-unsigned int loadTexture(const char *path);
 
 // settings 屏幕宽高
 const unsigned int SCR_WIDTH = 800;
@@ -32,76 +45,220 @@ bool firstMouse = true;     //是否是第一次获取鼠标输入
 float lastX = SCR_WIDTH * 0.5f;
 float lastY = SCR_HEIGHT * 0.5f;
 
-//手工添加顶点法向量数据
-float vertices[] = {
-    // positions          // normals           // texture coords
-    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
-     0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 0.0f,
-     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
-     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
-    -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 1.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
-
-    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
-     0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 0.0f,
-     0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
-     0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
-    -0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 1.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
-
-    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-    -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
-    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-    -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
-    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-
-     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-     0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
-     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-     0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
-     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-
-    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
-     0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 1.0f,
-     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
-     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 0.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
-
-    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f,
-     0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 1.0f,
-     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
-     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
-    -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 0.0f,
-    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f
-};
-//方块们的各个世界位置
-vec3 cubePositions[] = {
-  vec3( 0.0f,  0.0f,  0.0f),
-  vec3( 2.0f,  5.0f, -15.0f),
-  vec3(-1.5f, -2.2f, -2.5f),
-  vec3(-3.8f, -2.0f, -12.3f),
-  vec3( 2.4f, -0.4f, -3.5f),
-  vec3(-1.7f,  3.0f, -7.5f),
-  vec3( 1.3f, -2.0f, -2.5f),
-  vec3( 1.5f,  2.0f, -2.5f),
-  vec3( 1.5f,  0.2f, -1.5f),
-  vec3(-1.3f,  1.0f, -1.5f)
+//命令行参数
+//  --headless              不开窗口，用 EGL(Linux) 或隐藏窗口渲染到离屏帧缓冲，把每一帧写成 PNG
+//  --frames N              headless / 基准测试模式下渲染的帧数，默认 1 / 600
+//  --width W --height H    headless / 基准测试模式下的分辨率，默认与窗口相同
+//  --output PREFIX         输出文件名前缀，第 i 帧写到 PREFIX_000i.png，默认 frame
+//  --shader-dir DIR        着色器目录（包含 LightShader/ 和 LampShader/）
+//  --texture-dir DIR       贴图目录（包含 container2.png 和 container2_specular.png）
+//  --benchmark             无窗口基准测试：沿摄像机路径以固定步长渲染 --frames 帧（默认 600），统计结果写成 JSON
+//  --camera-path FILE      基准测试回放的摄像机路径（见 CameraPath.hpp），默认绕场景转一圈
+//  --timestep SECONDS      基准测试每帧前进的时间，默认 1/60
+//  --warmup N              基准测试开始统计前先渲染的帧数，默认 30
+//  --json FILE             基准测试结果文件，默认 benchmark.json
+//  --record-path FILE      窗口模式下把每帧的摄像机位置记录下来，退出时写成摄像机路径文件
+//  --profile               窗口模式下每 2 秒打印一次各个 pass 的平均 GPU/CPU 时间
+//  --trace FILE            窗口/基准测试模式下记录 CPU 和 GPU 的帧时间线，退出时写成 Chrome Trace JSON
+//  --gl-calls              统计每帧各个 GL 入口的调用次数、耗时和冗余调用，退出时打印；窗口模式下 F2 随时开关
+//  --software              不创建 GL 上下文，用 CPU 软件光栅化画同一个场景，参数和输出与 --headless 相同；
+//                          指定了 --camera-path 时按 --timestep 沿路径走，打印平均每帧的时间
+//  --golden DIR            金图回归检查：在 GoldenImage.cpp 里固定的几个位置无窗口渲染，和 DIR/<位置名>.png 比较，
+//                          有不合格的位置时返回非 0，并写出 PREFIX_<位置名>.png(实际画面)和 PREFIX_<位置名>_diff.png；
+//                          加 --software 时用软件光栅化渲染，可以拿 GL 的金图交叉检查
+//  --update-golden         和 --golden 一起用：不比较，把当前画面写成新的金图
+//  --tolerance N           金图比较时单个通道允许的差值(0-255)，默认 4
+//  --max-failing PERCENT   金图比较时允许超出容差的像素百分比，默认 0.5
+//  --objects N             在默认场景之外再随机摆放 N 个箱子，测试大场景；金图模式下不起作用
+//  --scene FILE            用二进制场景文件(.scnb，由 SceneConverter 生成)代替默认场景；金图模式下不起作用
+//  --pipeline              窗口/基准测试模式下把剔除和帧包生成放到模拟线程上，和 GL 提交重叠执行(见 FramePipeline.hpp)
+//  --jobs N                每帧剔除、矩阵计算和软件光栅化用的任务线程数(见 JobSystem.hpp)，不含提交任务的线程本身，默认硬件线程数减 1
+//  --standard-depth        GL 渲染不用反向 Z 和无穷远的远平面，即使上下文支持 glClipControl(见 Camera::ReversedZ)
+struct RunOptions {
+    bool headless;
+    bool benchmark;
+    bool profile;
+    bool glCalls;
+    bool software;
+    bool updateGolden;
+    bool pipeline;
+    bool standardDepth;
+    int frames;
+    int width;
+    int height;
+    string outputPrefix;
+    string shaderDir;
+    string textureDir;
+    string cameraPath;
+    string recordPath;
+    string jsonPath;
+    string tracePath;
+    string goldenDir;
+    string scenePath;
+    const SceneFile* sceneFile;     //--scene 加载好的场景，没有指定时为 nullptr
+    float timestep;
+    int warmupFrames;
+    int extraObjects;
+    int jobWorkers;                 //-1 = 按硬件线程数
+    int tolerance;
+    float maxFailingPercent;
 };
 
-vec3 pointLightPositions[] = {
-    vec3( 0.7f,  0.2f,  2.0f),
-    vec3( 2.3f, -3.3f, -4.0f),
-    vec3(-4.0f,  2.0f, -12.0f),
-    vec3( 0.0f,  0.0f, -3.0f)
-};
+bool parseOptions(int argc, char* argv[], RunOptions& options);
+int runWindowed(const RunOptions& options);
+int runHeadless(const RunOptions& options);
+int runBenchmark(const RunOptions& options);
+int runSoftware(const RunOptions& options);
+int runGolden(const RunOptions& options);
 
 //Camera camera = Camera();
 Camera camera(vec3(0.0f, 0.0f, 3.0f));
 
-int main()
+int main(int argc, char* argv[])
+{
+    RunOptions options;
+    if (!parseOptions(argc, argv, options))
+    {
+        cout << "usage: OpenGL_Test9_MutiLight [--headless | --benchmark | --software] [--frames N] [--width W] [--height H] [--output PREFIX]" << endl;
+        cout << "       [--shader-dir DIR] [--texture-dir DIR] [--camera-path FILE] [--timestep SECONDS] [--warmup N] [--json FILE]" << endl;
+        cout << "       [--record-path FILE] [--profile] [--trace FILE] [--gl-calls] [--objects N] [--scene FILE] [--pipeline] [--jobs N] [--standard-depth]" << endl;
+        cout << "       [--golden DIR [--update-golden] [--tolerance N] [--max-failing PERCENT]]" << endl;
+        return -1;
+    }
+    SceneFile sceneFile;
+    if (!options.scenePath.empty())
+    {
+        if (!sceneFile.load(options.scenePath))
+            return -1;
+        printf("Scene: %s, %zu KB mapped in %.3f ms: %u meshes, %u materials, %u instances, %u lights\n", options.scenePath.c_str(),
+               sceneFile.fileSize() / 1024, sceneFile.loadMilliseconds(), sceneFile.meshCount(), sceneFile.materialCount(),
+               sceneFile.instanceCount(), sceneFile.lightCount());
+        options.sceneFile = &sceneFile;
+    }
+    if (!options.tracePath.empty())
+    {
+        traceSetThreadName("main");
+        setTracingEnabled(true);
+    }
+    if (options.jobWorkers < 0)
+        options.jobWorkers = std::max(0, (int)thread::hardware_concurrency() - 1);
+    jobSystem().start(options.jobWorkers);
+    int result;
+    if (options.benchmark)
+        result = runBenchmark(options);
+    else if (!options.goldenDir.empty())
+        result = runGolden(options);
+    else if (options.software)
+        result = runSoftware(options);
+    else
+        result = options.headless ? runHeadless(options) : runWindowed(options);
+    if (!options.tracePath.empty())
+    {
+        setTracingEnabled(false);
+        writeChromeTrace(options.tracePath);
+    }
+    jobSystem().stop();
+    return result;
+}
+
+bool parseOptions(int argc, char* argv[], RunOptions& options)
+{
+    options.headless = false;
+    options.benchmark = false;
+    options.profile = false;
+    options.glCalls = false;
+    options.software = false;
+    options.updateGolden = false;
+    options.pipeline = false;
+    options.standardDepth = false;
+    options.frames = 0;
+    options.width = SCR_WIDTH;
+    options.height = SCR_HEIGHT;
+    options.outputPrefix = "frame";
+    options.shaderDir = "/Users/haoxiangliang/Desktop/代码草稿/OpenGL/OpenGL_Test9_MutiLight/OpenGL_Test9_MutiLight/";
+    options.textureDir = "/Users/haoxiangliang/Desktop/未命名文件夹/";
+    options.jsonPath = "benchmark.json";
+    options.timestep = 1.0f / 60.0f;
+    options.warmupFrames = 30;
+    options.extraObjects = 0;
+    options.jobWorkers = -1;
+    options.sceneFile = nullptr;
+    options.tolerance = 4;
+    options.maxFailingPercent = 0.5f;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--headless")
+            options.headless = true;
+        else if (arg == "--benchmark")
+            options.benchmark = true;
+        else if (arg == "--profile")
+            options.profile = true;
+        else if (arg == "--gl-calls")
+            options.glCalls = true;
+        else if (arg == "--software")
+            options.software = true;
+        else if (arg == "--update-golden")
+            options.updateGolden = true;
+        else if (arg == "--pipeline")
+            options.pipeline = true;
+        else if (arg == "--standard-depth")
+            options.standardDepth = true;
+        else if (arg == "--frames" && hasValue)
+            options.frames = atoi(argv[++i]);
+        else if (arg == "--width" && hasValue)
+            options.width = atoi(argv[++i]);
+        else if (arg == "--height" && hasValue)
+            options.height = atoi(argv[++i]);
+        else if (arg == "--output" && hasValue)
+            options.outputPrefix = argv[++i];
+        else if (arg == "--shader-dir" && hasValue)
+            options.shaderDir = argv[++i];
+        else if (arg == "--texture-dir" && hasValue)
+            options.textureDir = argv[++i];
+        else if (arg == "--camera-path" && hasValue)
+            options.cameraPath = argv[++i];
+        else if (arg == "--record-path" && hasValue)
+            options.recordPath = argv[++i];
+        else if (arg == "--trace" && hasValue)
+            options.tracePath = argv[++i];
+        else if (arg == "--json" && hasValue)
+            options.jsonPath = argv[++i];
+        else if (arg == "--timestep" && hasValue)
+            options.timestep = (float)atof(argv[++i]);
+        else if (arg == "--warmup" && hasValue)
+            options.warmupFrames = atoi(argv[++i]);
+        else if (arg == "--objects" && hasValue)
+            options.extraObjects = atoi(argv[++i]);
+        else if (arg == "--jobs" && hasValue)
+            options.jobWorkers = atoi(argv[++i]);
+        else if (arg == "--scene" && hasValue)
+            options.scenePath = argv[++i];
+        else if (arg == "--golden" && hasValue)
+            options.goldenDir = argv[++i];
+        else if (arg == "--tolerance" && hasValue)
+            options.tolerance = atoi(argv[++i]);
+        else if (arg == "--max-failing" && hasValue)
+            options.maxFailingPercent = (float)atof(argv[++i]);
+        else
+            return false;
+    }
+    //目录参数允许不带结尾的斜杠
+    if (!options.shaderDir.empty() && options.shaderDir.back() != '/')
+        options.shaderDir += '/';
+    if (!options.textureDir.empty() && options.textureDir.back() != '/')
+        options.textureDir += '/';
+    if (!options.goldenDir.empty() && options.goldenDir.back() != '/')
+        options.goldenDir += '/';
+    //没有指定帧数时：headless 画 1 帧，基准测试画 600 帧（默认步长下是 10 秒）
+    if (options.frames == 0)
+        options.frames = options.benchmark ? 600 : 1;
+    return options.frames > 0 && options.width > 0 && options.height > 0 && options.timestep > 0.0f && options.warmupFrames >= 0
+        && options.extraObjects >= 0 && options.jobWorkers >= -1 && options.tolerance >= 0 && options.maxFailingPercent >= 0.0f;
+}
+
+int runWindowed(const RunOptions& options)
 {
     // glfw: initialize and configure
     // ------------------------------
@@ -113,6 +270,8 @@ int main()
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+    //默认帧缓冲要能做 sRGB 编码：漫反射贴图按 sRGB 存储，着色器里的光照都在线性空间里计算
+    glfwWindowHint(GLFW_SRGB_CAPABLE, GL_TRUE);
 
     // glfw window creation
     // --------------------
@@ -133,187 +292,109 @@ int main()
         cout << "Failed to initialize GLAD" << endl;
         return -1;
     }
-    
-    // build and compile our shader program
-    // ------------------------------------
-    char* headDir = "/Users/haoxiangliang/Desktop/代码草稿/OpenGL/OpenGL_Test9_MutiLight/OpenGL_Test9_MutiLight/";
-    string p1 = string(headDir) + "LightShader/LightVertexShader.cpp";
-    string p2 = string(headDir) + "LightShader/LightFragmentShader.cpp";
-    Shader lightingShader(p1.c_str(), p2.c_str());
-    string p3 = string(headDir) + "LampShader/LampVertexShader.cpp";
-    string p4 = string(headDir) + "LampShader/LampFragmentShader.cpp";
-    Shader lightCubeShader(p3.c_str(), p4.c_str());
-    // set up vertex data (and buffer(s)) and configure vertex attributes
-    // ------------------------------------------------------------------
-    
-    unsigned int VBO;
-    glGenBuffers(1, &VBO);
-    //被照射的立方体顶点缓冲数组
-    unsigned int cubeVAO;
-    glGenVertexArrays(1, &cubeVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glBindVertexArray(cubeVAO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    //光源立方体顶点缓冲数组
-    unsigned int lightCubeVAO;
-    glGenVertexArrays(1, &lightCubeVAO);
-    glBindVertexArray(lightCubeVAO);
-    // we only need to bind to the VBO (to link it with glVertexAttribPointer), no need to fill it; the VBO's data already contains all we need (it's already bound, but we do it again for educational purposes)
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    unsigned int diffuseMap = loadTexture("/Users/haoxiangliang/Desktop/未命名文件夹/container2.png");
-    unsigned int specularMap = loadTexture("/Users/haoxiangliang/Desktop/未命名文件夹/container2_specular.png");
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    LightingScene scene;
+    scene.allowReversedDepth(!options.standardDepth);
+    if (!scene.init(options.shaderDir, options.textureDir, options.sceneFile))
+    {
+        glfwTerminate();
+        return -1;
+    }
+    scatterContainers(scene.scene(), options.extraObjects, 1);
 
     glfwSetKeyCallback(window, key_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
-    
-    glEnable(GL_DEPTH_TEST);
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);//运行时隐藏鼠标光标
-    lightingShader.use();
-    lightingShader.setInt("material.diffuse", 0);
-    lightingShader.setInt("material.specular", 1);
+    CameraPath recordedPath;
+    float recordStart = (float)glfwGetTime();
+    GpuProfiler profiler;
+    float lastProfileReport = recordStart;
+    //时间线上的 GPU 轨道也来自 profiler
+    if (options.profile || !options.tracePath.empty())
+    {
+        profiler.init();
+        scene.setProfiler(&profiler);
+    }
+    setGLInstrumentationEnabled(options.glCalls);
+    //流水线模式：模拟线程按交出的摄像机状态提前一帧生成帧包，从这里开始只有它访问 scene.scene()
+    FramePipeline pipeline;
+    scene.setupCamera(camera, SCR_WIDTH, SCR_HEIGHT);
+    if (options.pipeline)
+    {
+        pipeline.start([&scene](const Camera& packetCamera, FramePacket& packet) {
+            scene.buildPacket(packetCamera, packet);
+        });
+        pipeline.submitInput(camera);
+    }
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
     {
+        TraceScope frameTrace("frame");
         float currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
         
-        processInput(window);
+        {
+            TraceScope trace("input");
+            processInput(window);
+        }
+        if (!options.recordPath.empty())
+            recordedPath.addKey(currentFrame - recordStart, camera);
         
         // render
         // ------
-        glClearColor(182.0f / 255.0f, 135.0f / 255.0f, 86.0f / 255.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        // be sure to activate shader when setting uniforms/drawing objects
-        lightingShader.use();
-        lightingShader.setVec3("viewPos", camera.Position);
-        lightingShader.setFloat("material.shininess", 32.0f);
-
-        /*
-           Here we set all the uniforms for the 5/6 types of lights we have. We have to set them manually and index
-           the proper PointLight struct in the array to set each uniform variable. This can be done more code-friendly
-           by defining light types as classes and set their values in there, or by using a more efficient uniform approach
-           by using 'Uniform buffer objects', but that is something we'll discuss in the 'Advanced GLSL' tutorial.
-        */
-        // directional light
-        lightingShader.setVec3("dirLight.direction", -0.2f, -1.0f, -0.3f);
-        lightingShader.setVec3("dirLight.ambient", 0.05f, 0.05f, 0.05f);
-        lightingShader.setVec3("dirLight.diffuse", 0.4f, 0.4f, 0.4f);
-        lightingShader.setVec3("dirLight.specular", 0.5f, 0.5f, 0.5f);
-        // point light 1
-        lightingShader.setVec3("pointLights[0].position", pointLightPositions[0]);
-        lightingShader.setVec3("pointLights[0].ambient", 0.05f, 0.05f, 0.05f);
-        lightingShader.setVec3("pointLights[0].diffuse", 0.8f, 0.8f, 0.8f);
-        lightingShader.setVec3("pointLights[0].specular", 1.0f, 1.0f, 1.0f);
-        lightingShader.setFloat("pointLights[0].constant", 1.0f);
-        lightingShader.setFloat("pointLights[0].linear", 0.09);
-        lightingShader.setFloat("pointLights[0].quadratic", 0.032);
-        // point light 2
-        lightingShader.setVec3("pointLights[1].position", pointLightPositions[1]);
-        lightingShader.setVec3("pointLights[1].ambient", 0.05f, 0.05f, 0.05f);
-        lightingShader.setVec3("pointLights[1].diffuse", 0.8f, 0.8f, 0.8f);
-        lightingShader.setVec3("pointLights[1].specular", 1.0f, 1.0f, 1.0f);
-        lightingShader.setFloat("pointLights[1].constant", 1.0f);
-        lightingShader.setFloat("pointLights[1].linear", 0.09);
-        lightingShader.setFloat("pointLights[1].quadratic", 0.032);
-        // point light 3
-        lightingShader.setVec3("pointLights[2].position", pointLightPositions[2]);
-        lightingShader.setVec3("pointLights[2].ambient", 0.05f, 0.05f, 0.05f);
-        lightingShader.setVec3("pointLights[2].diffuse", 0.8f, 0.8f, 0.8f);
-        lightingShader.setVec3("pointLights[2].specular", 1.0f, 1.0f, 1.0f);
-        lightingShader.setFloat("pointLights[2].constant", 1.0f);
-        lightingShader.setFloat("pointLights[2].linear", 0.09);
-        lightingShader.setFloat("pointLights[2].quadratic", 0.032);
-        // point light 4
-        lightingShader.setVec3("pointLights[3].position", pointLightPositions[3]);
-        lightingShader.setVec3("pointLights[3].ambient", 0.05f, 0.05f, 0.05f);
-        lightingShader.setVec3("pointLights[3].diffuse", 0.8f, 0.8f, 0.8f);
-        lightingShader.setVec3("pointLights[3].specular", 1.0f, 1.0f, 1.0f);
-        lightingShader.setFloat("pointLights[3].constant", 1.0f);
-        lightingShader.setFloat("pointLights[3].linear", 0.09);
-        lightingShader.setFloat("pointLights[3].quadratic", 0.032);
-        // spotLight
-        lightingShader.setVec3("spotLight.position", camera.Position);
-        lightingShader.setVec3("spotLight.direction", camera.Front);
-        lightingShader.setVec3("spotLight.ambient", 0.0f, 0.0f, 0.0f);
-        lightingShader.setVec3("spotLight.diffuse", 1.0f, 1.0f, 1.0f);
-        lightingShader.setVec3("spotLight.specular", 1.0f, 1.0f, 1.0f);
-        lightingShader.setFloat("spotLight.constant", 1.0f);
-        lightingShader.setFloat("spotLight.linear", 0.09);
-        lightingShader.setFloat("spotLight.quadratic", 0.032);
-        lightingShader.setFloat("spotLight.cutOff", cos(radians(12.5f)));
-        lightingShader.setFloat("spotLight.outerCutOff", cos(radians(15.0f)));
-
-        // view/projection transformations
-        mat4 projection = perspective(radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        mat4 view = camera.GetViewMatrix();
-        lightingShader.setMat4("projection", projection);
-        lightingShader.setMat4("view", view);
-
-        // world transformation
-        mat4 model = mat4(1.0f);
-        lightingShader.setMat4("model", model);
-
-        // bind diffuse map
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, diffuseMap);
-        // bind specular map
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, specularMap);
-
-        // render containers
-        glBindVertexArray(cubeVAO);
-        for (unsigned int i = 0; i < 10; i++)
+        profiler.beginFrame();
         {
-            // calculate the model matrix for each object and pass it to shader before drawing
-            mat4 model = mat4(1.0f);
-            model = translate(model, cubePositions[i]);
-            float angle = 20.0f * i;
-            model = rotate(model, radians(angle), vec3(1.0f, 0.3f, 0.5f));
-            lightingShader.setMat4("model", model);
-
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            TraceScope trace("render");
+            if (options.pipeline)
+            {
+                //先把这一帧的输入交给模拟线程，再提交它上一轮生成好的帧包
+                pipeline.submitInput(camera);
+                const FramePacket* packet = pipeline.acquire();
+                scene.submit(*packet);
+                pipeline.release();
+            }
+            else
+                scene.render(camera, SCR_WIDTH, SCR_HEIGHT);
+        }
+        profiler.endFrame();
+        if (options.profile && currentFrame - lastProfileReport >= 2.0f)
+        {
+            cout << "GPU profile:" << endl;
+            profiler.printAverages();
+            profiler.resetAverages();
+            lastProfileReport = currentFrame;
         }
-
-         // also draw the lamp object(s)
-         lightCubeShader.use();
-         lightCubeShader.setMat4("projection", projection);
-         lightCubeShader.setMat4("view", view);
-    
-         // we now draw as many light bulbs as we have point lights.
-         glBindVertexArray(lightCubeVAO);
-         for (unsigned int i = 0; i < 4; i++)
-         {
-             model = mat4(1.0f);
-             model = translate(model, pointLightPositions[i]);
-             model = scale(model, vec3(0.2f)); // Make it a smaller cube
-             lightCubeShader.setMat4("model", model);
-             glDrawArrays(GL_TRIANGLES, 0, 36);
-         }
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        {
+            TraceScope trace("swap buffers");
+            glfwSwapBuffers(window);
+        }
+        {
+            TraceScope trace("poll events");
+            glfwPollEvents();
+        }
+        glInstrumentationEndFrame();
     }
 
-    // optional: de-allocate all resources once they've outlived their purpose:
-    // ------------------------------------------------------------------------
-    glDeleteVertexArrays(1, &cubeVAO);
-    glDeleteVertexArrays(1, &lightCubeVAO);
-    glDeleteBuffers(1, &VBO);
+    if (options.pipeline)
+    {
+        cout << "Pipeline: " << pipeline.framesAcquired() << " frames, average input latency " << pipeline.averageLatencyMilliseconds()
+             << " ms, GL thread waited " << pipeline.waitMilliseconds() << " ms" << endl;
+        pipeline.stop();
+    }
+    setGLInstrumentationEnabled(false);
+    printGLCallReport();
+    scene.setProfiler(nullptr);
+    profiler.shutdown();
+    scene.cleanup();
+    if (!options.recordPath.empty() && recordedPath.save(options.recordPath))
+        cout << "Recorded " << recordedPath.keyCount() << " camera keys (" << recordedPath.duration() << " s) to " << options.recordPath << endl;
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
@@ -321,11 +402,241 @@ int main()
     return 0;
 }
 
+//没有窗口和输入，摄像机固定不动；每帧渲染到离屏帧缓冲，读回后写成 PNG
+int runHeadless(const RunOptions& options)
+{
+    HeadlessContext context;
+    if (!context.create())
+        return -1;
+
+    LightingScene scene;
+    OffscreenTarget target;
+    scene.allowReversedDepth(!options.standardDepth);
+    if (!scene.init(options.shaderDir, options.textureDir, options.sceneFile) || !target.create(options.width, options.height))
+    {
+        scene.cleanup();
+        target.destroy();
+        context.destroy();
+        return -1;
+    }
+    scatterContainers(scene.scene(), options.extraObjects, 1);
+
+    //默认偏航角 0 朝向 +x，窗口模式靠鼠标转过去；这里直接朝 -z 看向箱子
+    Camera headlessCamera(vec3(0.0f, 0.0f, 3.0f), vec3(0.0f, 1.0f, 0.0f), -90.0f, 0.0f);
+    int result = 0;
+    vector<unsigned char> pixels;
+    char path[1024];
+    for (int frame = 0; frame < options.frames; frame++)
+    {
+        target.bind();
+        scene.render(headlessCamera, target.width(), target.height());
+        target.readPixels(pixels);
+        snprintf(path, sizeof(path), "%s_%04d.png", options.outputPrefix.c_str(), frame);
+        if (!writePNG(path, target.width(), target.height(), 4, pixels.data()))
+        {
+            result = -1;
+            break;
+        }
+    }
+    if (result == 0)
+        cout << "Headless: wrote " << options.frames << " frame(s) of " << target.width() << "x" << target.height()
+             << " to " << options.outputPrefix << "_*.png" << endl;
+
+    scene.cleanup();
+    target.destroy();
+    context.destroy();
+    return result;
+}
+
+//基准测试：与 headless 模式一样不需要窗口，摄像机由路径驱动，时间由帧号决定
+int runBenchmark(const RunOptions& options)
+{
+    CameraPath path;
+    string pathName = options.cameraPath;
+    if (pathName.empty())
+    {
+        path = CameraPath::orbit(vec3(0.0f, 0.0f, -5.0f), 10.0f, 2.0f, 10.0f);
+        pathName = "builtin:orbit";
+    }
+    else if (!path.load(pathName))
+        return -1;
+
+    HeadlessContext context;
+    if (!context.create())
+        return -1;
+    LightingScene scene;
+    OffscreenTarget target;
+    scene.allowReversedDepth(!options.standardDepth);
+    if (!scene.init(options.shaderDir, options.textureDir, options.sceneFile) || !target.create(options.width, options.height))
+    {
+        scene.cleanup();
+        target.destroy();
+        context.destroy();
+        return -1;
+    }
+    scatterContainers(scene.scene(), options.extraObjects, 1);
+
+    BenchmarkSettings settings;
+    settings.frames = options.frames;
+    settings.warmupFrames = options.warmupFrames;
+    settings.timestep = options.timestep;
+    settings.pipelined = options.pipeline;
+    BenchmarkReport report;
+    report.pathName = pathName;
+    report.backend = context.backend();
+    report.jobWorkers = jobSystem().workerCount();
+    setGLInstrumentationEnabled(options.glCalls);
+    bool finished = runFrameBenchmark(scene, target, path, settings, report);
+    setGLInstrumentationEnabled(false);
+    int result = finished && writeBenchmarkJSON(options.jsonPath, report) ? 0 : -1;
+    if (result == 0)
+        cout << "Benchmark: " << options.frames << " frames written to " << options.jsonPath << endl;
+
+    scene.cleanup();
+    target.destroy();
+    context.destroy();
+    return result;
+}
+
+//软件光栅化：和 headless 一样写 PNG，但完全不碰 GL，可以在没有 GPU 的机器上当参考渲染器
+int runSoftware(const RunOptions& options)
+{
+    CameraPath path;
+    if (!options.cameraPath.empty() && !path.load(options.cameraPath))
+        return -1;
+    SoftwareRasterizer rasterizer;
+    if (!rasterizer.init(options.textureDir, options.width, options.height, options.sceneFile))
+        return -1;
+    scatterContainers(rasterizer.scene(), options.extraObjects, 1);
+
+    Camera softwareCamera(vec3(0.0f, 0.0f, 3.0f), vec3(0.0f, 1.0f, 0.0f), -90.0f, 0.0f);
+    double setupMilliseconds = 0.0, rasterMilliseconds = 0.0;
+    unsigned long long fragments = 0;
+    char name[1024];
+    for (int frame = 0; frame < options.frames; frame++)
+    {
+        if (!options.cameraPath.empty())
+            path.apply(path.startTime() + frame * options.timestep, softwareCamera);
+        rasterizer.render(softwareCamera);
+        setupMilliseconds += rasterizer.stats().setupMilliseconds;
+        rasterMilliseconds += rasterizer.stats().rasterMilliseconds;
+        fragments += rasterizer.stats().fragments;
+        snprintf(name, sizeof(name), "%s_%04d.png", options.outputPrefix.c_str(), frame);
+        if (!writePNG(name, rasterizer.width(), rasterizer.height(), 4, rasterizer.pixels().data()))
+            return -1;
+    }
+    printf("Software: wrote %d frame(s) of %dx%d to %s_*.png with %d thread(s), %s shading\n", options.frames,
+           rasterizer.width(), rasterizer.height(), options.outputPrefix.c_str(), rasterizer.stats().threads, SoftwareRasterizer::shadingPath());
+    printf("Software: %.3f ms setup + %.3f ms raster/shade per frame, %.0f fragments shaded per frame\n",
+           setupMilliseconds / options.frames, rasterMilliseconds / options.frames, (double)fragments / options.frames);
+    return 0;
+}
+
+//金图回归检查：GL 走 headless 的离屏帧缓冲，--software 走 CPU 光栅化，其余流程相同
+int runGolden(const RunOptions& options)
+{
+    HeadlessContext context;
+    LightingScene scene;
+    OffscreenTarget target;
+    SoftwareRasterizer rasterizer;
+    if (options.software)
+    {
+        if (!rasterizer.init(options.textureDir, options.width, options.height))
+            return -1;
+    }
+    else
+    {
+        if (!context.create())
+            return -1;
+        scene.allowReversedDepth(!options.standardDepth);
+        if (!scene.init(options.shaderDir, options.textureDir) || !target.create(options.width, options.height))
+        {
+            scene.cleanup();
+            target.destroy();
+            context.destroy();
+            return -1;
+        }
+    }
+
+    const vector<GoldenPose>& poses = goldenPoses();
+    Camera goldenCamera;
+    vector<unsigned char> pixels, expected, diff;
+    int failures = 0;
+    for (size_t i = 0; i < poses.size(); i++)
+    {
+        const GoldenPose& pose = poses[i];
+        goldenCamera.SetPose(pose.position, pose.yaw, pose.pitch, pose.zoom);
+        if (options.software)
+        {
+            rasterizer.render(goldenCamera);
+            pixels = rasterizer.pixels();
+        }
+        else
+        {
+            target.bind();
+            scene.render(goldenCamera, target.width(), target.height());
+            target.readPixels(pixels);
+        }
+
+        string goldenPath = options.goldenDir + pose.name + ".png";
+        if (options.updateGolden)
+        {
+            if (!writePNG(goldenPath, options.width, options.height, 4, pixels.data()))
+                failures++;
+            else
+                printf("Golden: updated %s\n", goldenPath.c_str());
+            continue;
+        }
+
+        int goldenWidth, goldenHeight;
+        if (!readPNG(goldenPath, goldenWidth, goldenHeight, expected))
+        {
+            cout << "ERROR::GOLDEN::MISSING_IMAGE: " << goldenPath << " (run with --update-golden to create it)" << endl;
+            failures++;
+            continue;
+        }
+        if (goldenWidth != options.width || goldenHeight != options.height)
+        {
+            cout << "ERROR::GOLDEN::SIZE_MISMATCH: " << goldenPath << " is " << goldenWidth << "x" << goldenHeight
+                 << ", rendering " << options.width << "x" << options.height << endl;
+            failures++;
+            continue;
+        }
+        ImageComparison comparison;
+        compareImages(expected.data(), pixels.data(), options.width, options.height, options.tolerance, diff, comparison);
+        bool passed = comparison.failingPercent <= options.maxFailingPercent;
+        printf("Golden: %-10s %s  %lu pixels (%.3f%%) over tolerance %d, max delta %d, mean delta %.3f\n", pose.name,
+               passed ? "PASS" : "FAIL", comparison.failingPixels, comparison.failingPercent, options.tolerance,
+               comparison.maxDelta, comparison.meanDelta);
+        if (passed)
+            continue;
+        failures++;
+        string actualPath = options.outputPrefix + "_" + pose.name + ".png";
+        string diffPath = options.outputPrefix + "_" + pose.name + "_diff.png";
+        writePNG(actualPath, options.width, options.height, 4, pixels.data());
+        writePNG(diffPath, options.width, options.height, 4, diff.data());
+        printf("Golden: wrote %s and %s\n", actualPath.c_str(), diffPath.c_str());
+    }
+    if (!options.updateGolden)
+        printf("Golden: %d of %d pose(s) passed (%s)\n", (int)poses.size() - failures, (int)poses.size(),
+               options.software ? "software" : context.backend());
+
+    if (!options.software)
+    {
+        scene.cleanup();
+        target.destroy();
+        context.destroy();
+    }
+    return failures == 0 ? 0 : -1;
+}
+
 void processInput(GLFWwindow *window)
 {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS){
         glfwSetWindowShouldClose(window, true);
     }
+    //上一帧 glfwPollEvents 收到的所有鼠标移动合成一次旋转，再按新的朝向移动
+    camera.UpdateOrientation();
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS){
         camera.ProcessKeyboard(FORWARD, deltaTime);
     }
@@ -345,6 +656,19 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         case GLFW_KEY_ESCAPE:
             glfwSetWindowShouldClose(window, true);
             break;
+        case GLFW_KEY_F2:
+            //关闭统计时打印这段时间的结果，下次打开重新计数
+            if (action != GLFW_PRESS)
+                break;
+            if (glInstrumentationEnabled())
+            {
+                setGLInstrumentationEnabled(false);
+                printGLCallReport();
+                resetGLCallStats();
+            }
+            else
+                setGLInstrumentationEnabled(true);
+            break;
         default:
             break;
     }
@@ -382,42 +706,3 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
     // height will be significantly larger than specified on retina displays.
     glViewport(0, 0, width, height);
 }
-
-// utility function for loading a 2D texture from file
-// ---------------------------------------------------
-unsigned int loadTexture(char const * path)
-{
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
-
-    return textureID;
-}
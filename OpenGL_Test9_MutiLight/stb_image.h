@@ -483,6 +483,10 @@ STBIDEF void stbi_set_unpremultiply_on_load(int flag_true_if_should_unpremultipl
 // or just pass them through "as-is"
 STBIDEF void stbi_convert_iphone_png_to_rgb(int flag_true_if_should_convert);
 
+// PNG unfiltering uses SSE2 when the CPU supports it; pass 1 to force the
+// scalar path, e.g. to compare decode speed
+STBIDEF void stbi_png_disable_simd(int flag_true_if_should_disable);
+
 // flip the image vertically, so the first pixel in the output array is the bottom left
 STBIDEF void stbi_set_flip_vertically_on_load(int flag_true_if_should_flip);
 
@@ -610,12 +614,14 @@ typedef unsigned short stbi__uint16;
 typedef   signed short stbi__int16;
 typedef unsigned int   stbi__uint32;
 typedef   signed int   stbi__int32;
+typedef unsigned __int64 stbi__uint64;
 #else
 #include <stdint.h>
 typedef uint16_t stbi__uint16;
 typedef int16_t  stbi__int16;
 typedef uint32_t stbi__uint32;
 typedef int32_t  stbi__int32;
+typedef uint64_t stbi__uint64;
 #endif
 
 // should produce compiler error if size is wrong
@@ -717,7 +723,7 @@ static int stbi__cpuid3(void)
 
 #define STBI_SIMD_ALIGN(type, name) __declspec(align(16)) type name
 
-#if !defined(STBI_NO_JPEG) && defined(STBI_SSE2)
+#if (!defined(STBI_NO_JPEG) || !defined(STBI_NO_PNG)) && defined(STBI_SSE2)
 static int stbi__sse2_available(void)
 {
    int info3 = stbi__cpuid3();
@@ -728,7 +734,7 @@ static int stbi__sse2_available(void)
 #else // assume GCC-style if not VC++
 #define STBI_SIMD_ALIGN(type, name) type name __attribute__((aligned(16)))
 
-#if !defined(STBI_NO_JPEG) && defined(STBI_SSE2)
+#if (!defined(STBI_NO_JPEG) || !defined(STBI_NO_PNG)) && defined(STBI_SSE2)
 static int stbi__sse2_available(void)
 {
    // If we're even attempting to compile this on GCC/Clang, that means
@@ -3977,7 +3983,7 @@ static int stbi__jpeg_info(stbi__context *s, int *x, int *y, int *comp)
 #ifndef STBI_NO_ZLIB
 
 // fast-way is faster to check than jpeg huffman, but slow way is slower
-#define STBI__ZFAST_BITS  9 // accelerate all cases in default tables
+#define STBI__ZFAST_BITS  10 // accelerate all cases in default tables, and most codes of dynamic ones
 #define STBI__ZFAST_MASK  ((1 << STBI__ZFAST_BITS) - 1)
 
 // zlib-style huffman encoding
@@ -4066,7 +4072,7 @@ typedef struct
 {
    stbi_uc *zbuffer, *zbuffer_end;
    int num_bits;
-   stbi__uint32 code_buffer;
+   stbi__uint64 code_buffer; // 64 bits so one refill covers several codes
 
    char *zout;
    char *zout_start;
@@ -4086,23 +4092,40 @@ stbi_inline static stbi_uc stbi__zget8(stbi__zbuf *z)
    return stbi__zeof(z) ? 0 : *z->zbuffer++;
 }
 
+#if defined(__LITTLE_ENDIAN__) || defined(STBI__X86_TARGET) || defined(STBI__X64_TARGET) || defined(__aarch64__) || \
+    (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define STBI__ZWORD_REFILL
+#endif
+
 static void stbi__fill_bits(stbi__zbuf *z)
 {
+   if (z->code_buffer >= ((stbi__uint64) 1 << z->num_bits)) {
+     z->zbuffer = z->zbuffer_end;  /* treat this as EOF so we fail. */
+     return;
+   }
+#ifdef STBI__ZWORD_REFILL
+   // load 8 input bytes at once and keep as many whole bytes as fit
+   if (z->zbuffer_end - z->zbuffer >= 8) {
+      stbi__uint64 word;
+      memcpy(&word, z->zbuffer, 8);
+      z->code_buffer |= word << z->num_bits;
+      z->zbuffer += (63 - z->num_bits) >> 3;
+      z->num_bits |= 56;
+      z->code_buffer &= ((stbi__uint64) 1 << z->num_bits) - 1;
+      return;
+   }
+#endif
    do {
-      if (z->code_buffer >= (1U << z->num_bits)) {
-        z->zbuffer = z->zbuffer_end;  /* treat this as EOF so we fail. */
-        return;
-      }
-      z->code_buffer |= (unsigned int) stbi__zget8(z) << z->num_bits;
+      z->code_buffer |= (stbi__uint64) stbi__zget8(z) << z->num_bits;
       z->num_bits += 8;
-   } while (z->num_bits <= 24);
+   } while (z->num_bits <= 56);
 }
 
 stbi_inline static unsigned int stbi__zreceive(stbi__zbuf *z, int n)
 {
    unsigned int k;
    if (z->num_bits < n) stbi__fill_bits(z);
-   k = z->code_buffer & ((1 << n) - 1);
+   k = (unsigned int) (z->code_buffer & ((1 << n) - 1));
    z->code_buffer >>= n;
    z->num_bits -= n;
    return k;
@@ -4113,7 +4136,7 @@ static int stbi__zhuffman_decode_slowpath(stbi__zbuf *a, stbi__zhuffman *z)
    int b,s,k;
    // not resolved by fast table, so compute it the slow way
    // use jpeg approach, which requires MSbits at top
-   k = stbi__bit_reverse(a->code_buffer, 16);
+   k = stbi__bit_reverse((int) (a->code_buffer & 0xffff), 16);
    for (s=STBI__ZFAST_BITS+1; ; ++s)
       if (k < z->maxcode[s])
          break;
@@ -4136,7 +4159,7 @@ stbi_inline static int stbi__zhuffman_decode(stbi__zbuf *a, stbi__zhuffman *z)
       }
       stbi__fill_bits(a);
    }
-   b = z->fast[a->code_buffer & STBI__ZFAST_MASK];
+   b = z->fast[(int) (a->code_buffer & STBI__ZFAST_MASK)];
    if (b) {
       s = b >> 9;
       a->code_buffer >>= s;
@@ -4215,8 +4238,18 @@ static int stbi__parse_huffman_block(stbi__zbuf *a)
          }
          p = (stbi_uc *) (zout - dist);
          if (dist == 1) { // run of one byte; common in images.
-            stbi_uc v = *p;
-            if (len) { do *zout++ = v; while (--len); }
+            memset(zout, *p, len);
+            zout += len;
+         } else if (dist >= 8 && a->zout_end - zout >= len + 8) {
+            // copy 8 bytes at a time; the source is at least 8 bytes behind so it never reads what
+            // this copy writes, and the overshoot past len is rewritten by the next symbols
+            char *end = zout + len;
+            do {
+               memcpy(zout, p, 8);
+               zout += 8;
+               p += 8;
+            } while (zout < end);
+            zout = end;
          } else {
             if (len) { do *zout++ = *p++; while (--len); }
          }
@@ -4282,7 +4315,7 @@ static int stbi__parse_uncompressed_block(stbi__zbuf *a)
       stbi__zreceive(a, a->num_bits & 7); // discard
    // drain the bit-packed data into header
    k = 0;
-   while (a->num_bits > 0) {
+   while (a->num_bits > 0 && k < 4) {
       header[k++] = (stbi_uc) (a->code_buffer & 255); // suppress MSVC run-time check
       a->code_buffer >>= 8;
       a->num_bits -= 8;
@@ -4294,9 +4327,16 @@ static int stbi__parse_uncompressed_block(stbi__zbuf *a)
    len  = header[1] * 256 + header[0];
    nlen = header[3] * 256 + header[2];
    if (nlen != (len ^ 0xffff)) return stbi__err("zlib corrupt","Corrupt PNG");
-   if (a->zbuffer + len > a->zbuffer_end) return stbi__err("read past buffer","Corrupt PNG");
+   if (a->zbuffer + len - (a->num_bits >> 3) > a->zbuffer_end) return stbi__err("read past buffer","Corrupt PNG");
    if (a->zout + len > a->zout_end)
       if (!stbi__zexpand(a, a->zout, len)) return 0;
+   // the 64-bit bit buffer can still hold the first few stored bytes
+   while (len > 0 && a->num_bits >= 8) {
+      *a->zout++ = (char) (a->code_buffer & 255);
+      a->code_buffer >>= 8;
+      a->num_bits -= 8;
+      --len;
+   }
    memcpy(a->zout, a->zbuffer, len);
    a->zbuffer += len;
    a->zout += len;
@@ -4535,6 +4575,115 @@ static int stbi__paeth(int a, int b, int c)
 
 static const stbi_uc stbi__depth_scale_table[9] = { 0, 0xff, 0x55, 0, 0x11, 0,0,0, 0x01 };
 
+static int stbi__png_simd_disabled = 0;
+
+STBIDEF void stbi_png_disable_simd(int flag_true_if_should_disable)
+{
+   stbi__png_simd_disabled = flag_true_if_should_disable;
+}
+
+#ifdef STBI_SSE2
+// SSE2 unfilters for 8-bit rows with 3 or 4 bytes per pixel (RGB/RGBA).
+// sub, avg and paeth depend on the reconstructed pixel to the left, so they
+// work one pixel at a time with all of its channels in one register; up has
+// no such dependency and runs 16 bytes at a time. cur, raw and prior point
+// at the second pixel of the row, nk is the number of bytes left.
+
+stbi_inline static __m128i stbi__png_load_pixel(const stbi_uc *p, int bpp)
+{
+   int v;
+   if (bpp == 4)
+      memcpy(&v, p, 4);
+   else
+      v = p[0] | (p[1] << 8) | (p[2] << 16);
+   return _mm_cvtsi32_si128(v);
+}
+
+stbi_inline static void stbi__png_store_pixel(stbi_uc *p, __m128i v, int bpp)
+{
+   int x = _mm_cvtsi128_si32(v);
+   if (bpp == 4) {
+      memcpy(p, &x, 4);
+   } else {
+      p[0] = (stbi_uc) x;
+      p[1] = (stbi_uc) (x >> 8);
+      p[2] = (stbi_uc) (x >> 16);
+   }
+}
+
+stbi_inline static void stbi__png_unfilter_sse2_bpp(int filter, stbi_uc *cur, stbi_uc *raw, stbi_uc *prior, int nk, int bpp)
+{
+   __m128i zero = _mm_setzero_si128();
+   int k;
+   switch (filter) {
+      case STBI__F_sub: {
+         __m128i a = stbi__png_load_pixel(cur - bpp, bpp);
+         for (k=0; k < nk; k += bpp) {
+            a = _mm_add_epi8(stbi__png_load_pixel(raw + k, bpp), a);
+            stbi__png_store_pixel(cur + k, a, bpp);
+         }
+         break;
+      }
+      case STBI__F_up:
+         for (k=0; k + 16 <= nk; k += 16) {
+            __m128i x = _mm_add_epi8(_mm_loadu_si128((const __m128i *) (raw + k)), _mm_loadu_si128((const __m128i *) (prior + k)));
+            _mm_storeu_si128((__m128i *) (cur + k), x);
+         }
+         for (; k < nk; ++k)
+            cur[k] = STBI__BYTECAST(raw[k] + prior[k]);
+         break;
+      case STBI__F_avg: {
+         // _mm_avg_epu8 rounds up; subtracting the low bit of a^b gives the floor png wants
+         __m128i one = _mm_set1_epi8(1);
+         __m128i a = stbi__png_load_pixel(cur - bpp, bpp);
+         for (k=0; k < nk; k += bpp) {
+            __m128i b = stbi__png_load_pixel(prior + k, bpp);
+            __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+            a = _mm_add_epi8(stbi__png_load_pixel(raw + k, bpp), avg);
+            stbi__png_store_pixel(cur + k, a, bpp);
+         }
+         break;
+      }
+      case STBI__F_paeth: {
+         // predictor math in 16-bit lanes: p-a = b-c, p-b = a-c, p-c = (b-c)+(a-c)
+         __m128i a = _mm_unpacklo_epi8(stbi__png_load_pixel(cur - bpp, bpp), zero);
+         __m128i c = _mm_unpacklo_epi8(stbi__png_load_pixel(prior - bpp, bpp), zero);
+         for (k=0; k < nk; k += bpp) {
+            __m128i b = _mm_unpacklo_epi8(stbi__png_load_pixel(prior + k, bpp), zero);
+            __m128i d = _mm_unpacklo_epi8(stbi__png_load_pixel(raw + k, bpp), zero);
+            __m128i pa = _mm_sub_epi16(b, c);
+            __m128i pb = _mm_sub_epi16(a, c);
+            __m128i pc = _mm_add_epi16(pa, pb);
+            __m128i smallest, use_a, use_b, nearest;
+            pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+            pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+            pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+            smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+            // ties prefer a, then b, then c
+            use_a = _mm_cmpeq_epi16(smallest, pa);
+            use_b = _mm_andnot_si128(use_a, _mm_cmpeq_epi16(smallest, pb));
+            nearest = _mm_or_si128(_mm_and_si128(use_a, a),
+                      _mm_or_si128(_mm_and_si128(use_b, b), _mm_andnot_si128(_mm_or_si128(use_a, use_b), c)));
+            // byte adds never carry into the zero high bytes, so packing back does not saturate
+            a = _mm_add_epi8(d, nearest);
+            stbi__png_store_pixel(cur + k, _mm_packus_epi16(a, a), bpp);
+            c = b;
+         }
+         break;
+      }
+   }
+}
+
+static void stbi__png_unfilter_sse2(int filter, stbi_uc *cur, stbi_uc *raw, stbi_uc *prior, int nk, int bpp)
+{
+   // separate calls so the compiler can specialise each one for a constant pixel size
+   if (bpp == 3)
+      stbi__png_unfilter_sse2_bpp(filter, cur, raw, prior, nk, 3);
+   else
+      stbi__png_unfilter_sse2_bpp(filter, cur, raw, prior, nk, 4);
+}
+#endif
+
 // create the png data from post-deflated data
 static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 raw_len, int out_n, stbi__uint32 x, stbi__uint32 y, int depth, int color)
 {
@@ -4548,6 +4697,15 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
    int output_bytes = out_n*bytes;
    int filter_bytes = img_n*bytes;
    int width = x;
+   // 8-bit images that gain an alpha channel are unfiltered into two rows at
+   // the file's own layout and then expanded, so they use the same fast paths
+   int expand_rows = (depth == 8 && img_n != out_n);
+   int row_n = expand_rows ? img_n : out_n;
+   stbi_uc *filter_buf = NULL;
+   int simd = 0;
+#ifdef STBI_SSE2
+   simd = !stbi__png_simd_disabled && stbi__sse2_available();
+#endif
 
    STBI_ASSERT(out_n == s->img_n || out_n == s->img_n+1);
    a->out = (stbi_uc *) stbi__malloc_mad3(x, y, output_bytes, 0); // extra bytes to write off the end into
@@ -4562,13 +4720,20 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
    // so just check for raw_len < img_len always.
    if (raw_len < img_len) return stbi__err("not enough pixels","Corrupt PNG");
 
+   if (expand_rows) {
+      filter_buf = (stbi_uc *) stbi__malloc_mad2(img_width_bytes, 2, 0);
+      if (!filter_buf) return stbi__err("outofmem", "Out of memory");
+   }
+
    for (j=0; j < y; ++j) {
-      stbi_uc *cur = a->out + stride*j;
+      stbi_uc *cur = expand_rows ? filter_buf + img_width_bytes*(j&1) : a->out + stride*j;
       stbi_uc *prior;
       int filter = *raw++;
 
-      if (filter > 4)
+      if (filter > 4) {
+         STBI_FREE(filter_buf);
          return stbi__err("invalid filter","Corrupt PNG");
+      }
 
       if (depth < 8) {
          if (img_width_bytes > x) return stbi__err("invalid width","Corrupt PNG");
@@ -4576,7 +4741,7 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
          filter_bytes = 1;
          width = img_width_bytes;
       }
-      prior = cur - stride; // bugfix: need to compute this after 'cur +=' computation above
+      prior = expand_rows ? filter_buf + img_width_bytes*((j+1)&1) : cur - stride; // bugfix: need to compute this after 'cur +=' computation above
 
       // if first row, use special filter that doesn't sample previous row
       if (j == 0) filter = first_row_filter[filter];
@@ -4595,11 +4760,11 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
       }
 
       if (depth == 8) {
-         if (img_n != out_n)
+         if (img_n != row_n)
             cur[img_n] = 255; // first pixel
          raw += img_n;
-         cur += out_n;
-         prior += out_n;
+         cur += row_n;
+         prior += row_n;
       } else if (depth == 16) {
          if (img_n != out_n) {
             cur[filter_bytes]   = 255; // first pixel top byte
@@ -4615,11 +4780,16 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
       }
 
       // this is a little gross, so that we don't switch per-pixel or per-component
-      if (depth < 8 || img_n == out_n) {
+      if (depth < 8 || img_n == row_n) {
          int nk = (width - 1)*filter_bytes;
          #define STBI__CASE(f) \
              case f:     \
                 for (k=0; k < nk; ++k)
+#ifdef STBI_SSE2
+         if (simd && depth == 8 && (filter_bytes == 3 || filter_bytes == 4) && filter >= STBI__F_sub && filter <= STBI__F_paeth)
+            stbi__png_unfilter_sse2(filter, cur, raw, prior, nk, filter_bytes);
+         else
+#endif
          switch (filter) {
             // "none" filter turns into a memcpy here; make that explicit.
             case STBI__F_none:         memcpy(cur, raw, nk); break;
@@ -4632,6 +4802,25 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
          }
          #undef STBI__CASE
          raw += nk;
+
+         if (expand_rows) {
+            stbi_uc *src = filter_buf + img_width_bytes*(j&1);
+            stbi_uc *dest = a->out + stride*j;
+            if (img_n == 3) {
+               for (i=0; i < x; ++i, src += 3, dest += 4) {
+                  dest[0] = src[0];
+                  dest[1] = src[1];
+                  dest[2] = src[2];
+                  dest[3] = 255;
+               }
+            } else {
+               for (i=0; i < x; ++i, src += img_n, dest += out_n) {
+                  for (k=0; k < img_n; ++k)
+                     dest[k] = src[k];
+                  dest[img_n] = 255;
+               }
+            }
+         }
       } else {
          STBI_ASSERT(img_n+1 == out_n);
          #define STBI__CASE(f) \
@@ -4660,6 +4849,8 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
       }
    }
 
+   STBI_FREE(filter_buf);
+
    // we make a separate pass to expand bits to pixels; for performance,
    // this could run two scanlines behind the above code, so it won't
    // intefere with filtering but will still be in the cache.